@@ -0,0 +1,147 @@
+/*
+ *  dvanalyze.c
+ *
+ *  This file is part of libdv, a free DV (IEC 61834/SMPTE 314M)
+ *  codec.
+ *
+ *  libdv is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation; either version 2.1, or (at your
+ *  option) any later version.
+ *
+ *  libdv is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with libdv; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ *  The libdv homepage is http://libdv.sourceforge.net/.
+ */
+
+/* Prints quality and complexity statistics of a raw DV stream, one JSON
+ * object per frame and line:
+ *
+ *   dvanalyze [-r] [file]
+ *
+ * -r adds the statistics of each superblock and the bits used by each
+ * video segment.  Without a file the stream is read from stdin. */
+
+#include <libdv/dv.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int read_frame(FILE* in_fp, unsigned char* frame_buf, int * isPAL)
+{
+	if (fread(frame_buf, 1, 120000, in_fp) != 120000) {
+		return 0;
+	}
+
+	*isPAL = (frame_buf[3] & 0x80);
+
+	if (*isPAL) {
+		if (fread(frame_buf + 120000, 1, 144000 - 120000, in_fp) !=
+		    144000 - 120000) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void print_ints(const char *name, const int *v, int n)
+{
+	int i;
+
+	printf(",\"%s\":[", name);
+	for (i = 0; i < n; i++) {
+		printf(i ? ",%d" : "%d", v[i]);
+	}
+	printf("]");
+}
+
+static void print_regions(const dv_frame_analysis_t *fa)
+{
+	int i;
+
+	printf(",\"regions\":[");
+	for (i = 0; i < fa->num_regions; i++) {
+		const dv_region_analysis_t *r = &fa->regions[i];
+		int mbs = r->macroblocks ? r->macroblocks : 1;
+
+		printf("%s{\"qno\":%.2f,\"dct248\":%.3f,"
+		       "\"incomplete_blocks\":%d,\"errors\":%d}",
+		       i ? "," : "", (double) r->qno_sum / mbs,
+		       (double) r->dct_248 / (6 * mbs),
+		       r->incomplete_blocks, r->errors);
+	}
+	printf("]");
+}
+
+int main(int argc, const char** argv)
+{
+	unsigned char frame_buf[144000];
+	dv_frame_analysis_t fa;
+	dv_decoder_t *decoder;
+	FILE *in_fp = stdin;
+	char timecode[40];
+	int regions = 0;
+	int frame = 0;
+	int isPAL;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-r") == 0) {
+			regions = 1;
+		} else if (argv[i][0] == '-' && argv[i][1]) {
+			fprintf(stderr, "Usage: %s [-r] [file]\n", argv[0]);
+			return 1;
+		} else if (strcmp(argv[i], "-") != 0) {
+			in_fp = fopen(argv[i], "rb");
+			if (!in_fp) {
+				perror(argv[i]);
+				return 1;
+			}
+		}
+	}
+
+	decoder = dv_decoder_new(0, 0, 0);
+	while (read_frame(in_fp, frame_buf, &isPAL)) {
+		if (dv_analyze_frame(decoder, frame_buf, &fa) < 0) {
+			printf("{\"frame\":%d,\"error\":\"bad header\"}\n",
+			       frame++);
+			continue;
+		}
+		dv_parse_packs(decoder, frame_buf);
+		dv_get_timestamp(decoder, timecode);
+
+		printf("{\"frame\":%d,\"timecode\":\"%s\",\"system\":\"%s\"",
+		       frame++, timecode, fa.isPAL ? "PAL" : "NTSC");
+		print_ints("qno", fa.qnos, 16);
+		print_ints("class", fa.classes, 4);
+		printf(",\"dct248_ratio\":%.4f", fa.blocks ?
+		       (double) fa.dct_248 / fa.blocks : 0.0);
+		printf(",\"bits_used\":%d,\"bits_available\":%d"
+		       ",\"full_segments\":%d",
+		       fa.bits_used, fa.bits_available, fa.full_segments);
+		printf(",\"incomplete_blocks\":%d,\"vlc_errors\":%d"
+		       ",\"sta_errors\":%d",
+		       fa.incomplete_blocks, fa.vlc_errors, fa.sta_errors);
+		if (regions) {
+			print_regions(&fa);
+			printf(",\"segment_bits_available\":%d",
+			       DV_ANALYSIS_SEGMENT_BITS);
+			print_ints("segment_bits", fa.segment_bits,
+				   fa.segments);
+		}
+		printf("}\n");
+	}
+	dv_decoder_free(decoder);
+	if (in_fp != stdin) {
+		fclose(in_fp);
+	}
+	return 0;
+}
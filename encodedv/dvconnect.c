@@ -41,6 +41,11 @@
 #include <pthread.h>
 #include <signal.h>
 
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
 #if HAVE_LIBPOPT
 #include <popt.h>
 #endif
@@ -127,76 +132,320 @@ static int broken_frames = 0;
    - buffer management
    ------------------------------------------------------------------------ */
 
+/* Frames travel between the 1394 thread and the file io thread through
+   two single producer / single consumer rings: buf_queue carries the
+   filled frames one way, free_ring hands the empty ones back.  Neither
+   side ever takes a lock, so a descheduled file io thread can not hold
+   up the 1394 thread.  A consumer that finds its ring empty sleeps on a
+   futex; the producer only pays for a system call when someone sleeps. */
+
+#define CACHE_LINE 64
+
 static int max_buffer_blocks = 25*10;
 static int ceil_buffer_blocks = 0;
+static int allocated_blocks = 0;
 
 struct buf_node {
 	unsigned char data[144000]; /* FIXME: We are wasting space on NTSC! */
 	int usage;
-	struct buf_node* next;
 };
 
-struct buf_list {
-	struct buf_node * first;
-	struct buf_node * last;
-	int usage;
+struct frame_ring {
+	struct buf_node ** slots;
+	unsigned int mask;
+
+	/* written by the producer */
+	unsigned int head __attribute__ ((aligned (CACHE_LINE)));
+	int closed;
+	int events;  /* futex word, changes to wake the consumer */
+
+	/* written by the consumer */
+	unsigned int tail __attribute__ ((aligned (CACHE_LINE)));
+
+	int waiting __attribute__ ((aligned (CACHE_LINE)));
 };
 
-static struct buf_list free_list = { NULL, NULL, 0 };
-static struct buf_list buf_queue = { NULL, NULL, 0 };
+static struct frame_ring free_ring;
+static struct frame_ring buf_queue;
+static int buffers_primed = 0;
 
-static pthread_mutex_t  queue_mutex;
-static pthread_mutex_t  wakeup_mutex;
-static pthread_cond_t   wakeup_cond;
 static pthread_t        file_io_thread;
 
-void push_back(struct buf_list * l, struct buf_node * elem)
+#ifdef __linux__
+static void futex_wait(int * addr, int val)
 {
-	pthread_mutex_lock(&queue_mutex);
-	if (l->last) {
-		l->last->next = elem;
-	} else {
-		l->first = elem;
+	syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake(int * addr)
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+#else
+static void futex_wait(int * addr, int val)
+{
+	if (__atomic_load_n(addr, __ATOMIC_SEQ_CST) == val) {
+		usleep(1000);
 	}
-	elem->next = NULL;
-	l->last = elem;
-	l->usage++;
-	pthread_mutex_unlock(&queue_mutex);
 }
 
-struct buf_node * pop_front(struct buf_list * l)
+static void futex_wake(int * addr)
 {
-	struct buf_node * rval;
+}
+#endif
 
-	pthread_mutex_lock(&queue_mutex);
-	rval = l->first;
+/* The rings hold every frame there can ever be, so pushing never has to
+   wait for room. */
+static int ring_init(struct frame_ring * r, int frames)
+{
+	unsigned int size = 1;
 
-	if (l->first == l->last) {
-		l->last = NULL;
+	while (size < frames) {
+		size <<= 1;
 	}
-	if (rval) {
-		l->first = rval->next;
-		l->usage--;
-	} else {
-		l->first = NULL;
+	memset(r, 0, sizeof(struct frame_ring));
+	r->slots = (struct buf_node**) calloc(size, sizeof(struct buf_node*));
+	if (!r->slots) {
+		return -1;
+	}
+	r->mask = size - 1;
+	return 0;
+}
+
+static void ring_wake(struct frame_ring * r)
+{
+	__atomic_add_fetch(&r->events, 1, __ATOMIC_SEQ_CST);
+	futex_wake(&r->events);
+}
+
+void ring_push(struct frame_ring * r, struct buf_node * elem)
+{
+	unsigned int head = r->head;
+
+	r->slots[head & r->mask] = elem;
+	__atomic_store_n(&r->head, head + 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&r->waiting, __ATOMIC_SEQ_CST)) {
+		__atomic_store_n(&r->waiting, 0, __ATOMIC_RELAXED);
+		ring_wake(r);
 	}
+}
 
-	pthread_mutex_unlock(&queue_mutex);
+struct buf_node * ring_pop(struct frame_ring * r)
+{
+	unsigned int tail = r->tail;
+	struct buf_node * rval;
+
+	if (tail == __atomic_load_n(&r->head, __ATOMIC_ACQUIRE)) {
+		return NULL;
+	}
+	rval = r->slots[tail & r->mask];
+	__atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
 	return rval;
 }
 
+static int ring_is_closed(struct frame_ring * r)
+{
+	return __atomic_load_n(&r->closed, __ATOMIC_ACQUIRE);
+}
+
+/* Called by the producer after its last push. */
+static void ring_close(struct frame_ring * r)
+{
+	__atomic_store_n(&r->closed, 1, __ATOMIC_SEQ_CST);
+	ring_wake(r);
+}
+
+/* Sleeps until the ring is pushed to, closed or woken, unless that
+   happened since events was read. */
+static void ring_sleep(struct frame_ring * r, int events)
+{
+	__atomic_store_n(&r->waiting, 1, __ATOMIC_SEQ_CST);
+	if (r->tail == __atomic_load_n(&r->head, __ATOMIC_SEQ_CST)
+	    && !ring_is_closed(r)) {
+		futex_wait(&r->events, events);
+	}
+}
+
+/* Returns NULL once the ring is closed and empty. */
+struct buf_node * ring_pop_wait(struct frame_ring * r)
+{
+	struct buf_node * rval;
+	int events;
+
+	for (;;) {
+		events = __atomic_load_n(&r->events, __ATOMIC_SEQ_CST);
+		if ((rval = ring_pop(r)) != NULL) {
+			return rval;
+		}
+		if (ring_is_closed(r)) {
+			return ring_pop(r);
+		}
+		ring_sleep(r, events);
+	}
+}
+
+/* Only the consumer of free_ring may call this.  Frames are allocated
+   as they are first needed, up to the buffer limit. */
 struct buf_node * get_free_block()
 {
-	struct buf_node * f = pop_front(&free_list);
+	struct buf_node * f = ring_pop(&free_ring);
 	if (!f) {
-		if (buf_queue.usage >= max_buffer_blocks) {
+		if (allocated_blocks >= __atomic_load_n(&max_buffer_blocks,
+							__ATOMIC_RELAXED)) {
 			return NULL;
 		}
 		f = (struct buf_node*) malloc(sizeof(struct buf_node));
+		if (f) {
+			allocated_blocks++;
+		}
 	}
 	return f;
 }
 
+/* Like get_free_block(), but waits for a frame to come back or for the
+   limit to be raised, which wakes free_ring.  Returns NULL once
+   free_ring is closed and empty. */
+static struct buf_node * get_free_block_wait(void)
+{
+	struct buf_node * f;
+	int events;
+
+	for (;;) {
+		events = __atomic_load_n(&free_ring.events, __ATOMIC_SEQ_CST);
+		if ((f = get_free_block()) != NULL) {
+			return f;
+		}
+		if (ring_is_closed(&free_ring)) {
+			return ring_pop(&free_ring);
+		}
+		ring_sleep(&free_ring, events);
+	}
+}
+
+static int init_buffers(void)
+{
+	int frames = max_buffer_blocks;
+
+	/* underruns raise the limit in steps of 25 up to the ceiling */
+	if (ceil_buffer_blocks + 25 > frames) {
+		frames = ceil_buffer_blocks + 25;
+	}
+	if (ring_init(&free_ring, frames) < 0
+	    || ring_init(&buf_queue, frames) < 0) {
+		fprintf(stderr, "Out of memory for the frame rings!\n");
+		return -1;
+	}
+	allocated_blocks = 0;
+	buffers_primed = 0;
+	return 0;
+}
+
+static void signal_buffers_primed(void)
+{
+	__atomic_store_n(&buffers_primed, 1, __ATOMIC_SEQ_CST);
+	futex_wake(&buffers_primed);
+}
+
+static void wait_buffers_primed(void)
+{
+	while (!__atomic_load_n(&buffers_primed, __ATOMIC_SEQ_CST)) {
+		futex_wait(&buffers_primed, 0);
+	}
+}
+
+/* ------------------------------------------------------------------------
+   - simulated bus
+   ------------------------------------------------------------------------ */
+
+/* With --simulate the video1394 device is left alone: capturing receives
+   synthetic PAL frames laid out as video1394 delivers them, sending
+   discards the packets.  Both run as fast as the frame queueing allows,
+   which makes it possible to benchmark that without 1394 hardware. */
+
+static int simulate = 0;
+static struct timeval simulate_start;
+
+#define SIM_PACKET_SIZE (4 + 8 + 480 + 4)
+
+/* One isochronous packet as received with VIDEO1394_INCLUDE_ISO_HEADERS:
+   iso header, CIP header, DV data, trailer. */
+static int simulate_next_packet(unsigned char* packet)
+{
+	static int frame_packet = 0;
+	static int frame = 0;
+	static unsigned char continuity_counter = 0;
+	static long cip_counter = 0;
+	int len = 8;
+
+	memset(packet, 0, SIM_PACKET_SIZE);
+	packet[4] = 0x01;
+	packet[5] = 0x78;
+	packet[7] = continuity_counter;
+	packet[8] = 0x80;
+	packet[9] = 0x80;
+	packet[10] = 0xff;
+	packet[11] = 0xff;
+
+	cip_counter += cip_n_pal;
+	if (cip_counter > cip_d_pal) {
+		cip_counter -= cip_d_pal;
+	} else {
+		/* the DIF block ids are left out, only the start of the
+		   frame has to be recognised */
+		memset(packet + 12, frame & 0x7f, 480);
+		if (frame_packet == 0) {
+			packet[12] = 0x1f;
+			packet[13] = 0x07;
+			packet[14] = 0x00;
+			packet[15] = 0xbf;
+		}
+		if (++frame_packet == 144000 / 480) {
+			frame_packet = 0;
+			frame++;
+		}
+		continuity_counter++;
+		len += 480;
+	}
+	packet[2] = len & 0xff;
+	packet[3] = len >> 8;
+	return len + 8;
+}
+
+static void simulate_receive(unsigned char* buf, int size)
+{
+	static unsigned char packet[SIM_PACKET_SIZE];
+	static int packet_len = 0;
+	static int packet_ofs = 0;
+	int n;
+
+	while (size > 0) {
+		if (packet_ofs == packet_len) {
+			packet_len = simulate_next_packet(packet);
+			packet_ofs = 0;
+		}
+		n = packet_len - packet_ofs;
+		if (n > size) {
+			n = size;
+		}
+		memcpy(buf, packet + packet_ofs, n);
+		packet_ofs += n;
+		buf += n;
+		size -= n;
+	}
+}
+
+static void simulate_report(const char* what, int frames)
+{
+	struct timeval now;
+	double secs;
+
+	gettimeofday(&now, NULL);
+	secs = (now.tv_sec - simulate_start.tv_sec)
+		+ (now.tv_usec - simulate_start.tv_usec) / 1000000.0;
+	fprintf(stderr, "\n%s %d frames in %.2f seconds (%.1f frames/s)\n",
+		what, frames, secs, secs > 0 ? frames / secs : 0.0);
+}
+
 /* ------------------------------------------------------------------------
    - receiver
    ------------------------------------------------------------------------ */
@@ -260,10 +509,7 @@ void handle_packet(unsigned char* data, int len)
 
 			if (f && !frame_broken) {
 				f->usage = frame_size;
-				push_back(&buf_queue, f);
-				pthread_mutex_lock(&wakeup_mutex);
-				pthread_cond_signal(&wakeup_cond);
-				pthread_mutex_unlock(&wakeup_mutex);
+				ring_push(&buf_queue, f);
 				f = NULL;
 			}
 
@@ -308,16 +554,11 @@ void handle_packet(unsigned char* data, int len)
 
 void* write_out_thread(void * arg)
 {
-	while (cap_num_frames != 0) {
-		struct buf_node * f;
-		pthread_mutex_lock(&wakeup_mutex);
-		pthread_cond_wait(&wakeup_cond, &wakeup_mutex);
-		pthread_mutex_unlock(&wakeup_mutex);
-
-		while ((f = pop_front(&buf_queue)) != NULL) {
-			fwrite(f->data, 1, f->usage, dst_fp);
-			push_back(&free_list, f);
-		}
+	struct buf_node * f;
+
+	while ((f = ring_pop_wait(&buf_queue)) != NULL) {
+		fwrite(f->data, 1, f->usage, dst_fp);
+		ring_push(&free_ring, f);
 	}
 	return NULL;
 }
@@ -356,11 +597,6 @@ int capture_raw(const char* filename, int channel, int nbuffers,
 		}
 	}
 
-	if ((viddev = open(device, O_RDWR)) < 0) {
-		perror("open video1394 device");
-		return -1;
-	}
-
 	v.channel = channel;
 	v.sync_tag = 0;
 	v.nb_buffers = nbuffers;
@@ -369,22 +605,38 @@ int capture_raw(const char* filename, int channel, int nbuffers,
 	v.syt_offset = syt_offset;
 	v.flags = VIDEO1394_INCLUDE_ISO_HEADERS;
 	w.channel = v.channel;
-                      
-	if (ioctl(viddev, VIDEO1394_LISTEN_CHANNEL, &v) < 0) {
-		perror("VIDEO1394_LISTEN_CHANNEL");
-		return -1;
+
+	if (simulate) {
+		viddev = -1;
+		recv_buf = (unsigned char *) malloc(v.nb_buffers * v.buf_size);
+		if (!recv_buf) {
+			perror("malloc videobuffer");
+			return -1;
+		}
+	} else {
+		if ((viddev = open(device, O_RDWR)) < 0) {
+			perror("open video1394 device");
+			return -1;
+		}
+
+		if (ioctl(viddev, VIDEO1394_LISTEN_CHANNEL, &v) < 0) {
+			perror("VIDEO1394_LISTEN_CHANNEL");
+			return -1;
+		}
+
+		if ((recv_buf = (unsigned char *) mmap(
+				0, v.nb_buffers*v.buf_size,
+				PROT_READ|PROT_WRITE, MAP_SHARED, viddev, 0))
+		    == (unsigned char *)-1) {
+			perror("mmap videobuffer");
+			return -1;
+		}
 	}
 
-	if ((recv_buf = (unsigned char *) mmap(
-			0, v.nb_buffers*v.buf_size, PROT_READ|PROT_WRITE,
-			MAP_SHARED, viddev, 0)) == (unsigned char *)-1) {
-		perror("mmap videobuffer");
+	if (init_buffers() < 0) {
 		return -1;
 	}
-
-	pthread_mutex_init(&queue_mutex, NULL);
-	pthread_mutex_init(&wakeup_mutex, NULL);
-	pthread_cond_init(&wakeup_cond, NULL);
+	gettimeofday(&simulate_start, NULL);
 
 	pthread_create(&file_io_thread, NULL, write_out_thread, NULL);
 
@@ -406,14 +658,17 @@ int capture_raw(const char* filename, int channel, int nbuffers,
 		
 		wcopy = w;
 		
-		if (ioctl(viddev,VIDEO1394_LISTEN_QUEUE_BUFFER, &wcopy) < 0) {
+		if (!simulate && ioctl(viddev, VIDEO1394_LISTEN_QUEUE_BUFFER,
+				       &wcopy) < 0) {
 			perror("VIDEO1394_LISTEN_QUEUE_BUFFER");
 		}
 		w.buffer++;
 		w.buffer %= v.nb_buffers;
 	}
 	wcopy = w;
-	if (ioctl(viddev, VIDEO1394_LISTEN_WAIT_BUFFER, &wcopy) < 0) {
+	if (simulate) {
+		simulate_receive(recv_buf + v.buf_size * w.buffer, v.buf_size);
+	} else if (ioctl(viddev, VIDEO1394_LISTEN_WAIT_BUFFER, &wcopy) < 0) {
 		perror("VIDEO1394_LISTEN_WAIT_BUFFER");
 	}
 	curr = recv_buf + v.buf_size * w.buffer;
@@ -442,20 +697,30 @@ int capture_raw(const char* filename, int channel, int nbuffers,
 	unused_buffers = 1;
 	}
 
+	ring_close(&buf_queue);
+
 	if (broken_frames) {
 		fprintf(stderr, "\nCaptured %d broken frames!\n", broken_frames);
 	}
 
-	munmap(recv_buf, v.nb_buffers * v.buf_size);
-	
-	if (ioctl(viddev, VIDEO1394_UNLISTEN_CHANNEL, &v.channel)<0) {
-		perror("VIDEO1394_UNLISTEN_CHANNEL");
+	if (simulate) {
+		free(recv_buf);
+	} else {
+		munmap(recv_buf, v.nb_buffers * v.buf_size);
+
+		if (ioctl(viddev, VIDEO1394_UNLISTEN_CHANNEL, &v.channel)<0) {
+			perror("VIDEO1394_UNLISTEN_CHANNEL");
+		}
+
+		close(viddev);
 	}
-	
-	close(viddev);
 
 	pthread_join(file_io_thread, NULL);
 
+	if (simulate) {
+		simulate_report("Captured", frames_captured);
+	}
+
 	if (dst_fp != stdout) {
 		fclose(dst_fp);
 	}
@@ -474,9 +739,6 @@ static unsigned char * underrun_data_frame = NULL;
 static int underrun_frame_ispal = 0;
 static unsigned char *device = NULL;
 
-static pthread_mutex_t  wakeup_rev_mutex;
-static pthread_cond_t   wakeup_rev_cond;
-
 int read_frame(FILE* fp, unsigned char* frame, int* isPAL)
 {
 	if (is_eof) {
@@ -526,49 +788,36 @@ open_next_input(void)
 }
 
 
-void fill_buf_queue(int fire)
+void* read_in_thread(void * arg)
 {
 	struct buf_node * f;
+	int isPAL;
 
-	while ((f = get_free_block()) != NULL) {
-		int isPAL;
-again:
-		if (read_frame(src_fp, f->data, &isPAL) < 0) {
+	for (;;) {
+		if ((f = get_free_block()) == NULL) {
+			signal_buffers_primed();
+			if ((f = get_free_block_wait()) == NULL) {
+				break;
+			}
+		}
+		while (read_frame(src_fp, f->data, &isPAL) < 0) {
 			is_eof = open_next_input ();
-			if (!is_eof)
-				goto again;
-			push_back(&free_list, f);
-			return;
+			if (is_eof)
+				break;
+		}
+		if (is_eof) {
+			free(f);
+			break;
 		}
 		if (isPAL) {
 			f->usage = 144000;
 		} else {
 			f->usage = 120000;
 		}
-		push_back(&buf_queue, f);
-		if (fire) {
-			pthread_mutex_lock(&wakeup_rev_mutex);
-			pthread_cond_signal(&wakeup_rev_cond);
-			pthread_mutex_unlock(&wakeup_rev_mutex);
-		}
-	}
-}
-
-void* read_in_thread(void * arg)
-{
-	fill_buf_queue(0);
-
-	pthread_mutex_lock(&wakeup_rev_mutex);
-	pthread_cond_signal(&wakeup_rev_cond);
-	pthread_mutex_unlock(&wakeup_rev_mutex);
-
-	while (!is_eof) {
-		pthread_mutex_lock(&wakeup_mutex);
-		pthread_cond_wait(&wakeup_cond, &wakeup_mutex);
-		pthread_mutex_unlock(&wakeup_mutex);
-
-		fill_buf_queue(1);
+		ring_push(&buf_queue, f);
 	}
+	signal_buffers_primed();
+	ring_close(&buf_queue);
 	return NULL;
 }
 
@@ -585,48 +834,38 @@ static int fill_buffer(unsigned char* targetbuf, unsigned int * packet_sizes)
 	static unsigned int cip_n = 0;
 	static unsigned int cip_d = 0;
 
-	f_node = pop_front(&buf_queue);
-	if (!f_node) {
-		if (!is_eof) {
-			if (!underrun_data_frame) {
-				fprintf(stderr, "Buffer underrun ");
-				if (ceil_buffer_blocks > 0 &&
-				    max_buffer_blocks < ceil_buffer_blocks) {
-					max_buffer_blocks += 25;
-					fprintf(stderr,
+	f_node = ring_pop(&buf_queue);
+	if (!f_node && !ring_is_closed(&buf_queue)) {
+		if (!underrun_data_frame) {
+			fprintf(stderr, "Buffer underrun ");
+			if (ceil_buffer_blocks > 0 &&
+			    max_buffer_blocks < ceil_buffer_blocks) {
+				__atomic_store_n(&max_buffer_blocks,
+						 max_buffer_blocks + 25,
+						 __ATOMIC_RELAXED);
+				fprintf(stderr,
 					"(raising buffer limit +25 => %d)!\n",
 					max_buffer_blocks);
-				} else {
-					fprintf(stderr,
-						"(not raising buffer space, "
-					        "hard limit reached)\n");
-				}
-
-
-				pthread_mutex_lock(&wakeup_rev_mutex);
-				pthread_cond_wait(&wakeup_rev_cond, 
-						  &wakeup_rev_mutex);
-				pthread_mutex_unlock(&wakeup_rev_mutex);
-				f_node = pop_front(&buf_queue);
+				ring_wake(&free_ring);
 			} else {
-				f_node = get_free_block();
-
-				if (underrun_frame_ispal) {
-					f_node->usage = 144000;
-				} else {
-					f_node->usage = 120000;
-				}
-				memcpy(f_node->data, underrun_data_frame, 
-				       f_node->usage);
+				fprintf(stderr,
+					"(not raising buffer space, "
+					"hard limit reached)\n");
 			}
-
-		} else {
-			return -1;
 		}
 	}
-
-	frame = f_node->data;
-	frame_size = f_node->usage;
+	if (f_node) {
+		frame = f_node->data;
+		frame_size = f_node->usage;
+	} else if (underrun_data_frame && !ring_is_closed(&buf_queue)) {
+		frame = underrun_data_frame;
+		frame_size = underrun_frame_ispal ? 144000 : 120000;
+	} else if ((f_node = ring_pop_wait(&buf_queue)) != NULL) {
+		frame = f_node->data;
+		frame_size = f_node->usage;
+	} else {
+		return -1;
+	}
 
 	isPAL = (frame_size == 144000);
 
@@ -675,11 +914,9 @@ static int fill_buffer(unsigned char* targetbuf, unsigned int * packet_sizes)
 	}
 	*packet_sizes++ = 0;
 
-	push_back(&free_list, f_node);
-
-	pthread_mutex_lock(&wakeup_mutex);
-	pthread_cond_signal(&wakeup_cond);
-	pthread_mutex_unlock(&wakeup_mutex);
+	if (f_node) {
+		ring_push(&free_ring, f_node);
+	}
 
         return 0;
 }
@@ -694,6 +931,7 @@ int send_raw(const char*const* filenames, int channel, int nbuffers,
 	struct video1394_queue_variable w;
 	int unused_buffers;
 	int got_frame;
+	int frames_sent = 0;
 	unsigned int packet_sizes[321];
 
 	if ( filenames == NULL )
@@ -744,13 +982,6 @@ int send_raw(const char*const* filenames, int channel, int nbuffers,
 			return -1;
 	}
 
-	if ((viddev = open(device,O_RDWR)) < 0) {
-		perror("open video1394 device");
-		if (src_fp && src_fp != stdin)
-			fclose (src_fp);
-		return -1;
-  	}
-                      
 	v.channel = channel;
 	v.sync_tag = 0;
 	v.nb_buffers = nbuffers;
@@ -760,21 +991,44 @@ int send_raw(const char*const* filenames, int channel, int nbuffers,
 	v.syt_offset = syt_offset;
 	w.channel = v.channel;
 
-	if (ioctl(viddev, VIDEO1394_TALK_CHANNEL, &v) < 0) {
-		perror("VIDEO1394_TALK_CHANNEL");
-		close (viddev);
-		if (src_fp && src_fp != stdin)
-			fclose (src_fp);
-		return -1;
+	if (simulate) {
+		viddev = -1;
+		send_buf = (unsigned char *) malloc(v.nb_buffers * v.buf_size);
+		if (!send_buf) {
+			perror("malloc videobuffer");
+			if (src_fp && src_fp != stdin)
+				fclose (src_fp);
+			return -1;
+		}
+	} else {
+		if ((viddev = open(device,O_RDWR)) < 0) {
+			perror("open video1394 device");
+			if (src_fp && src_fp != stdin)
+				fclose (src_fp);
+			return -1;
+		}
+
+		if (ioctl(viddev, VIDEO1394_TALK_CHANNEL, &v) < 0) {
+			perror("VIDEO1394_TALK_CHANNEL");
+			close (viddev);
+			if (src_fp && src_fp != stdin)
+				fclose (src_fp);
+			return -1;
+		}
+
+		if ((send_buf = (unsigned char *) mmap(
+				0, v.nb_buffers * v.buf_size,
+				PROT_READ|PROT_WRITE, MAP_SHARED, viddev, 0))
+		    == (unsigned char *)-1) {
+			perror("mmap videobuffer");
+			close (viddev);
+			if (src_fp && src_fp != stdin)
+				fclose (src_fp);
+			return -1;
+		}
 	}
 
-	if ((send_buf = (unsigned char *) mmap(
-			0, v.nb_buffers * v.buf_size, PROT_READ|PROT_WRITE,
-			MAP_SHARED, viddev, 0)) == (unsigned char *)-1) {
-		perror("mmap videobuffer");
-		close (viddev);
-		if (src_fp && src_fp != stdin)
-		fclose (src_fp);
+	if (init_buffers() < 0) {
 		return -1;
 	}
 
@@ -785,21 +1039,14 @@ int send_raw(const char*const* filenames, int channel, int nbuffers,
 	/* signal(SIGTERM, sig_int_send_handler);
 	   signal(SIGINT, sig_int_send_handler); */
 
-	pthread_mutex_init(&queue_mutex, NULL);
-	pthread_mutex_init(&wakeup_mutex, NULL);
-	pthread_cond_init(&wakeup_cond, NULL);
-	pthread_mutex_init(&wakeup_rev_mutex, NULL);
-	pthread_cond_init(&wakeup_rev_cond, NULL);
-
 	pthread_create(&file_io_thread, NULL, read_in_thread, NULL);
 
-	pthread_mutex_lock(&wakeup_rev_mutex);
-	pthread_cond_wait(&wakeup_rev_cond, &wakeup_rev_mutex);
-	pthread_mutex_unlock(&wakeup_rev_mutex);
+	wait_buffers_primed();
 
 	if (verbose_mode) {
 		fprintf(stderr, "Transmitting...\r");
 	}
+	gettimeofday(&simulate_start, NULL);
 
 	unused_buffers = v.nb_buffers;
 	w.buffer = 0;
@@ -816,7 +1063,8 @@ int send_raw(const char*const* filenames, int channel, int nbuffers,
 			if (!got_frame) {
 				break;
 			}
-			if (ioctl(viddev, VIDEO1394_TALK_QUEUE_BUFFER, &w)<0) {
+			if (!simulate &&
+			    ioctl(viddev, VIDEO1394_TALK_QUEUE_BUFFER, &w)<0) {
 				perror("VIDEO1394_TALK_QUEUE_BUFFER");
 			}
 			if (verbose_mode) {
@@ -826,29 +1074,39 @@ int send_raw(const char*const* filenames, int channel, int nbuffers,
 			w.buffer ++;
 			w.buffer %= v.nb_buffers;
 			start_frame++;
+			frames_sent++;
 		}
 		if (!got_frame) {
 			break;
 		}
-		if (ioctl(viddev, VIDEO1394_TALK_WAIT_BUFFER, &w) < 0) {
+		if (!simulate &&
+		    ioctl(viddev, VIDEO1394_TALK_WAIT_BUFFER, &w) < 0) {
 			perror("VIDEO1394_TALK_WAIT_BUFFER");
 		}
 		unused_buffers = 1;
 	}
-  
-	w.buffer = (v.nb_buffers + w.buffer - 1) % v.nb_buffers;
-	
-	if (ioctl(viddev, VIDEO1394_TALK_WAIT_BUFFER, &w) < 0) {
-		perror("VIDEO1394_TALK_WAIT_BUFFER");
-	}
-	
-	munmap(send_buf, v.nb_buffers * v.buf_size);
-	
-	if (ioctl(viddev, VIDEO1394_UNTALK_CHANNEL, &v.channel)<0) {
-		perror("VIDEO1394_UNTALK_CHANNEL");
+
+	/* lets the file io thread go if it is waiting for a free frame */
+	ring_close(&free_ring);
+
+	if (simulate) {
+		free(send_buf);
+		simulate_report("Sent", frames_sent);
+	} else {
+		w.buffer = (v.nb_buffers + w.buffer - 1) % v.nb_buffers;
+
+		if (ioctl(viddev, VIDEO1394_TALK_WAIT_BUFFER, &w) < 0) {
+			perror("VIDEO1394_TALK_WAIT_BUFFER");
+		}
+
+		munmap(send_buf, v.nb_buffers * v.buf_size);
+
+		if (ioctl(viddev, VIDEO1394_UNTALK_CHANNEL, &v.channel)<0) {
+			perror("VIDEO1394_UNTALK_CHANNEL");
+		}
+
+		close(viddev);
 	}
-	
-	close(viddev);
 
 	pthread_join(file_io_thread, NULL);
 
@@ -897,7 +1155,8 @@ int rt_raisepri (int pri)
 #define DV_CONNECT_OPT_UNDERRUN_DATA    11
 #define DV_CONNECT_OPT_AUTOHELP         12
 #define DV_CONNECT_OPT_DEVICE           13
-#define DV_CONNECT_NUM_OPTS             14
+#define DV_CONNECT_OPT_SIMULATE         14
+#define DV_CONNECT_NUM_OPTS             15
 
 
 int main(int argc, const char** argv)
@@ -1026,6 +1285,13 @@ int main(int argc, const char** argv)
                 descrip: "Specify the video1394 device (default /dev/video1394/0)",
         }; /* device */
 
+        option_table[DV_CONNECT_OPT_SIMULATE] = (struct poptOption) {
+                longName:   "simulate", 
+                arg:        &simulate,
+                descrip:    "use a simulated bus instead of the video1394 "
+		"device, to benchmark the frame queueing"
+        }; /* simulate */
+
         option_table[DV_CONNECT_NUM_OPTS] = (struct poptOption) { 
                 NULL, 0, 0, NULL, 0 };
 
@@ -1085,6 +1351,11 @@ int main(int argc, const char** argv)
 	if ( device == NULL )
 		device = "/dev/video1394/0";
 
+	if (simulate && !send_mode && end == 0xfffffff) {
+		/* the simulated camera never stops */
+		end = start + 1000;
+	}
+
 	if (send_mode) {
 		send_raw(poptGetArgs(optCon), channel, buffers, start, end,
 			verbose_mode, underrun_data, device);
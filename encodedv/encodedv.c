@@ -47,7 +47,8 @@
 #define DV_ENCODER_OPT_FORCE_DCT       12
 #define DV_ENCODER_OPT_16X9            13
 #define DV_ENCODER_OPT_STDIN           14
-#define DV_ENCODER_NUM_OPTS            15
+#define DV_ENCODER_OPT_THREADS         15
+#define DV_ENCODER_NUM_OPTS            16
 
 int main(int argc, char *argv[])
 {
@@ -71,6 +72,7 @@ int main(int argc, char *argv[])
 	int err_code;
 	int force_dct = -1;
 	int	isStdin = 0;
+	int num_threads = -1;
 
 #if HAVE_LIBPOPT
 	struct poptOption option_table[DV_ENCODER_NUM_OPTS+1]; 
@@ -189,6 +191,16 @@ int main(int argc, char *argv[])
 		descrip:    "set stdin input"
 	}; /* stdin */
 
+	option_table[DV_ENCODER_OPT_THREADS] = (struct poptOption) {
+		longName:   "threads", 
+		shortName:  't', 
+		arg:        &num_threads,
+		argInfo:    POPT_ARG_INT, 
+		argDescrip: "count",
+		descrip:    "number of frames encoded in parallel "
+		"(default: one per CPU, 0: no threads)"
+	}; /* threads */
+
 	option_table[DV_ENCODER_OPT_AUTOHELP] = (struct poptOption) {
 		argInfo: POPT_ARG_INCLUDE_TABLE,
 		arg:     poptHelpOptions,
@@ -354,7 +366,7 @@ int main(int argc, char *argv[])
 	err_code = dv_encoder_loop(input_filter,audio_input_filter, output_filter,
 				start, end, filename, audio_filename,
 				vlc_encode_passes, static_qno,
-				verbose_mode, fps, is16x9);
+				verbose_mode, fps, is16x9, num_threads);
 
 	input_filter->finish();
 	if (audio_input_filter) {
@@ -39,16 +39,12 @@
 #include <stdlib.h>
 
 #include "YUY2.h"
+#include "tables.h"
 
 #if ARCH_X86 || ARCH_X86_64
 #include "mmx.h"
 #endif // ARCH_X68 | ARCH_X86_64
 
-/* Lookup tables for mapping signed to unsigned, and clamping */
-static unsigned char	real_uvlut[256], *uvlut;
-static unsigned char	real_ylut[768],  *ylut;
-static unsigned char	real_ylut_setup[768],  *ylut_setup;
-
 #if ARCH_X86 || ARCH_X86_64
 /* Define some constants used in MMX range mapping and clamping logic */
 static mmx_t		mmx_0x0010s = (mmx_t) 0x0010001000100010LL,
@@ -69,39 +65,12 @@ static mmx_t		mmx_0x0010s = (mmx_t) 0x0010001000100010LL,
 /* ----------------------------------------------------------------------------
  */
 void
-dv_YUY2_init(int clamp_luma, int clamp_chroma) {
-  int i;
-  int value;
-
-  uvlut = real_uvlut + 128; // index from -128 .. 127
-  for(i=-128;
-      i<128;
-      ++i) {
-    value = i + 128;
-    if (clamp_chroma == TRUE) value = CLAMP(value, 16, 240);
-    uvlut[i] = value;
-  } /* for */
-
-  ylut = real_ylut + 256; // index from -256 .. 511
-  ylut_setup = real_ylut_setup + 256;
-  for(i=-256;
-      i<512;
-      ++i) {
-	value = i + 128;
-	if (clamp_luma == TRUE) value = CLAMP(value, 16, 235);
-	else value = CLAMP(value, 0, 255);
-	ylut[i] = value;
-	value += 16;
-	ylut_setup[i] = CLAMP(value, 0, 255);
-  } /* for */
-} /* dv_YUY2_init */
-
-/* ----------------------------------------------------------------------------
- */
-void
-dv_mb411_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup) {
+dv_mb411_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+              const dv_color_luts_t *luts) {
+  const unsigned char	*uvlut = luts->uvlut;
   dv_coeff_t		*Y[4], *cr_frame, *cb_frame;
-  unsigned char	        *pyuv, *pwyuv, cb, cr, *my_ylut;
+  unsigned char	        *pyuv, *pwyuv, cb, cr;
+  const unsigned char	*my_ylut;
   int			i, j, row;
 
   Y [0] = mb->b[0].coeffs;
@@ -112,7 +81,7 @@ dv_mb411_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_
   cb_frame = mb->b[5].coeffs;
 
   pyuv = pixels[0] + (mb->x * 2) + (mb->y * pitches[0]);
-  my_ylut = (add_ntsc_setup == TRUE ? ylut_setup : ylut);
+  my_ylut = (add_ntsc_setup == TRUE ? luts->yuy2_ylut_setup : luts->yuy2_ylut);
 
   for (row = 0; row < 8; ++row) { // Eight rows
     pwyuv = pyuv;
@@ -169,10 +138,13 @@ dv_mb411_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_
 /* ----------------------------------------------------------------------------
  */
 void
-dv_mb411_right_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup) {
+dv_mb411_right_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+              const dv_color_luts_t *luts) {
+  const unsigned char	*uvlut = luts->uvlut;
 
   dv_coeff_t		*Y[4], *Ytmp, *cr_frame, *cb_frame;
-  unsigned char	        *pyuv, *pwyuv, cb, cr, *my_ylut;
+  unsigned char	        *pyuv, *pwyuv, cb, cr;
+  const unsigned char	*my_ylut;
   int			i, j, col, row;
 
 
@@ -182,7 +154,7 @@ dv_mb411_right_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add
   Y[3] = mb->b[3].coeffs;
 
   pyuv = pixels[0] + (mb->x * 2) + (mb->y * pitches[0]);
-  my_ylut = (add_ntsc_setup == TRUE ? ylut_setup : ylut);
+  my_ylut = (add_ntsc_setup == TRUE ? luts->yuy2_ylut_setup : luts->yuy2_ylut);
 
   for (j = 0; j < 4; j += 2) { // Two rows of blocks
     cr_frame = mb->b[4].coeffs + (j * 2);
@@ -246,7 +218,10 @@ dv_mb411_right_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add
 /* ----------------------------------------------------------------------------
  */
 void
-dv_mb420_YUY2 (dv_macroblock_t *mb, uint8_t **pixels, int *pitches) {
+dv_mb420_YUY2 (dv_macroblock_t *mb, uint8_t **pixels, int *pitches,
+               const dv_color_luts_t *luts) {
+  const unsigned char	*uvlut = luts->uvlut;
+  const unsigned char	*ylut = luts->yuy2_ylut;
     dv_coeff_t    *Y [4], *Ytmp0, *cr_frame, *cb_frame;
     unsigned char *pyuv,*pwyuv0, *pwyuv1,
                   cb, cr;
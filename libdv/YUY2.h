@@ -47,12 +47,13 @@
 extern "C" {
 #endif
 
-extern void dv_YUY2_init(int clamp_luma, int clamp_chroma);
-
 /* scalar versions */
-extern void dv_mb411_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup);
-extern void dv_mb411_right_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup);
-extern void dv_mb420_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches);
+extern void dv_mb411_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+                          const dv_color_luts_t *luts);
+extern void dv_mb411_right_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+                          const dv_color_luts_t *luts);
+extern void dv_mb420_YUY2(dv_macroblock_t *mb, uint8_t **pixels, int *pitches,
+                          const dv_color_luts_t *luts);
 
 #if ARCH_X86 || ARCH_X86_64
 /* pentium architecture mmx versions */
@@ -30,15 +30,12 @@
 
 #include <stdlib.h>
 #include "YV12.h"
+#include "tables.h"
 
 #if ARCH_X86 || ARCH_X86_64
 #include "mmx.h"
 #endif // ARCH_X86 || ARCH_X86_64
 
-/* Lookup tables for mapping signed to unsigned, and clamping */
-static unsigned char	real_uvlut[256], *uvlut;
-static unsigned char	real_ylut[768],  *ylut;
-
 #if ARCH_X86 || ARCH_X86_64
 /* Define some constants used in MMX range mapping and clamping logic */
 static mmx_t		mmx_0x10s   = (mmx_t) 0x1010101010101010LL,
@@ -50,31 +47,10 @@ static mmx_t		mmx_0x10s   = (mmx_t) 0x1010101010101010LL,
 #endif // ARCH_X86 || ARCH_X86_64
 
 void 
-dv_YV12_init(int clamp_luma, int clamp_chroma) {
-  int i;
-  int value;
-
-  uvlut = real_uvlut + 128; // index from -128 .. 127
-  for(i=-128;
-      i<128;
-      ++i) {
-    value = i + 128;
-    if (clamp_chroma == TRUE) value = CLAMP(value, 16, 240);
-    uvlut[i] = value;
-  } /* for */
-  
-  ylut = real_ylut + 256; // index from -256 .. 511
-  for(i=-256;
-      i<512;
-      ++i) {
-    value = i + 128;
-    if (clamp_luma == TRUE) value = CLAMP(value, 16, 235);
-    ylut[i] = value;
-  } /* for */
-} /* dv_YV12_init */
-
-void 
-dv_mb420_YV12(dv_macroblock_t *mb, uint8_t **pixels, uint16_t *pitches) {
+dv_mb420_YV12(dv_macroblock_t *mb, uint8_t **pixels, uint16_t *pitches,
+              const dv_color_luts_t *luts) {
+  const unsigned char	*uvlut = luts->uvlut;
+  const unsigned char	*ylut = luts->yv12_ylut;
   dv_coeff_t		*Y[4], *UV[2], *Ytmp, *UVtmp;
   unsigned char	        *py, *pwy, *puv, *pwuv;
   int			i, j, row, col;
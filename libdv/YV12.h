@@ -46,10 +46,9 @@
 extern "C" {
 #endif
 
-extern void dv_YV12_init(int clamp_luma, int clamp_chroma);
-
 /* scalar version */
-extern void dv_mb420_YV12(dv_macroblock_t *mb, uint8_t **pixels, uint16_t *pitches); 
+extern void dv_mb420_YV12(dv_macroblock_t *mb, uint8_t **pixels, uint16_t *pitches,
+                          const dv_color_luts_t *luts);
 
 #if ARCH_X86 || ARCH_X86_64
 /* pentium architecture mmx version */
@@ -0,0 +1,129 @@
+/*
+ *  analyze.c
+ *
+ *  This file is part of libdv, a free DV (IEC 61834/SMPTE 314M)
+ *  codec.
+ *
+ *  libdv is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation; either version 2.1, or (at your
+ *  option) any later version.
+ *
+ *  libdv is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with libdv; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ *  The libdv homepage is http://libdv.sourceforge.net/.
+ */
+
+/** @file
+ *  @ingroup decoder
+ *  @brief Quality and complexity statistics of DV frames
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include "dv.h"
+#include "bitstream.h"
+#include "parse.h"
+
+/** @brief Gather quality and complexity statistics of a DV frame.
+ *
+ * Every video segment is parsed down to its VLC coefficients, as for
+ * decoding, but there is no dequantisation, IDCT or rendering.  The
+ * statistics cover the whole frame and each superblock, the regions
+ * being stored row by row with 5 superblocks per row.  The AC bits
+ * used are also given for each video segment, out of the
+ * DV_ANALYSIS_SEGMENT_BITS it has; its five macroblocks lie in
+ * different superblocks, so the bits do not add up by region.
+ *
+ * A block without an EOB ran out of bits: the encoder dropped
+ * coefficients or the data is damaged.  VLC errors and macroblocks the
+ * recorder flagged in their STA field point at tape damage.
+ *
+ * @param dv The decoder, the header of the frame is parsed into it
+ * @param buffer The DV frame
+ * @param fa The statistics
+ * @return 0 for success, -1 if the frame header is damaged
+ */
+int
+dv_analyze_frame(dv_decoder_t *dv, const uint8_t *buffer,
+		 dv_frame_analysis_t *fa) {
+  bitstream_t bs = { 0 };
+  dv_videosegment_t vs = { 0, 0, &bs };
+  dv_videosegment_t *seg = &vs;
+  dv_region_analysis_t *region;
+  dv_macroblock_t *mb;
+  dv_block_t *bl;
+  const uint8_t *data;
+  int ds, v, m, b, unused, error;
+
+  if (dv_parse_header(dv, buffer) < 0)
+    return -1;
+
+  memset(fa, 0, sizeof(dv_frame_analysis_t));
+  fa->isPAL = (dv->system == e_dv_system_625_50);
+  fa->num_regions = dv->num_dif_seqs * 5;
+  seg->isPAL = fa->isPAL;
+
+  pthread_mutex_lock(&_dv_parse_mutex);
+  for (ds = 0; ds < dv->num_dif_seqs; ds++) {
+    for (v = 0; v < 27; v++) {
+      data = buffer + (ds * 150 + 6 + v / 3 + 1 + v * 5) * 80;
+      seg->i = ds;
+      seg->k = v;
+      _dv_bitstream_new_buffer(seg->bs, (uint8_t *)data, 80*5);
+      dv_parse_video_segment(seg, DV_QUALITY_BEST);
+
+      unused = 0;
+      for (m = 0, mb = seg->mb; m < 5; m++, mb++) {
+	region = &fa->regions[mb->i * 5 + mb->j];
+	region->macroblocks++;
+	region->qno_sum += mb->qno;
+	fa->qnos[mb->qno]++;
+	error = 0;
+	if (mb->vlc_error) {
+	  fa->vlc_errors++;
+	  error = 1;
+	} /* if */
+	if (data[m * 80 + 3] >> 4) {
+	  fa->sta_errors++;
+	  error = 1;
+	} /* if */
+	region->errors += error;
+	for (b = 0, bl = mb->b; b < 6; b++, bl++) {
+	  fa->classes[bl->class_no]++;
+	  if (bl->dct_mode == DV_DCT_248) {
+	    fa->dct_248++;
+	    region->dct_248++;
+	  } /* if */
+	  if (!bl->eob) {
+	    fa->incomplete_blocks++;
+	    region->incomplete_blocks++;
+	  } /* if */
+	  unused += bl->end - bl->offset;
+	} /* for b */
+      } /* for m */
+      fa->segment_bits[ds * 27 + v] = DV_ANALYSIS_SEGMENT_BITS - unused;
+      fa->bits_used += DV_ANALYSIS_SEGMENT_BITS - unused;
+      if (unused < 4)
+	fa->full_segments++;
+    } /* for v */
+  } /* for ds */
+  pthread_mutex_unlock(&_dv_parse_mutex);
+
+  fa->segments = dv->num_dif_seqs * 27;
+  fa->macroblocks = fa->segments * 5;
+  fa->blocks = fa->macroblocks * 6;
+  fa->bits_available = fa->segments * DV_ANALYSIS_SEGMENT_BITS;
+  return 0;
+} /* dv_analyze_frame */
@@ -34,6 +34,7 @@
 #include "dv.h"
 #include "util.h"
 #include "audio.h"
+#include "bitstream.h"
 
 int dv_is_normal_speed (dv_decoder_t*);
 
@@ -248,6 +249,10 @@ dv_audio_new(void)
   if(!(result = (dv_audio_t *)calloc(1,sizeof(dv_audio_t)))) goto no_mem;
 
 #if HAVE_LIBPOPT
+  result->option_table = (struct poptOption *)
+    calloc(DV_AUDIO_NUM_OPTS+1, sizeof(struct poptOption));
+  if(!result->option_table) goto no_opt;
+
   result->option_table[DV_AUDIO_OPT_FREQUENCY] = (struct poptOption){
     longName:   "frequency",
     shortName:  'f',
@@ -293,6 +298,11 @@ dv_audio_new(void)
   /* dv_test12bit_conv (); */
   return(result);
 
+#if HAVE_LIBPOPT
+ no_opt:
+  free(result);
+  result = NULL;
+#endif /* HAVE_LIBPOPT */
  no_mem:
   return(result);
 } /* dv_audio_new */
@@ -358,15 +368,53 @@ dv_dump_audio_header (dv_decoder_t *decoder, int ds, uint8_t *inbuf)
 
 /* ---------------------------------------------------------------------------
  */
-int
-dv_parse_audio_header(dv_decoder_t *decoder, const uint8_t *inbuf)
+/* Offset of audio DIF block blk (0..8) of DIF sequence ds within a frame:
+ * skip ds sequences of 150 blocks, the 6 header blocks and blk times
+ * (1 audio + 15 video) blocks.
+ */
+#define DV_AUDIO_DIF_OFFSET(ds,blk) (80 * (150 * (ds) + 6 + 16 * (blk)))
+
+typedef const uint8_t *(*dv_audio_dif_func_t) (void *priv, int ds, int blk);
+
+static const uint8_t *
+dv_audio_dif_flat (void *priv, int ds, int blk)
+{
+  return (const uint8_t *) priv + DV_AUDIO_DIF_OFFSET (ds, blk);
+}
+
+typedef struct {
+  dv_iov_cursor_t cursor;
+  int             next;
+  uint8_t         scratch [4][80];
+} dv_audio_dif_iov_t;
+
+/* at most 4 packs are looked at per header, so 4 scratch blocks suffice */
+static const uint8_t *
+dv_audio_dif_iov (void *priv, int ds, int blk)
+{
+  dv_audio_dif_iov_t *p = priv;
+
+  return _dv_iov_map (&p -> cursor, DV_AUDIO_DIF_OFFSET (ds, blk), 80,
+                      p -> scratch [p -> next++ & 3]);
+}
+
+/* ---------------------------------------------------------------------------
+ */
+static int
+dv_parse_aaux_packs (dv_decoder_t *decoder, dv_audio_dif_func_t audio_dif, void *priv)
 {
   dv_audio_t    *audio = decoder->audio;
-  dv_aaux_as_t  *dv_aaux_as  = (dv_aaux_as_t *) (inbuf + 80*6+80*16*3 + 3),
+  const uint8_t *as_dif, *asc_dif, *as1_dif, *asc1_dif;
+  dv_aaux_as_t  *dv_aaux_as,
                 *dv_aaux_as1 = NULL;
-  dv_aaux_asc_t *dv_aaux_asc = (dv_aaux_asc_t *)(inbuf + 80*6+80*16*4 + 3),
+  dv_aaux_asc_t *dv_aaux_asc,
                 *dv_aaux_asc1 = NULL;
 
+  if (!(as_dif = audio_dif (priv, 0, 3)) || !(asc_dif = audio_dif (priv, 0, 4)))
+    goto bad_id;
+  dv_aaux_as  = (dv_aaux_as_t *) (as_dif + 3);
+  dv_aaux_asc = (dv_aaux_asc_t *) (asc_dif + 3);
+
   if((dv_aaux_as->pc0 != 0x50) || (dv_aaux_asc->pc0 != 0x51)) goto bad_id;
 
   audio->max_samples =  max_samples[dv_aaux_as->pc3.system][dv_aaux_as->pc4.smp];
@@ -436,30 +484,20 @@ dv_parse_audio_header(dv_decoder_t *decoder, const uint8_t *inbuf)
      */
     if (dv_aaux_as -> pc3. system)
     {
-      dv_aaux_as1 = (dv_aaux_as_t *) (inbuf +
-                      80 * (9 * 16 + 6) * 6 + /* go 6 dif sequences ahead  */
-                      80 *  6 +               /* skip 6 header blocks      */
-                      80 * 16 * 3 +           /* select block 3 (1a + 15v) */
-                      3);                     /* skip id bytes             */
-      dv_aaux_asc1 = (dv_aaux_asc_t *) (inbuf +
-                      80 * (9 * 16 + 6) * 6 + /* go 6 dif sequences ahead  */
-                      80 *  6 +               /* skip 6 header blocks      */
-                      80 * 16 * 4 +           /* select block 4 (1a + 15v) */
-                      3);                     /* skip id bytes             */
+      /* go 6 dif sequences ahead, select blocks 3 and 4 */
+      as1_dif  = audio_dif (priv, 6, 3);
+      asc1_dif = audio_dif (priv, 6, 4);
     }
     else
     {
-      dv_aaux_as1 = (dv_aaux_as_t *) (inbuf +
-                      80 * (9 * 16 + 6) * 6 + /* go 6 dif sequences ahead  */
-                      80 *  6 +               /* skip 6 header blocks      */
-                      80 * 16 * 0 +           /* select block 0 (1a + 15v) */
-                      3);                     /* skip id bytes             */
-      dv_aaux_asc1 = (dv_aaux_asc_t *) (inbuf +
-                      80 * (9 * 16 + 6) * 6 + /* go 6 dif sequences ahead  */
-                      80 *  6 +               /* skip 6 header blocks      */
-                      80 * 16 * 1 +           /* select block 1 (1a + 15v) */
-                      3);                     /* skip id bytes             */
+      /* go 6 dif sequences ahead, select blocks 0 and 1 */
+      as1_dif  = audio_dif (priv, 6, 0);
+      asc1_dif = audio_dif (priv, 6, 1);
     }
+    if (!as1_dif || !asc1_dif)
+      goto bad_id;
+    dv_aaux_as1  = (dv_aaux_as_t *) (as1_dif + 3);   /* skip id bytes */
+    dv_aaux_asc1 = (dv_aaux_asc_t *) (asc1_dif + 3);
     if (dv_aaux_as1 -> pc2. audio_mode != 0xf)
     {
       audio -> raw_num_channels = 4;
@@ -490,8 +528,28 @@ dv_parse_audio_header(dv_decoder_t *decoder, const uint8_t *inbuf)
 	  __FUNCTION__, audio->aaux_as.pc4.qu);
   return(FALSE);
 
+} /* dv_parse_aaux_packs */
+
+/* ---------------------------------------------------------------------------
+ */
+int
+dv_parse_audio_header(dv_decoder_t *decoder, const uint8_t *inbuf)
+{
+  return dv_parse_aaux_packs (decoder, dv_audio_dif_flat, (void *) inbuf);
 } /* dv_parse_audio_header */
 
+/* ---------------------------------------------------------------------------
+ */
+int
+dv_parse_audio_header_iov(dv_decoder_t *decoder, const dv_iovec_t *iov, int iovcnt)
+{
+  dv_audio_dif_iov_t priv;
+
+  _dv_iov_cursor_init (&priv.cursor, iov, iovcnt);
+  priv.next = 0;
+  return dv_parse_aaux_packs (decoder, dv_audio_dif_iov, &priv);
+} /* dv_parse_audio_header_iov */
+
 int
 dv_update_num_samples(dv_audio_t *dv_audio, const uint8_t *inbuf) {
 
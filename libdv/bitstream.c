@@ -88,6 +88,46 @@ void _dv_bitstream_new_buffer(bitstream_t *bs,uint8_t *buf,uint32_t len) {
   bs->bitsread = 0;
 }
 
+void _dv_iov_cursor_init(dv_iov_cursor_t *c, const dv_iovec_t *iov, int iovcnt) {
+  c->iov = iov;
+  c->iovcnt = iovcnt;
+  c->idx = 0;
+  c->start = 0;
+}
+
+/* Return a pointer to len contiguous bytes at frame offset offset.  If the
+ * range lies within one chunk this points straight into the caller's
+ * memory; only ranges straddling a chunk boundary are gathered into
+ * scratch.  Returns NULL if the frame is too short. */
+const uint8_t *_dv_iov_map(dv_iov_cursor_t *c, size_t offset, size_t len, uint8_t *scratch) {
+  size_t done, chunk_off, n;
+  int    i;
+
+  if (offset < c->start) {
+    c->idx = 0;
+    c->start = 0;
+  }
+  while (c->idx < c->iovcnt && offset >= c->start + c->iov[c->idx].iov_len) {
+    c->start += c->iov[c->idx].iov_len;
+    c->idx++;
+  }
+  if (c->idx >= c->iovcnt)
+    return NULL;
+
+  chunk_off = offset - c->start;
+  if (chunk_off + len <= c->iov[c->idx].iov_len)
+    return (const uint8_t *)c->iov[c->idx].iov_base + chunk_off;
+
+  for (done = 0, i = c->idx; done < len; i++, chunk_off = 0) {
+    if (i >= c->iovcnt)
+      return NULL;
+    n = MIN(c->iov[i].iov_len - chunk_off, len - done);
+    memcpy(scratch + done, (const uint8_t *)c->iov[i].iov_base + chunk_off, n);
+    done += n;
+  }
+  return scratch;
+}
+
 uint32_t _dv_bitstream_done(bitstream_t *bs) {
   //FIXME
   return 0;
@@ -58,6 +58,18 @@ void _dv_bitstream_next_buffer(bitstream_t * bs);
 void _dv_bitstream_new_buffer(bitstream_t *bs,uint8_t *buf,uint32_t len);
 void _dv_bitstream_byte_align(bitstream_t *bs);
 
+/* Walks a scatter-gather frame description.  Lookups are expected to be
+ * mostly ascending, so the cursor remembers the last chunk it hit. */
+typedef struct {
+  const dv_iovec_t *iov;
+  int               iovcnt;
+  int               idx;
+  size_t            start;
+} dv_iov_cursor_t;
+
+void _dv_iov_cursor_init(dv_iov_cursor_t *c, const dv_iovec_t *iov, int iovcnt);
+const uint8_t *_dv_iov_map(dv_iov_cursor_t *c, size_t offset, size_t len, uint8_t *scratch);
+
 static void bitstream_next_word(bitstream_t *bs) {
   uint32_t diff = bs->buflen - bs->bufoffset;
 
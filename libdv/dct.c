@@ -33,6 +33,8 @@
 
 #include "dct.h"
 #include "weighting.h"
+#include "tables.h"
+#include "util.h"
 
 #if ARCH_X86 || ARCH_X86_64
 #include "mmx.h"
@@ -60,19 +62,10 @@
 
 typedef short var;
 
-#if BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
-static double KC248[8][4][4][8];
-#endif /* BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
-
-#if ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
-static double C[8];
-static double KC88[8][8][8][8];
-#endif /* ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
-
 #if ARCH_X86_64
 void _dv_dct_88_block_mmx_x86_64(int16_t* block);
-void _dv_dct_block_mmx_x86_64_postscale_88(int16_t* block, int16_t* postscale_matrix);
-void _dv_dct_block_mmx_x86_64_postscale_248(int16_t* block, int16_t* postscale_matrix);
+void _dv_dct_block_mmx_x86_64_postscale_88(int16_t* block, const int16_t* postscale_matrix);
+void _dv_dct_block_mmx_x86_64_postscale_248(int16_t* block, const int16_t* postscale_matrix);
 void _dv_dct_248_block_mmx_x86_64(int16_t* block);
 void _dv_dct_248_block_mmx_x86_64_post_sum(int16_t* out_block);
 void _dv_idct_block_mmx_x86_64(dv_coeff_t *block);
@@ -81,53 +74,18 @@ void _dv_transpose_mmx_x86_64(short * dst);
 #if ARCH_X86
 void _dv_idct_block_mmx(dv_coeff_t *block);
 void _dv_dct_88_block_mmx(int16_t* block);
-void _dv_dct_block_mmx_postscale_88(int16_t* block, int16_t* postscale_matrix);
-void _dv_dct_block_mmx_postscale_248(int16_t* block, int16_t* postscale_matrix);
+void _dv_dct_block_mmx_postscale_88(int16_t* block, const int16_t* postscale_matrix);
+void _dv_dct_block_mmx_postscale_248(int16_t* block, const int16_t* postscale_matrix);
 void _dv_dct_248_block_mmx(int16_t* block);
 void _dv_dct_248_block_mmx_post_sum(int16_t* out_block);
 void _dv_transpose_mmx(short * dst);
 #endif /* ARCH_X86 */
 
-extern dv_coeff_t postSC88[64] ALIGN32;
-extern dv_coeff_t postSC248[64] ALIGN32;
+extern int _dv_reorder_block_mmx(dv_coeff_t * a, 
+			     const unsigned short* reorder_table);
 
-void _dv_dct_init(void) {
-#if BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
-  int u, z;
-#endif /* BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
-#if ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
-  int x, y, h, v, i;
-  for (x = 0; x < 8; x++) {
-    for (y = 0; y < 8; y++) {
-      for (v = 0; v < 8; v++) {
-        for (h = 0; h < 8; h++) {
-          KC88[x][y][h][v] =
-            cos((M_PI * v * ((2.0 * y) + 1.0)) / 16.0) *
-            cos((M_PI * h * ((2.0 * x) + 1.0)) / 16.0);
-        }
-      }
-    }
-  }
-#endif /* ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
-#if BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
-  for (x = 0; x < 8; x++) {
-    for (z = 0; z < 4; z++) {
-      for (u = 0; u < 4; u++) {
-        for (h = 0; h < 8; h++) {
-	  KC248[x][z][u][h] = 
-	    cos((M_PI * u * ((2.0 * z) + 1.0)) / 8.0) *
-	    cos((M_PI * h * ((2.0 * x) + 1.0)) / 16.0);
-        }                       /* for h */
-      }                         /* for u */
-    }                           /* for z */
-  }                             /* for x */
-#endif /* BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
-#if ((!ARCH_X86) && (!ARCH_X86_64))  || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
-  for (i = 0; i < 8; i++) {
-    C[i] = (i == 0 ? 0.5 / sqrt(2.0) : 0.5);
-  } /* for i */
-#endif /* ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
-}
+extern int _dv_reorder_block_mmx_x86_64(dv_coeff_t * a, 
+			     const unsigned short* reorder_table);
 
 #if 0
 /* Optimized out using integer fixpoint */
@@ -355,10 +313,10 @@ void _dv_dct_88(dv_coeff_t *block) {
       for (y = 0;y < 8; y++) {
 	for (x = 0;x < 8; x++) {
 	  temp[v * 8 + h] += block[x * 8 + y] 
-	    * KC88[x][y][h][v];
+	    * _dv_dct_KC88[x][y][h][v];
 	}
       }
-      temp[v * 8 + h] *= (C[h] * C[v]);
+      temp[v * 8 + h] *= (_dv_dct_C[h] * _dv_dct_C[v]);
     }
   }
 
@@ -400,13 +358,13 @@ void _dv_dct_248(dv_coeff_t *block)
       for (z=0;z<4;z++) {
 	for (x=0;x<8;x++) {
 	  temp[u*8+h] +=     (block[x*8+2*z] + block[x*8+(2*z+1)]) *
-		  KC248[x][z][u][h];
+		  _dv_dct_KC248[x][z][u][h];
 	  temp[(u+4)*8+h] += (block[x*8+2*z] - block[x*8+(2*z+1)]) *
-	    KC248[x][z][u][h];
+	    _dv_dct_KC248[x][z][u][h];
 	}
       }
-      temp[u*8+h] *= (C[h] * C[u]);
-      temp[(u+4)*8+h] *= (C[h] * C[u]);
+      temp[u*8+h] *= (_dv_dct_C[h] * _dv_dct_C[u]);
+      temp[(u+4)*8+h] *= (_dv_dct_C[h] * _dv_dct_C[u]);
     }
   }
 
@@ -432,6 +390,325 @@ void _dv_dct_248(dv_coeff_t *block)
 #endif /* ((!ARCH_X86) && (!ARCH_X86_64)) */
 }
 
+/* ---------------------------------------------------------------------------
+ * Forward DCT of several blocks per call for the encoder.  With the
+ * GCC/clang vector extensions the butterflies of dct_block_mmx*.S run
+ * on all eight columns of a block at once (on two blocks at once with
+ * AVX2), and the postscale and zigzag reordering are done in the same
+ * pass.  The arithmetic is exactly that of the MMX code, so every path
+ * produces the same coefficients.  Lane operations the extensions do
+ * not cover use the x86 intrinsics, which both compilers accept in
+ * functions with a target attribute.
+ */
+#if DV_VECTOR && !BRUTE_FORCE_DCT_88 && !BRUTE_FORCE_DCT_248
+#define DCT_VECTOR 1
+#else
+#define DCT_VECTOR 0
+#endif
+
+static void reorder_block(dv_block_t *bl)
+{
+#if (!ARCH_X86) && (!ARCH_X86_64)
+	dv_coeff_t zigzag[64];
+	int i;
+#endif
+	const unsigned short *reorder;
+
+	if (bl->dct_mode == DV_DCT_88)
+		reorder = _dv_reorder_88;
+	else
+		reorder = _dv_reorder_248;
+
+#if ARCH_X86
+	_dv_reorder_block_mmx(bl->coeffs, reorder);
+	emms();
+#elif ARCH_X86_64
+	_dv_reorder_block_mmx_x86_64(bl->coeffs, reorder);
+	emms();
+#else	
+	/* the tables hold byte offsets for the asm versions */
+	for (i = 0; i < 64; i++) {
+		zigzag[reorder[i] / 2] = bl->coeffs[i];
+	}
+	memcpy(bl->coeffs, zigzag, 64 * sizeof(dv_coeff_t));
+#endif
+}
+
+#if DCT_VECTOR
+
+#if ARCH_X86_64 || ARCH_X86
+#include <immintrin.h>
+#endif
+
+typedef int16_t dct_v8 __attribute__ ((vector_size (16)));
+typedef int32_t dct_v8w __attribute__ ((vector_size (32)));
+#if ARCH_X86_64 || ARCH_X86
+typedef int16_t dct_v16 __attribute__ ((vector_size (32)));
+#endif
+
+#define DCT_SPLAT(V, c) ((V) { 0 } + (c))
+
+/* One pass of _dv_dct_88_block_mmx over all columns; r[i] is row i. */
+#define DCT_VEC_88(r, V) do {						\
+	V v00 = r[0] + r[7], v07 = r[0] - r[7];				\
+	V v01 = r[1] + r[6], v06 = r[1] - r[6];				\
+	V v02 = r[2] + r[5], v05 = r[2] - r[5];				\
+	V v03 = r[3] + r[4], v04 = r[3] - r[4];				\
+	V v10 = v00 + v03, v13 = v00 - v03;				\
+	V v11 = v01 + v02, v12 = v01 - v02;				\
+	V v14 = v04 + v05, v16 = v06 + v07;				\
+	V v32 = DCT_MULHI(v12 + v13, DCT_SPLAT(V, 23171)) << 1;	\
+	V v35 = DCT_MULHI(v05 + v06, DCT_SPLAT(V, 23171)) << 1;	\
+	V va0 = DCT_MULHI(v16 - v14, DCT_SPLAT(V, 25079));		\
+	V v34 = (DCT_MULHI(v14, DCT_SPLAT(V, 17734)) << 1) - va0;	\
+	V v36 = (DCT_MULHI(v16, DCT_SPLAT(V, 21407)) << 2) - va0;	\
+	V v45 = v07 + v35, v47 = v07 - v35;				\
+	r[0] = v10 + v11;  r[4] = v10 - v11;				\
+	r[2] = v13 + v32;  r[6] = v13 - v32;				\
+	r[1] = v45 + v36;  r[7] = v45 - v36;				\
+	r[5] = v47 + v34;  r[3] = v47 - v34;				\
+} while (0)
+
+/* _dv_dct_248_block_mmx and _dv_dct_248_block_mmx_post_sum */
+#define DCT_VEC_44(a0, a1, a2, a3, V) do {				\
+	V v10 = a0 + a3, v13 = a0 - a3;					\
+	V v11 = a1 + a2, v12 = a1 - a2;					\
+	V v32 = DCT_MULHI(v12 + v13, DCT_SPLAT(V, 23171)) << 1;	\
+	a0 = v10 + v11;  a2 = v10 - v11;				\
+	a1 = v13 + v32;  a3 = v13 - v32;				\
+} while (0)
+
+#define DCT_VEC_248(r, V) do {						\
+	V t[8];								\
+	DCT_VEC_44(r[0], r[2], r[4], r[6], V);				\
+	DCT_VEC_44(r[1], r[3], r[5], r[7], V);				\
+	t[0] = r[0] + r[1];  t[4] = r[0] - r[1];			\
+	t[1] = r[2] + r[3];  t[5] = r[2] - r[3];			\
+	t[2] = r[4] + r[5];  t[6] = r[4] - r[5];			\
+	t[3] = r[6] + r[7];  t[7] = r[6] - r[7];			\
+	memcpy(r, t, sizeof(t));					\
+} while (0)
+
+/* 8x8 transpose within each 128 bit lane */
+#define DCT_VEC_TRANSPOSE(r, V) do {					\
+	V t[8], u[8];							\
+	t[0] = DV_SHUFFLE(r[0], r[1], V, DCT_LO16);			\
+	t[1] = DV_SHUFFLE(r[0], r[1], V, DCT_HI16);			\
+	t[2] = DV_SHUFFLE(r[2], r[3], V, DCT_LO16);			\
+	t[3] = DV_SHUFFLE(r[2], r[3], V, DCT_HI16);			\
+	t[4] = DV_SHUFFLE(r[4], r[5], V, DCT_LO16);			\
+	t[5] = DV_SHUFFLE(r[4], r[5], V, DCT_HI16);			\
+	t[6] = DV_SHUFFLE(r[6], r[7], V, DCT_LO16);			\
+	t[7] = DV_SHUFFLE(r[6], r[7], V, DCT_HI16);			\
+	u[0] = DV_SHUFFLE(t[0], t[2], V, DCT_LO32);			\
+	u[1] = DV_SHUFFLE(t[0], t[2], V, DCT_HI32);			\
+	u[2] = DV_SHUFFLE(t[1], t[3], V, DCT_LO32);			\
+	u[3] = DV_SHUFFLE(t[1], t[3], V, DCT_HI32);			\
+	u[4] = DV_SHUFFLE(t[4], t[6], V, DCT_LO32);			\
+	u[5] = DV_SHUFFLE(t[4], t[6], V, DCT_HI32);			\
+	u[6] = DV_SHUFFLE(t[5], t[7], V, DCT_LO32);			\
+	u[7] = DV_SHUFFLE(t[5], t[7], V, DCT_HI32);			\
+	r[0] = DV_SHUFFLE(u[0], u[4], V, DCT_LO64);			\
+	r[1] = DV_SHUFFLE(u[0], u[4], V, DCT_HI64);			\
+	r[2] = DV_SHUFFLE(u[1], u[5], V, DCT_LO64);			\
+	r[3] = DV_SHUFFLE(u[1], u[5], V, DCT_HI64);			\
+	r[4] = DV_SHUFFLE(u[2], u[6], V, DCT_LO64);			\
+	r[5] = DV_SHUFFLE(u[2], u[6], V, DCT_HI64);			\
+	r[6] = DV_SHUFFLE(u[3], u[7], V, DCT_LO64);			\
+	r[7] = DV_SHUFFLE(u[3], u[7], V, DCT_HI64);			\
+} while (0)
+
+/* _dv_dct_block_mmx_postscale_*: scale the magnitude, keep the sign */
+#define DCT_VEC_POSTSCALE(x, ps, V) do {				\
+	V s = x >> 15;							\
+	x = ((DCT_MULHI((x ^ s) - s, ps) >> DCT_YUV_PRECISION) ^ s) - s;	\
+} while (0)
+
+/* zigzag reorder the 8 rows of out, which are stride apart */
+static inline void dct_vec_store(dv_block_t *bl, const int16_t *out, 
+				 int stride)
+{
+	const unsigned short *reorder;
+	int i, j;
+
+	if (bl->dct_mode == DV_DCT_88)
+		reorder = _dv_reorder_88;
+	else
+		reorder = _dv_reorder_248;
+	for (i = 0; i < 8; i++, out += stride, reorder += 8) {
+		for (j = 0; j < 8; j++) {
+			bl->coeffs[reorder[j] / 2] = out[j];
+		}
+	}
+}
+
+#define DCT_LO16 0, 8, 1, 9, 2, 10, 3, 11
+#define DCT_HI16 4, 12, 5, 13, 6, 14, 7, 15
+#define DCT_LO32 0, 1, 8, 9, 2, 3, 10, 11
+#define DCT_HI32 4, 5, 12, 13, 6, 7, 14, 15
+#define DCT_LO64 0, 1, 2, 3, 8, 9, 10, 11
+#define DCT_HI64 4, 5, 6, 7, 12, 13, 14, 15
+#if ARCH_X86_64 || ARCH_X86
+#define DCT_MULHI(a, b)							\
+	((dct_v8) _mm_mulhi_epi16((__m128i) (a), (__m128i) (b)))
+#else
+#define DCT_MULHI(a, b)							\
+	__builtin_convertvector((__builtin_convertvector(a, dct_v8w)	\
+				 * __builtin_convertvector(b, dct_v8w))	\
+				>> 16, dct_v8)
+#endif
+
+#if ARCH_X86
+__attribute__ ((target ("sse2")))
+#endif
+static void dct_blocks_v8(dv_block_t *bl, int n)
+{
+	dct_v8 r[8], ps;
+	const dv_coeff_t *postSC;
+	int i;
+
+	for (; n > 0; n--, bl++) {
+		memcpy(r, bl->coeffs, sizeof(r));
+		DCT_VEC_88(r, dct_v8);
+		DCT_VEC_TRANSPOSE(r, dct_v8);
+		if (bl->dct_mode == DV_DCT_88) {
+			DCT_VEC_88(r, dct_v8);
+			postSC = postSC88;
+		} else {
+			DCT_VEC_248(r, dct_v8);
+			postSC = postSC248;
+		}
+		for (i = 0; i < 8; i++) {
+			memcpy(&ps, postSC + 8 * i, sizeof(ps));
+			DCT_VEC_POSTSCALE(r[i], ps, dct_v8);
+		}
+		dct_vec_store(bl, (const int16_t *) r, 8);
+	}
+}
+
+#undef DCT_LO16
+#undef DCT_HI16
+#undef DCT_LO32
+#undef DCT_HI32
+#undef DCT_LO64
+#undef DCT_HI64
+#undef DCT_MULHI
+
+#if ARCH_X86_64 || ARCH_X86
+
+#define DCT_LO16 0, 16, 1, 17, 2, 18, 3, 19,				\
+		 8, 24, 9, 25, 10, 26, 11, 27
+#define DCT_HI16 4, 20, 5, 21, 6, 22, 7, 23,				\
+		 12, 28, 13, 29, 14, 30, 15, 31
+#define DCT_LO32 0, 1, 16, 17, 2, 3, 18, 19,				\
+		 8, 9, 24, 25, 10, 11, 26, 27
+#define DCT_HI32 4, 5, 20, 21, 6, 7, 22, 23,				\
+		 12, 13, 28, 29, 14, 15, 30, 31
+#define DCT_LO64 0, 1, 2, 3, 16, 17, 18, 19,				\
+		 8, 9, 10, 11, 24, 25, 26, 27
+#define DCT_HI64 4, 5, 6, 7, 20, 21, 22, 23,				\
+		 12, 13, 14, 15, 28, 29, 30, 31
+#define DCT_MULHI(a, b)							\
+	((dct_v16) _mm256_mulhi_epi16((__m256i) (a), (__m256i) (b)))
+
+/* Two blocks side by side, one in each 128 bit lane. */
+__attribute__ ((target ("avx2")))
+static inline dct_v16 dct_v16_load(const int16_t *lo, const int16_t *hi)
+{
+	__m128i a = _mm_loadu_si128((const __m128i *) lo);
+	__m128i b = _mm_loadu_si128((const __m128i *) hi);
+
+	return (dct_v16) _mm256_inserti128_si256(_mm256_castsi128_si256(a),
+						 b, 1);
+}
+
+__attribute__ ((target ("avx2")))
+static void dct_blocks_v16(dv_block_t *bl, int n)
+{
+	static const dct_v16 lane = { 0, 0, 0, 0, 0, 0, 0, 0,
+				      1, 1, 1, 1, 1, 1, 1, 1 };
+	dct_v16 r[8], w[8], ps, m;
+	const dv_coeff_t *ps0, *ps1;
+	int i;
+
+	for (; n > 1; n -= 2, bl += 2) {
+		for (i = 0; i < 8; i++)
+			r[i] = dct_v16_load(bl[0].coeffs + 8 * i, 
+					    bl[1].coeffs + 8 * i);
+		DCT_VEC_88(r, dct_v16);
+		DCT_VEC_TRANSPOSE(r, dct_v16);
+		if (bl[0].dct_mode != bl[1].dct_mode) {
+			/* mixed pair: do both, m selects the 248 lane */
+			m = lane == (int16_t) (bl[0].dct_mode == DV_DCT_248 ? 0 : 1);
+			memcpy(w, r, sizeof(w));
+			DCT_VEC_88(r, dct_v16);
+			DCT_VEC_248(w, dct_v16);
+			for (i = 0; i < 8; i++)
+				r[i] = (w[i] & m) | (r[i] & ~m);
+		} else if (bl[0].dct_mode == DV_DCT_88) {
+			DCT_VEC_88(r, dct_v16);
+		} else {
+			DCT_VEC_248(r, dct_v16);
+		}
+		ps0 = (bl[0].dct_mode == DV_DCT_88) ? postSC88 : postSC248;
+		ps1 = (bl[1].dct_mode == DV_DCT_88) ? postSC88 : postSC248;
+		for (i = 0; i < 8; i++) {
+			ps = dct_v16_load(ps0 + 8 * i, ps1 + 8 * i);
+			DCT_VEC_POSTSCALE(r[i], ps, dct_v16);
+		}
+		dct_vec_store(&bl[0], (const int16_t *) r, 16);
+		dct_vec_store(&bl[1], (const int16_t *) r + 8, 16);
+	}
+	if (n)
+		dct_blocks_v8(bl, n);
+}
+
+#undef DCT_LO16
+#undef DCT_HI16
+#undef DCT_LO32
+#undef DCT_HI32
+#undef DCT_LO64
+#undef DCT_HI64
+#undef DCT_MULHI
+
+#endif /* ARCH_X86_64 || ARCH_X86 */
+
+#endif /* DCT_VECTOR */
+
+/* Forward DCT of n blocks, each in its own dct_mode.  The input is
+ * transposed, the output postscaled and in zigzag order. */
+
+void _dv_dct_blocks(dv_block_t *bl, int n)
+{
+#if DCT_VECTOR
+#if ARCH_X86_64 || ARCH_X86
+  if (_dv_simd.avx2) {
+    dct_blocks_v16(bl, n);
+    return;
+  }
+  if (_dv_simd.sse2) {
+    dct_blocks_v8(bl, n);
+    return;
+  }
+#else
+  dct_blocks_v8(bl, n);
+  return;
+#endif
+#endif /* DCT_VECTOR */
+
+  for (; n > 0; n--, bl++) {
+    if (bl->dct_mode == DV_DCT_88) {
+      _dv_dct_88(bl->coeffs);
+#if (!ARCH_X86) && (!ARCH_X86_64)
+      reorder_block(bl);
+#endif
+    } else {
+      _dv_dct_248(bl->coeffs);
+      reorder_block(bl);
+    }
+  }
+}
+
 void _dv_idct_88(dv_coeff_t *block) 
 {
 #if ARCH_X86_64
@@ -454,7 +731,7 @@ void _dv_idct_88(dv_coeff_t *block)
     for (h=0;h<8;h++) {
       for (y=0;y<8;y++){ 
 	for (x=0;x<8;x++) {
-	  temp[y*8+x] += C[v] * C[h] * block[v*8+h] * KC88[x][y][h][v];
+	  temp[y*8+x] += _dv_dct_C[v] * _dv_dct_C[h] * block[v*8+h] * _dv_dct_KC88[x][y][h][v];
 	}
       }
     }
@@ -500,8 +777,8 @@ void _dv_idct_248(double *block)
 	for (h = 0; h < 8; h++) {
 	  b = (double)(*in)[u][h];  
 	  c = (double)(*in)[u+4][h];
-	  (*out)[2*z][x] += C[u] * C[h] * (b + c) * KC248[x][z][u][h];
-	  (*out)[2*z+1][x] += C[u] * C[h] * (b - c) * KC248[x][z][u][h];
+	  (*out)[2*z][x] += _dv_dct_C[u] * _dv_dct_C[h] * (b + c) * _dv_dct_KC248[x][z][u][h];
+	  (*out)[2*z+1][x] += _dv_dct_C[u] * _dv_dct_C[h] * (b - c) * _dv_dct_KC248[x][z][u][h];
 	}                       /* for h */
       }                         /* for u */
     }                           /* for z */
@@ -514,8 +791,8 @@ void _dv_idct_248(double *block)
         for (x=0;x<8;x++) {
           b = block[u*8+h];
           c = block[(u+4)*8+h];
-          temp[(2*u)*8+h] += C[h] * C[u] * (b + c) * KC248[x][z][h][u];
-          temp[(2*u+1)*8+h] += C[h] * C[u] * (b - c) * KC248[x][z][h][u];
+          temp[(2*u)*8+h] += _dv_dct_C[h] * _dv_dct_C[u] * (b + c) * _dv_dct_KC248[x][z][h][u];
+          temp[(2*u+1)*8+h] += _dv_dct_C[h] * _dv_dct_C[u] * (b - c) * _dv_dct_KC248[x][z][h][u];
         }
       }
     }
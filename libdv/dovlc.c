@@ -42,7 +42,6 @@ int main(int argc, char **argv)
 
   p = buffer;
   bits_left = 8;
-  dv_construct_vlc_table();
   bs = _dv_bitstream_init();
   coeff_count=count=0;
   while((c=fgetc(stdin)) != EOF) {
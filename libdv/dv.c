@@ -60,10 +60,10 @@
 #endif
 
 #if YUV_420_USE_YV12
-#define DV_MB420_YUV(a,b,c)     dv_mb420_YV12    (a,b,c)
+#define DV_MB420_YUV(a,b,c,d)   dv_mb420_YV12    (a,b,c,d)
 #define DV_MB420_YUV_MMX(a,b,c,d,e) dv_mb420_YV12_mmx(a,b,c,d,e)
 #else
-#define DV_MB420_YUV(a,b,c)     dv_mb420_YUY2    (a,b,c)
+#define DV_MB420_YUV(a,b,c,d)   dv_mb420_YUY2    (a,b,c,d)
 #define DV_MB420_YUV_MMX(a,b,c,d,e) dv_mb420_YUY2_mmx(a,b,c,d,e)
 #endif 
 
@@ -71,6 +71,7 @@
 #define MAX(a,b) ((a)<(b)?(b):(a))
 
 int dv_use_mmx;
+dv_simd_t _dv_simd;
 
 #if HAVE_LIBPOPT
 static void
@@ -86,29 +87,26 @@ dv_decoder_popt_callback(poptContext con, enum poptCallbackReason reason,
 } /* dv_decoder_popt_callback  */
 #endif /* HAVE_LIBPOPT */
 
-dv_decoder_t * 
-dv_decoder_new(int add_ntsc_setup, int clamp_luma, int clamp_chroma) {
-  dv_decoder_t *result;
-  
-  result = (dv_decoder_t *)calloc(1,sizeof(dv_decoder_t));
-  if(!result) goto no_mem;
-  
-  result->add_ntsc_setup = FALSE;
-  result->clamp_luma = clamp_luma;
-  result->clamp_chroma = clamp_chroma;
-  dv_init(clamp_luma, clamp_chroma);
-	
-  result->video = dv_video_new();
-  if(!result->video) goto no_video;
-  result->video->dv_decoder = result;
+/* Layout of a decoder made by dv_decoder_new_slim(): everything in one
+ * cache aligned block, so one allocation per channel. */
+typedef struct {
+  dv_decoder_t decoder;
+  dv_audio_t   audio;
+  dv_video_t   video;
+} dv_decoder_block_t;
 
-  result->audio = dv_audio_new();
-  if(!result->audio) goto no_audio;
-  result->audio->dv_decoder = result;
+#define DV_CACHE_LINE 64
 
-  dv_set_error_log (result, stderr);
-  dv_set_audio_correction (result, DV_AUDIO_CORRECT_AVERAGE);
 #if HAVE_LIBPOPT
+/* ---------------------------------------------------------------------------
+ * command line option tables, only needed by the dv_decoder_new() path
+ */
+static int
+dv_decoder_init_options(dv_decoder_t *result) {
+  result->option_table = (struct poptOption *)
+    calloc(DV_DECODER_NUM_OPTS+1, sizeof(struct poptOption));
+  if(!result->option_table) return(-1);
+
   result->option_table[DV_DECODER_OPT_SYSTEM] = (struct poptOption) {
     longName: "video-system", 
     shortName: 'V', 
@@ -139,12 +137,48 @@ dv_decoder_new(int add_ntsc_setup, int clamp_luma, int clamp_chroma) {
     arg:     dv_decoder_popt_callback,
     descrip: (char *)result, /* data passed to callback */
   }; /* callback */
+  return(0);
+} /* dv_decoder_init_options */
+#endif /* HAVE_LIBPOPT */
+
+dv_decoder_t * 
+dv_decoder_new(int add_ntsc_setup, int clamp_luma, int clamp_chroma) {
+  dv_decoder_t *result;
+  
+  result = (dv_decoder_t *)calloc(1,sizeof(dv_decoder_t));
+  if(!result) goto no_mem;
+  
+  result->alloc = DV_DECODER_ALLOC_SEPARATE;
+  result->add_ntsc_setup = FALSE;
+  result->clamp_luma = clamp_luma;
+  result->clamp_chroma = clamp_chroma;
+  dv_init(clamp_luma, clamp_chroma);
+	
+  result->video = dv_video_new();
+  if(!result->video) goto no_video;
+  result->video->dv_decoder = result;
+
+  result->audio = dv_audio_new();
+  if(!result->audio) goto no_audio;
+  result->audio->dv_decoder = result;
 
+  dv_set_error_log (result, stderr);
+  dv_set_audio_correction (result, DV_AUDIO_CORRECT_AVERAGE);
+#if HAVE_LIBPOPT
+  if(dv_decoder_init_options(result)) goto no_options;
 #endif /* HAVE_LIBPOPT */
 
   return(result);
 
+#if HAVE_LIBPOPT
+ no_options:
+  free(result->audio->option_table);
+  free(result->audio);
+#endif /* HAVE_LIBPOPT */
  no_audio:
+#if HAVE_LIBPOPT
+  free(result->video->option_table);
+#endif /* HAVE_LIBPOPT */
   free(result->video);
  no_video:
   free(result);
@@ -153,11 +187,100 @@ dv_decoder_new(int add_ntsc_setup, int clamp_luma, int clamp_chroma) {
   return(result);
 } /* dv_decoder_new */
 
+/* ---------------------------------------------------------------------------
+ * Like dv_decoder_new(), but for applications that do not use popt and keep
+ * many decoders around: the decoder, audio and video state share a single
+ * cache aligned allocation and the popt option tables are not allocated.
+ * The video quality defaults to DV_QUALITY_BEST.  Free with
+ * dv_decoder_free().
+ */
+dv_decoder_t *
+dv_decoder_new_slim(int add_ntsc_setup, int clamp_luma, int clamp_chroma) {
+  dv_decoder_block_t *block;
+  dv_decoder_t       *result;
+
+  if(posix_memalign((void **)&block, DV_CACHE_LINE, sizeof(dv_decoder_block_t)))
+    return(NULL);
+  memset(block, 0, sizeof(dv_decoder_block_t));
+
+  result = &block->decoder;
+  result->alloc = DV_DECODER_ALLOC_BLOCK;
+  result->quality = DV_QUALITY_BEST;
+  result->add_ntsc_setup = FALSE;
+  result->clamp_luma = clamp_luma;
+  result->clamp_chroma = clamp_chroma;
+  dv_init(clamp_luma, clamp_chroma);
+
+  result->video = &block->video;
+  result->video->dv_decoder = result;
+  result->video->arg_block_quality = 3;
+  result->video->quality = DV_QUALITY_BEST;
+
+  result->audio = &block->audio;
+  result->audio->dv_decoder = result;
+
+  dv_set_error_log (result, stderr);
+  dv_set_audio_correction (result, DV_AUDIO_CORRECT_AVERAGE);
+
+  return(result);
+} /* dv_decoder_new_slim */
+
+/* ---------------------------------------------------------------------------
+ * Forget everything learned from the stream so the decoder can be handed a
+ * new one, keeping the configuration (quality, clamping, forced system,
+ * audio options, error logs).  Cheaper than a free/new pair.
+ */
+void
+dv_decoder_reset(dv_decoder_t *dv) {
+  dv_audio_t *audio = dv->audio;
+
+  dv->system = e_dv_system_none;
+  dv->std = e_dv_std_none;
+  dv->sampling = e_dv_sample_none;
+  dv->num_dif_seqs = 0;
+  dv->height = dv->width = 0;
+  dv->frame_size = 0;
+  dv->prev_frame_decoded = 0;
+  memset(&dv->header, 0, sizeof(dv->header));
+  dv->vaux_next = 0;
+  memset(dv->vaux_pack, 0, sizeof(dv->vaux_pack));
+  memset(dv->vaux_data, 0, sizeof(dv->vaux_data));
+  dv->ssyb_next = 0;
+  memset(dv->ssyb_pack, 0, sizeof(dv->ssyb_pack));
+  memset(dv->ssyb_data, 0, sizeof(dv->ssyb_data));
+
+  memset(&audio->aaux_as, 0, sizeof(audio->aaux_as));
+  memset(&audio->aaux_as1, 0, sizeof(audio->aaux_as1));
+  memset(&audio->aaux_asc, 0, sizeof(audio->aaux_asc));
+  memset(&audio->aaux_asc1, 0, sizeof(audio->aaux_asc1));
+  audio->samples_this_frame = 0;
+  audio->raw_samples_this_frame[0] = audio->raw_samples_this_frame[1] = 0;
+  audio->quantization = audio->max_samples = audio->frequency = 0;
+  audio->num_channels = audio->raw_num_channels = 0;
+  audio->emphasis = 0;
+  audio->new_recording_on_next_frame = 0;
+  memset(audio->new_recording_current_time_stamp, 0,
+	 sizeof(audio->new_recording_current_time_stamp));
+  audio->block_failure = audio->sample_failure = 0;
+  audio->real_samples_this_frame = audio->fail_samples_this_frame = 0;
+  memset(audio->lastin, 0, sizeof(audio->lastin));
+  memset(audio->lastout, 0, sizeof(audio->lastout));
+} /* dv_decoder_reset */
+
 
 void
 dv_decoder_free( dv_decoder_t *decoder)
 {
 	if (decoder != NULL) {
+		if (decoder->alloc == DV_DECODER_ALLOC_BLOCK) {
+			free(decoder);
+			return;
+		}
+#if HAVE_LIBPOPT
+		free(decoder->option_table);
+		if (decoder->audio != NULL) free(decoder->audio->option_table);
+		if (decoder->video != NULL) free(decoder->video->option_table);
+#endif /* HAVE_LIBPOPT */
 		if (decoder->audio != NULL) free(decoder->audio);
 		if (decoder->video != NULL) free(decoder->video);
 		free(decoder);
@@ -167,41 +290,40 @@ dv_decoder_free( dv_decoder_t *decoder)
 
 void 
 dv_init(int clamp_luma, int clamp_chroma) {
+  /* The lookup tables are generated at build time (gentables), so
+   * all that is left here is picking implementations.  The clamp
+   * arguments are only kept for the API, each decoder selects its
+   * colour tables from its own clamp_luma/clamp_chroma. */
+  static pthread_mutex_t init_mutex = PTHREAD_MUTEX_INITIALIZER;
   static int done=FALSE;
+
+  pthread_mutex_lock(&init_mutex);
   if(done) goto init_done;
 #if ARCH_X86
   dv_use_mmx = mmx_ok(); 
 #endif
+#if DV_VECTOR && (ARCH_X86 || ARCH_X86_64)
+  __builtin_cpu_init();
+  _dv_simd.sse2 = __builtin_cpu_supports("sse2");
+  _dv_simd.avx2 = __builtin_cpu_supports("avx2");
+#endif
 
   /* decoder */
-  _dv_weight_init();
-  _dv_dct_init();
-  dv_dct_248_init();
-  dv_construct_vlc_table();
-  dv_parse_init();
   dv_place_init();
   dv_quant_init();
-  dv_rgb_init(clamp_luma, clamp_chroma);
-  dv_YUY2_init(clamp_luma, clamp_chroma);
-  dv_YV12_init(clamp_luma, clamp_chroma);
-
-  /* encoder */
-  _dv_init_vlc_test_lookup();
-  _dv_init_vlc_encode_lookup();
-  _dv_init_qno_start();
-  _dv_prepare_reorder_tables();
-  
+
   done=TRUE;
  init_done:
+  pthread_mutex_unlock(&init_mutex);
   return;
 } /* dv_init */
 
 
+/* Obsolete: clamping used to be global state rebuilt here.  Set
+ * clamp_luma/clamp_chroma on the decoder instead; they take effect
+ * on the next decoded frame without touching other decoders. */
 void
 dv_reconfigure(int clamp_luma, int clamp_chroma) {
-  dv_rgb_init( clamp_luma, clamp_chroma);
-  dv_YUY2_init( clamp_luma, clamp_chroma);
-  dv_YV12_init( clamp_luma, clamp_chroma);
 } /* dv_reconfigure */
 
 
@@ -269,19 +391,21 @@ dv_decode_video_segment(dv_decoder_t *dv, dv_videosegment_t *seg, unsigned int q
 
 static inline void
 dv_render_macroblock_rgb(dv_decoder_t *dv, dv_macroblock_t *mb, uint8_t **pixels, int *pitches ) {
+  const dv_color_luts_t *luts = dv_color_luts(dv->clamp_luma, dv->clamp_chroma);
   if(dv->sampling == e_dv_sample_411) {
     if(mb->x >= 704) {
-      dv_mb411_right_rgb(mb, pixels, pitches, dv->add_ntsc_setup); /* Right edge are 16x16 */
+      dv_mb411_right_rgb(mb, pixels, pitches, dv->add_ntsc_setup, luts); /* Right edge are 16x16 */
     } else {
-      dv_mb411_rgb(mb, pixels, pitches, dv->add_ntsc_setup);
+      dv_mb411_rgb(mb, pixels, pitches, dv->add_ntsc_setup, luts);
     } /* else */
   } else {
-    dv_mb420_rgb(mb, pixels, pitches);
+    dv_mb420_rgb(mb, pixels, pitches, luts);
   } /* else */
 } /* dv_render_macroblock_rgb */
 
 void
 dv_render_video_segment_rgb(dv_decoder_t *dv, dv_videosegment_t *seg, uint8_t **pixels, int *pitches ) {
+  const dv_color_luts_t *luts = dv_color_luts(dv->clamp_luma, dv->clamp_chroma);
   dv_macroblock_t *mb;
   int m;
   for (m=0,mb = seg->mb;
@@ -289,31 +413,33 @@ dv_render_video_segment_rgb(dv_decoder_t *dv, dv_videosegment_t *seg, uint8_t **
        m++,mb++) {
     if(dv->sampling == e_dv_sample_411) {
       if(mb->x >= 704) {
-	dv_mb411_right_rgb(mb, pixels, pitches, dv->add_ntsc_setup); /* Right edge are 16x16 */
+	dv_mb411_right_rgb(mb, pixels, pitches, dv->add_ntsc_setup, luts); /* Right edge are 16x16 */
       } else {
-	dv_mb411_rgb(mb, pixels, pitches, dv->add_ntsc_setup);
+	dv_mb411_rgb(mb, pixels, pitches, dv->add_ntsc_setup, luts);
       } /* else */
     } else {
-      dv_mb420_rgb(mb, pixels, pitches);
+      dv_mb420_rgb(mb, pixels, pitches, luts);
     } /* else */
   } /* for    */
 } /* dv_render_video_segment_rgb */
 
 static inline void
 dv_render_macroblock_bgr0(dv_decoder_t *dv, dv_macroblock_t *mb, uint8_t **pixels, int *pitches ) {
+  const dv_color_luts_t *luts = dv_color_luts(dv->clamp_luma, dv->clamp_chroma);
   if(dv->sampling == e_dv_sample_411) {
     if(mb->x >= 704) {
-      dv_mb411_right_bgr0(mb, pixels, pitches, dv->add_ntsc_setup); /* Right edge are 16x16 */
+      dv_mb411_right_bgr0(mb, pixels, pitches, dv->add_ntsc_setup, luts); /* Right edge are 16x16 */
     } else {
-      dv_mb411_bgr0(mb, pixels, pitches, dv->add_ntsc_setup);
+      dv_mb411_bgr0(mb, pixels, pitches, dv->add_ntsc_setup, luts);
     } /* else */
   } else {
-    dv_mb420_bgr0(mb, pixels, pitches);
+    dv_mb420_bgr0(mb, pixels, pitches, luts);
   } /* else */
 } /* dv_render_macroblock_bgr0 */
 
 void
 dv_render_video_segment_bgr0(dv_decoder_t *dv, dv_videosegment_t *seg, uint8_t **pixels, int *pitches ) {
+  const dv_color_luts_t *luts = dv_color_luts(dv->clamp_luma, dv->clamp_chroma);
   dv_macroblock_t *mb;
   int m;
   for (m=0,mb = seg->mb;
@@ -321,12 +447,12 @@ dv_render_video_segment_bgr0(dv_decoder_t *dv, dv_videosegment_t *seg, uint8_t *
        m++,mb++) {
     if(dv->sampling == e_dv_sample_411) {
       if(mb->x >= 704) {
-	dv_mb411_right_bgr0(mb, pixels, pitches, dv->add_ntsc_setup); /* Right edge are 16x16 */
+	dv_mb411_right_bgr0(mb, pixels, pitches, dv->add_ntsc_setup, luts); /* Right edge are 16x16 */
       } else {
-	dv_mb411_bgr0(mb, pixels, pitches, dv->add_ntsc_setup);
+	dv_mb411_bgr0(mb, pixels, pitches, dv->add_ntsc_setup, luts);
       } /* else */
     } else {
-      dv_mb420_bgr0(mb, pixels, pitches);
+      dv_mb420_bgr0(mb, pixels, pitches, luts);
     } /* else */
   } /* for    */
 } /* dv_render_video_segment_bgr0 */
@@ -335,6 +461,7 @@ dv_render_video_segment_bgr0(dv_decoder_t *dv, dv_videosegment_t *seg, uint8_t *
 
 static inline void
 dv_render_macroblock_yuv(dv_decoder_t *dv, dv_macroblock_t *mb, uint8_t **pixels, int *pitches) {
+  const dv_color_luts_t *luts = dv_color_luts(dv->clamp_luma, dv->clamp_chroma);
   if(dv_use_mmx) {
     if(dv->sampling == e_dv_sample_411) {
       if(mb->x >= 704) {
@@ -350,18 +477,19 @@ dv_render_macroblock_yuv(dv_decoder_t *dv, dv_macroblock_t *mb, uint8_t **pixels
   } else {
     if(dv->sampling == e_dv_sample_411) {
       if(mb->x >= 704) {
-	dv_mb411_right_YUY2(mb, pixels, pitches, dv->add_ntsc_setup); /* Right edge are 420! */
+	dv_mb411_right_YUY2(mb, pixels, pitches, dv->add_ntsc_setup, luts); /* Right edge are 420! */
       } else {
-	dv_mb411_YUY2(mb, pixels, pitches, dv->add_ntsc_setup);
+	dv_mb411_YUY2(mb, pixels, pitches, dv->add_ntsc_setup, luts);
       } /* else */
     } else {
-      DV_MB420_YUV(mb, pixels, pitches);
+      DV_MB420_YUV(mb, pixels, pitches, luts);
     } /* else */
   } /* else */
 } /* dv_render_macroblock_yuv */
 
 void
 dv_render_video_segment_yuv(dv_decoder_t *dv, dv_videosegment_t *seg, uint8_t **pixels, int *pitches) {
+  const dv_color_luts_t *luts = dv_color_luts(dv->clamp_luma, dv->clamp_chroma);
   dv_macroblock_t *mb;
   int m;
   for (m=0,mb = seg->mb;
@@ -382,12 +510,12 @@ dv_render_video_segment_yuv(dv_decoder_t *dv, dv_videosegment_t *seg, uint8_t **
     } else {
       if(dv->sampling == e_dv_sample_411) {
 	if(mb->x >= 704) {
-	  dv_mb411_right_YUY2(mb, pixels, pitches, dv->add_ntsc_setup); /* Right edge are 420! */
+	  dv_mb411_right_YUY2(mb, pixels, pitches, dv->add_ntsc_setup, luts); /* Right edge are 420! */
 	} else {
-	  dv_mb411_YUY2(mb, pixels, pitches, dv->add_ntsc_setup);
+	  dv_mb411_YUY2(mb, pixels, pitches, dv->add_ntsc_setup, luts);
 	} /* else */
       } else {
-	DV_MB420_YUV(mb, pixels, pitches);
+	DV_MB420_YUV(mb, pixels, pitches, luts);
       } /* else */
     } /* else */
   } /* for    */
@@ -397,19 +525,21 @@ dv_render_video_segment_yuv(dv_decoder_t *dv, dv_videosegment_t *seg, uint8_t **
 
 static inline void
 dv_render_macroblock_yuv(dv_decoder_t *dv, dv_macroblock_t *mb, uint8_t **pixels, int *pitches) {
+  const dv_color_luts_t *luts = dv_color_luts(dv->clamp_luma, dv->clamp_chroma);
   if(dv->sampling == e_dv_sample_411) {
     if(mb->x >= 704) {
-      dv_mb411_right_YUY2(mb, pixels, pitches, dv->add_ntsc_setup); /* Right edge are 420! */
+      dv_mb411_right_YUY2(mb, pixels, pitches, dv->add_ntsc_setup, luts); /* Right edge are 420! */
     } else {
-      dv_mb411_YUY2(mb, pixels, pitches, dv->add_ntsc_setup);
+      dv_mb411_YUY2(mb, pixels, pitches, dv->add_ntsc_setup, luts);
     } /* else */
   } else {
-    DV_MB420_YUV(mb, pixels, pitches);
+    DV_MB420_YUV(mb, pixels, pitches, luts);
   } /* else */
 } /* dv_render_macroblock_yuv */
 
 void
 dv_render_video_segment_yuv(dv_decoder_t *dv, dv_videosegment_t *seg, uint8_t **pixels, int *pitches) {
+  const dv_color_luts_t *luts = dv_color_luts(dv->clamp_luma, dv->clamp_chroma);
   dv_macroblock_t *mb;
   int m;
   for (m=0,mb = seg->mb;
@@ -417,12 +547,12 @@ dv_render_video_segment_yuv(dv_decoder_t *dv, dv_videosegment_t *seg, uint8_t **
        m++,mb++) {
     if(dv->sampling == e_dv_sample_411) {
       if(mb->x >= 704) {
-	dv_mb411_right_YUY2(mb, pixels, pitches, dv->add_ntsc_setup); /* Right edge are 420! */
+	dv_mb411_right_YUY2(mb, pixels, pitches, dv->add_ntsc_setup, luts); /* Right edge are 420! */
       } else {
-	dv_mb411_YUY2(mb, pixels, pitches, dv->add_ntsc_setup);
+	dv_mb411_YUY2(mb, pixels, pitches, dv->add_ntsc_setup, luts);
       } /* else */
     } else {
-      DV_MB420_YUV(mb, pixels, pitches);
+      DV_MB420_YUV(mb, pixels, pitches, luts);
     } /* else */
   } /* for    */
 } /* dv_render_video_segment_yuv */
@@ -447,16 +577,37 @@ void dv_check_coeff_ranges(dv_macroblock_t *mb) {
 void
 dv_decode_full_frame(dv_decoder_t *dv, const uint8_t *buffer,
 		     dv_color_space_t color_space, uint8_t **pixels, int *pitches) {
+  dv_iovec_t iov;
+
+  iov.iov_base = buffer;
+  iov.iov_len = dv->num_dif_seqs * 150 * 80;
+  dv_decode_full_frame_iov(dv, &iov, 1, color_space, pixels, pitches);
+} /* dv_decode_full_frame  */
+
+/* ---------------------------------------------------------------------------
+ * Decode a frame given as a list of chunks, e.g. straight out of a ring
+ * buffer.  Video segments lying inside one chunk are parsed in place; only
+ * the few that straddle a chunk boundary are gathered into a local buffer,
+ * since the segment parser seeks freely within its 400 bytes.  Returns 0,
+ * or -1 if the chunks end before the frame size given by the header; the
+ * video segments up to there are decoded.
+ */
+int
+dv_decode_full_frame_iov(dv_decoder_t *dv, const dv_iovec_t *iov, int iovcnt,
+			 dv_color_space_t color_space, uint8_t **pixels, int *pitches) {
 
   bitstream_t bs = { 0 };
   dv_videosegment_t vs = { 0, 0, &bs };
-  static pthread_mutex_t dv_mutex = PTHREAD_MUTEX_INITIALIZER;
   dv_videosegment_t *seg = &vs;
   dv_macroblock_t *mb;
-  int ds, v, m;
+  dv_iov_cursor_t cursor;
+  uint8_t scratch[80*5] ALIGN32;
+  const uint8_t *data;
+  int ds, v, m, result = 0;
   unsigned int offset = 0, dif = 0, audio=0;
 
-  pthread_mutex_lock(&dv_mutex);
+  _dv_iov_cursor_init(&cursor, iov, iovcnt);
+  pthread_mutex_lock(&_dv_parse_mutex);
   seg->isPAL = (dv->system == e_dv_system_625_50);
 
   /* each DV frame consists of a sequence of DIF segments  */
@@ -480,7 +631,15 @@ dv_decode_full_frame(dv_decoder_t *dv, const uint8_t *buffer,
       } /* if */
       /* stage 1: parse and VLC decode 5 macroblocks that make up a video segment */
       offset = dif * 80;
-      _dv_bitstream_new_buffer(seg->bs, (uint8_t *)buffer + offset, 80*5);
+      if (!(data = _dv_iov_map(&cursor, offset, 80*5, scratch))) {
+	if (dv->video->error_log)
+	  fprintf(dv->video->error_log,
+		  "dv_decode_full_frame: frame ends before byte %u of %lu\n",
+		  offset + 80*5, (unsigned long) dv->frame_size);
+	result = -1;
+	goto short_frame;
+      } /* if */
+      _dv_bitstream_new_buffer(seg->bs, (uint8_t *)data, 80*5);
       dv_parse_video_segment(seg, dv->quality);
       /* stage 2: dequant/unweight/iDCT blocks, and place the macroblocks */
       dif+=5;
@@ -518,19 +677,24 @@ dv_decode_full_frame(dv_decoder_t *dv, const uint8_t *buffer,
 	  dv_render_macroblock_rgb(dv, mb, pixels, pitches);
 	} /* for m */
 	break;
+      default:
+	/* the remaining formats are encoder input only */
+	break;
       } /* switch */
 
     } /* for v */
 
   } /* ds */
-  pthread_mutex_unlock(&dv_mutex);
+ short_frame:
+  pthread_mutex_unlock(&_dv_parse_mutex);
 
 #if RANGE_CHECKING
   for(i=0;i<6;i++) {
     fprintf(stderr, "range[%d] min %d max %d\n", i, ranges[i][0], ranges[i][1]);
   }
 #endif
-} /* dv_decode_full_frame  */
+  return result;
+} /* dv_decode_full_frame_iov  */
 
 /* ---------------------------------------------------------------------------
  */
@@ -51,6 +51,9 @@ extern "C" {
 /* Main API */
 extern dv_decoder_t *dv_decoder_new     (int ignored, int clamp_luma,
 	                  int clamp_chroma);
+extern dv_decoder_t *dv_decoder_new_slim(int ignored, int clamp_luma,
+	                  int clamp_chroma);
+extern void         dv_decoder_reset    (dv_decoder_t *dv);
 extern void         dv_decoder_free     (dv_decoder_t*);
 extern void         dv_init             (int clamp_luma, int clamp_chroma);
 extern void         dv_cleanup          (void);
@@ -60,6 +63,14 @@ extern void         dv_parse_packs      (dv_decoder_t *dv, const uint8_t *buffer
 extern void         dv_decode_full_frame(dv_decoder_t *dv, 
 					  const uint8_t *buffer, dv_color_space_t color_space,
 					  uint8_t **pixels, int *pitches);
+
+/* Scatter-gather variants: the frame is the concatenation of iovcnt chunks */
+extern int          dv_parse_header_iov (dv_decoder_t *dv,
+					  const dv_iovec_t *iov, int iovcnt);
+extern int          dv_decode_full_frame_iov(dv_decoder_t *dv,
+					  const dv_iovec_t *iov, int iovcnt,
+					  dv_color_space_t color_space,
+					  uint8_t **pixels, int *pitches);
 extern int          dv_decode_full_audio(dv_decoder_t *dv, 
 					  const uint8_t *buffer, int16_t **outbufs);
 extern int          dv_set_audio_correction (dv_decoder_t *dv, int method);            
@@ -81,12 +92,40 @@ extern dv_encoder_t *dv_encoder_new     (int rem_ntsc_setup, int clamp_luma,
 extern void         dv_encoder_free     (dv_encoder_t* dv_enc);
 extern int          dv_encode_full_frame(dv_encoder_t *dv_enc, uint8_t **in,
 					  dv_color_space_t color_space, uint8_t *out);
+extern int          dv_encode_full_frame_pitched(dv_encoder_t *dv_enc, 
+					  uint8_t **in, int *pitches,
+					  dv_color_space_t color_space, uint8_t *out);
 	
 extern int          dv_encode_full_audio(dv_encoder_t *dv_enc, int16_t **pcm, 
 					  int channels, int frequency, uint8_t *frame);
 extern void         dv_encode_metadata(uint8_t *target, int isPAL, int is16x9,
 					  time_t *datetime, int frame);
 extern void         dv_encode_timecode(uint8_t *target, int isPAL, int frame);
+extern int          dv_transcode_full_frame(dv_encoder_t *dv_enc, 
+					  const uint8_t *in, uint8_t *out);
+extern int          dv_adjust_full_frame(dv_encoder_t *dv_enc, 
+					  const uint8_t *in, uint8_t *out,
+					  double gain, int brightness);
+
+extern dv_metadata_stamper_t *dv_metadata_stamper_new(int isPAL, int is16x9);
+extern void         dv_metadata_stamper_free(dv_metadata_stamper_t *st);
+extern void         dv_metadata_stamp(dv_metadata_stamper_t *st, 
+					  uint8_t *target, time_t *datetime,
+					  int frame);
+extern void         dv_metadata_stamp_timecode(dv_metadata_stamper_t *st,
+					  uint8_t *target, int frame);
+extern void         dv_metadata_stamp_frames(dv_metadata_stamper_t *st,
+					  uint8_t *frames, int count,
+					  time_t *datetime, int frame,
+					  int timecode);
+
+extern int          dv_encoder_set_preset(dv_encoder_t *dv_enc, 
+					  dv_enc_preset_t preset);
+extern void         dv_encoder_get_stats(dv_encoder_t *dv_enc, 
+					  dv_encoder_stats_t *stats);
+extern void         dv_encoder_reset_stats(dv_encoder_t *dv_enc);
+extern void         dv_encoder_print_stats(const dv_encoder_stats_t *stats,
+					  FILE *f);
 
 /*@}*/
 
@@ -106,6 +145,11 @@ extern void dv_render_video_segment_yuv(dv_decoder_t *dv, dv_videosegment_t *seg
 
 extern int dv_encode_videosegment( dv_encoder_t *dv_enc,
 					dv_videosegment_t *videoseg, uint8_t *vsbuffer);
+extern int dv_transcode_videosegment(dv_encoder_t *dv_enc,
+					dv_videosegment_t *videoseg, uint8_t *vsbuffer);
+extern int dv_adjust_videosegment(dv_encoder_t *dv_enc,
+					dv_videosegment_t *videoseg, uint8_t *vsbuffer,
+					double gain, int brightness);
 
 /* ---------------------------------------------------------------------------
  */
@@ -135,6 +179,24 @@ extern int dv_get_timestamp (dv_decoder_t *dv, char *tstprt),
            dv_get_recording_datetime_tm (dv_decoder_t *dv, struct tm *rec_dt),
            dv_get_ssyb_pack (dv_decoder_t *dv, uint8_t pack_id, uint8_t *pack_data);
 
+/* ---------------------------------------------------------------------------
+ * shot detection on DC images
+ */
+extern int          dv_decode_dc_image(dv_decoder_t *dv, const uint8_t *buffer,
+				       uint8_t *image);
+extern dv_scene_detector_t *dv_scene_detector_new(void);
+extern void         dv_scene_detector_free(dv_scene_detector_t *sd);
+extern void         dv_scene_detector_set_thresholds(dv_scene_detector_t *sd,
+						     double sad, double histogram);
+extern int          dv_scene_detect(dv_scene_detector_t *sd, dv_decoder_t *dv,
+				    const uint8_t *buffer, dv_scene_info_t *info);
+
+/* ---------------------------------------------------------------------------
+ * quality and complexity statistics
+ */
+extern int          dv_analyze_frame(dv_decoder_t *dv, const uint8_t *buffer,
+				     dv_frame_analysis_t *fa);
+
 /* ---------------------------------------------------------------------------
  * functions based on aaux data
  */
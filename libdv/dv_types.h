@@ -107,6 +107,9 @@
 #define DV_DECODER_OPT_NTSCSETUP     4
 #define DV_DECODER_NUM_OPTS          5
 
+#define DV_DECODER_ALLOC_SEPARATE    0 /* dv_decoder_new() */
+#define DV_DECODER_ALLOC_BLOCK       1 /* dv_decoder_new_slim() */
+
 #define DV_OSS_OPT_DEVICE 0
 #define DV_OSS_OPT_FILE   1
 #define DV_OSS_NUM_OPTS   2
@@ -144,6 +147,11 @@ typedef enum color_space_e {
   e_dv_color_yuv, 
   e_dv_color_rgb, 
   e_dv_color_bgr0, 
+  /* planar and semi-planar YUV, encoder input only */
+  e_dv_color_i420,      /* Y, Cb and Cr planes, 4:2:0 */
+  e_dv_color_nv12,      /* Y plane and interleaved CbCr plane, 4:2:0 */
+  e_dv_color_yv16,      /* Y, Cr and Cb planes, 4:2:2 */
+  e_dv_color_rgba,      /* R, G, B and alpha bytes, encoder input only */
 } dv_color_space_t;
 
 typedef enum sample_e { 
@@ -168,6 +176,13 @@ typedef enum std_e {
 typedef int16_t dv_coeff_t;
 typedef int32_t dv_248_coeff_t;
 
+/* One contiguous piece of a DV frame, e.g. one half of a wrapped ring
+ * buffer.  Layout compatible with struct iovec. */
+typedef struct dv_iovec_s {
+  const void *iov_base;
+  size_t      iov_len;
+} dv_iovec_t;
+
 typedef struct bitstream_s {
   uint32_t current_word;
   uint32_t next_word;
@@ -206,8 +221,8 @@ typedef struct {
   dv_coeff_t   coeffs[64] ALIGN8;
   int         dct_mode;
   int         class_no;
-  int8_t        *reorder;
-  int8_t        *reorder_sentinel;
+  const int8_t  *reorder;
+  const int8_t  *reorder_sentinel;
   int         offset;   // bitstream offset of first unused bit
   int         end;      // bitstream offset of last bit + 1
   int         eob;
@@ -430,7 +445,7 @@ typedef struct {
   FILE             *error_log;
   dv_decoder_tp    dv_decoder;
 #if HAVE_LIBPOPT
-  struct poptOption option_table[DV_AUDIO_NUM_OPTS+1];
+  struct poptOption *option_table; // DV_AUDIO_NUM_OPTS+1 entries
 #endif // HAVE_LIBPOPT
 } dv_audio_t;
 
@@ -444,11 +459,23 @@ typedef struct {
   FILE              *error_log;
   dv_decoder_tp     dv_decoder;
 #if HAVE_LIBPOPT
-  struct poptOption  option_table[DV_VIDEO_NUM_OPTS+1];
+  struct poptOption  *option_table; // DV_VIDEO_NUM_OPTS+1 entries
 #endif // HAVE_LIBPOPT
 
 } dv_video_t;
 
+/* Colour conversion lookup tables for one clamp_luma/clamp_chroma
+ * combination, see dv_color_luts().  Chroma tables are indexed
+ * -128 .. 127, luma tables -256 .. 511.  The tables are immutable,
+ * so any number of decoders may share them. */
+typedef struct {
+  const int32_t     *table_2_018, *table_0_813, *table_0_391, *table_1_596;
+  const int32_t     *rgb_ylut, *rgb_ylut_setup;
+  const uint8_t     *uvlut;
+  const uint8_t     *yuy2_ylut, *yuy2_ylut_setup;
+  const uint8_t     *yv12_ylut;
+} dv_color_luts_t;
+
 typedef struct dv_decoder_s {
   unsigned int       quality;
   dv_system_t        system;
@@ -477,9 +504,14 @@ typedef struct dv_decoder_s {
   uint8_t             ssyb_pack [256];
   uint8_t             ssyb_data [45][4];
   bitstream_t        *bs;
+  /* -------------------------------------------------------------------------
+   * how dv_decoder_free() releases the decoder, DV_DECODER_ALLOC_*
+   */
+  int                 alloc;
 
 #if HAVE_LIBPOPT
-  struct poptOption option_table[DV_DECODER_NUM_OPTS+1];
+  /* DV_DECODER_NUM_OPTS+1 entries, NULL for dv_decoder_new_slim() */
+  struct poptOption  *option_table;
 #endif // HAVE_LIBPOPT
 } dv_decoder_t;
 
@@ -493,6 +525,40 @@ typedef struct {
 #endif // HAVE_LIBPOPT
 } dv_oss_t;
 
+/* Speed presets of the encoder, see dv_encoder_set_preset() */
+typedef enum {
+  DV_ENC_PRESET_BEST,
+  DV_ENC_PRESET_BALANCED,
+  DV_ENC_PRESET_REALTIME,
+} dv_enc_preset_t;
+
+/* Stages of the encoder timed in dv_encoder_stats_t */
+enum {
+  DV_ENC_STAGE_CONVERT,   /* input conversion, 2-4-8 DCT decision */
+  DV_ENC_STAGE_DCT,
+  DV_ENC_STAGE_CLASSIFY,
+  DV_ENC_STAGE_QUANT,     /* quantiser search and VLC coding */
+  DV_ENC_STAGE_VLC,       /* packing the codes into the video segments */
+  DV_ENC_STAGE_META,      /* headers, subcode and VAUX */
+  DV_ENC_NUM_STAGES
+};
+
+/* Statistics of an encoder, see dv_encoder_get_stats() */
+typedef struct {
+  long    frames;
+  long    segs_encoded;       /* video segments encoded */
+  long    segs_skipped;       /* and reused with skip_static */
+  long    runs_used[16];      /* quantiser search steps */
+  long    cycles_used[15*5*6];
+  long    classes_used[4];
+  long    qnos_used[16];
+  long    dct_used[2];        /* DV_DCT_88, DV_DCT_248 */
+  long    vlc_overflows;      /* code that did not fit and was dropped */
+  int64_t bits_used;          /* AC coefficient bits of the segments */
+  int64_t bits_budget;        /* and the room there was for them */
+  double  stage_seconds[DV_ENC_NUM_STAGES];  /* with stage_timing */
+} dv_encoder_stats_t;
+
 typedef struct {
   int    isPAL;
   int    is16x9;
@@ -504,12 +570,89 @@ typedef struct {
   int    clamp_chroma;
   int    frame_count;
   int    samples_this_frame;
+  int    num_threads;     /* encode video segments on this many threads,
+                             < 0 for one per CPU, 0 or 1 for none */
+  int    skip_static;     /* reuse the compressed video segments whose
+                             input did not change since the last frame */
+  int    stage_timing;    /* measure the time spent in the stages of
+                             the encoder, see dv_encoder_get_stats() */
+  int    target_fps;      /* step the speed presets down or up to
+                             encode this many frames per second, 0 for
+                             off, see dv_encoder_set_preset() */
   /* the below are private */
-  short *img_y;
-  short *img_cr;
+  short *img_y;                 /* picture of dv_encode_videosegment(), */
+  short *img_cr;                /* allocated on first use */
   short *img_cb;
+  struct dv_enc_pool_s *pool;
+  uint8_t **in;                 /* frame of dv_encode_full_frame(),
+                                   converted per macroblock */
+  int in_pitches[3];
+  dv_color_space_t in_color_space;
+  struct dv_enc_tile_s *tile;   /* of the thread calling the encoder */
+  struct dv_enc_seg_cache_s *seg_cache;
+  struct dv_enc_template_s *frame_template; /* static meta data */
+  dv_encoder_stats_t *stats;
+  int preset_level;             /* rung of the adaptive ladder */
+  double frame_seconds;         /* running mean of the encoding time */
+  int fast_frames;              /* frames in a row well within target_fps */
 } dv_encoder_t;
 
+/* Restamps the subcode and VAUX meta data of frames, see
+   dv_metadata_stamper_new() */
+typedef struct dv_metadata_stamper_s dv_metadata_stamper_t;
+
+/* DC images, see dv_decode_dc_image(): one luma pixel per 8x8 block */
+#define DV_DC_IMAGE_WIDTH      90
+#define DV_DC_IMAGE_MAX_HEIGHT 72
+
+/* Finds shot boundaries, see dv_scene_detector_new() */
+typedef struct dv_scene_detector_s dv_scene_detector_t;
+
+/* flags of dv_scene_detect() */
+#define DV_SCENE_CUT           1  /* the picture changed abruptly */
+#define DV_SCENE_NEW_RECORDING 2  /* the recording was stopped and restarted */
+
+typedef struct {
+  int    frame;      /* number of the frame, counting from 0 */
+  int    flags;      /* DV_SCENE_* */
+  double sad;        /* mean absolute difference of the DC image to that
+                        of the previous frame, in luma levels */
+  double histogram;  /* difference of their histograms, 0 to 1 */
+} dv_scene_info_t;
+
+/* statistics of dv_analyze_frame() */
+#define DV_ANALYSIS_MAX_REGIONS  60    /* superblocks of a PAL frame */
+#define DV_ANALYSIS_MAX_SEGMENTS 324   /* video segments of a PAL frame */
+#define DV_ANALYSIS_SEGMENT_BITS 2680  /* AC bits of a video segment */
+
+typedef struct {
+  int macroblocks;
+  int qno_sum;            /* of the macroblocks, for the mean */
+  int dct_248;            /* blocks with the 2-4-8 DCT */
+  int incomplete_blocks;  /* blocks without EOB */
+  int errors;             /* macroblocks with VLC or STA errors */
+} dv_region_analysis_t;
+
+typedef struct {
+  int isPAL;
+  int segments, macroblocks, blocks;
+  int qnos[16];           /* macroblocks per quantisation number */
+  int classes[4];         /* blocks per class */
+  int dct_248;            /* blocks with the 2-4-8 DCT, a sign of motion */
+  int bits_used;          /* AC bits, with the EOBs */
+  int bits_available;
+  int full_segments;      /* segments without room for another EOB */
+  int incomplete_blocks;  /* blocks without EOB: dropped coefficients or
+                             damage */
+  int vlc_errors;         /* macroblocks with invalid VLC codes */
+  int sta_errors;         /* macroblocks flagged damaged by the recorder */
+  int num_regions;        /* superblocks, 5 per row */
+  dv_region_analysis_t regions[DV_ANALYSIS_MAX_REGIONS];
+  int segment_bits[DV_ANALYSIS_MAX_SEGMENTS];  /* AC bits used by each
+                                                  video segment, in frame
+                                                  order */
+} dv_frame_analysis_t;
+
 #if ARCH_X86
 extern int dv_use_mmx;
 #elif ARCH_X86_64
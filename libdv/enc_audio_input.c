@@ -254,7 +254,7 @@ static void wav_finish()
 static int wav_load(dv_enc_audio_info_t * audio_info, int isPAL)
 {
 	int rval;
-	unsigned char data[DV_AUDIO_MAX_SAMPLES * 2 * 2];
+	unsigned char data[DV_AUDIO_MAX_SAMPLES * 2 * 4]; /* 4 channels */
 
 	bytesperframe(audio_info, isPAL);
 
@@ -36,6 +36,7 @@
 #include "encode.h"
 #include "dct.h"
 #include "dv_types.h"
+#include "util.h"
 #if ARCH_X86 || ARCH_X86_64
 #include "mmx.h"
 #else
@@ -61,6 +62,23 @@
 
 // #define ARCH_X86 0
 
+/* The conversions and the 2-4-8 DCT decision below have versions
+ * written with the vector extensions */
+#define ENC_INPUT_VECTOR DV_VECTOR
+
+#if ENC_INPUT_VECTOR
+#if ARCH_X86_64 || ARCH_X86
+#include <immintrin.h>
+#endif
+
+typedef uint8_t enc_in_v8b __attribute__ ((vector_size (8)));
+typedef uint16_t enc_in_v8u __attribute__ ((vector_size (16)));
+typedef int16_t enc_in_v8 __attribute__ ((vector_size (16)));
+
+#define ENC_IN_EVEN 0, 2, 4, 6, 8, 10, 12, 14
+#define ENC_IN_ODD  1, 3, 5, 7, 9, 11, 13, 15
+#endif
+
 #if (!ARCH_X86) && (!ARCH_X86_64)
 static inline int f2b(float f)
 {
@@ -88,27 +106,136 @@ extern void _dv_rgbtoycb_mmx(unsigned char* inPtr, int rows, int columns,
 extern void _dv_rgbtoycb_mmx_x86_64(unsigned char* inPtr, int rows, int columns,
 			 short* outyPtr, short* outuPtr, short* outvPtr);
 
-void dv_enc_rgb_to_ycb(unsigned char* img_rgb, int height,
-		       short* img_y, short* img_cr, short* img_cb)
+#if ARCH_X86 || ARCH_X86_64
+
+/* The arithmetic of _dv_rgbtoycb_mmx: 15 bit coefficients, the
+ * products summed in 32 bits and scaled down, and every chroma sample
+ * the mean of a pixel pair. */
+#define RGB32_Y(r, g, b)						\
+	((((8414 * (r)) + (16519 * (g)) + (3208 * (b)))			\
+	  >> (15 - DCT_YUV_PRECISION)) + ((16 - 128) << DCT_YUV_PRECISION))
+#define RGB32_CR(r, g, b)						\
+	(((14392 * (r)) + (-12061 * (g)) + (-2332 * (b)))		\
+	 >> (15 - DCT_YUV_PRECISION))
+#define RGB32_CB(r, g, b)						\
+	(((-4864 * (r)) + (-9528 * (g)) + (14392 * (b)))		\
+	 >> (15 - DCT_YUV_PRECISION))
+
+#if ENC_INPUT_VECTOR
+
+typedef uint32_t rgb32_v8u __attribute__ ((vector_size (32)));
+typedef int32_t rgb32_v8 __attribute__ ((vector_size (32)));
+
+/* 16 pixels of 32 bit RGB per round; sets i to the pixels done */
+#define RGB32_TO_YCB(src, n, ro, ty, tr, tb, i) do {			\
+	for (i = 0; i + 16 <= n; i += 16) {				\
+		rgb32_v8u p[2];						\
+		rgb32_v8 r_, g_, b_, y_, cr_[2], cb_[2];		\
+		enc_in_v8 c_;						\
+		int k_;							\
+		memcpy(p, src + 4 * i, sizeof(p));			\
+		for (k_ = 0; k_ < 2; k_++) {				\
+			r_ = (rgb32_v8) ((p[k_] >> (8 * ro)) & 0xff);	\
+			g_ = (rgb32_v8) ((p[k_] >> 8) & 0xff);		\
+			b_ = (rgb32_v8) ((p[k_] >> (16 - 8 * ro)) & 0xff); \
+			y_ = RGB32_Y(r_, g_, b_);			\
+			c_ = __builtin_convertvector(y_, enc_in_v8);	\
+			memcpy(ty + i + 8 * k_, &c_, sizeof(c_));	\
+			cr_[k_] = RGB32_CR(r_, g_, b_);			\
+			cb_[k_] = RGB32_CB(r_, g_, b_);			\
+		}							\
+		c_ = __builtin_convertvector(				\
+			(DV_SHUFFLE(cr_[0], cr_[1], rgb32_v8, ENC_IN_EVEN) \
+			 + DV_SHUFFLE(cr_[0], cr_[1], rgb32_v8, ENC_IN_ODD)) \
+			>> 1, enc_in_v8);				\
+		memcpy(tr + i / 2, &c_, sizeof(c_));			\
+		c_ = __builtin_convertvector(				\
+			(DV_SHUFFLE(cb_[0], cb_[1], rgb32_v8, ENC_IN_EVEN) \
+			 + DV_SHUFFLE(cb_[0], cb_[1], rgb32_v8, ENC_IN_ODD)) \
+			>> 1, enc_in_v8);				\
+		memcpy(tb + i / 2, &c_, sizeof(c_));			\
+	}								\
+} while (0)
+
+__attribute__ ((target ("sse2")))
+static int rgb32_to_ycb_sse2(const uint8_t *src, int n, int ro,
+			     short *ty, short *tr, short *tb)
+{
+	int i;
+
+	RGB32_TO_YCB(src, n, ro, ty, tr, tb, i);
+	return i;
+}
+
+__attribute__ ((target ("avx2")))
+static int rgb32_to_ycb_avx2(const uint8_t *src, int n, int ro,
+			     short *ty, short *tr, short *tb)
+{
+	int i;
+
+	RGB32_TO_YCB(src, n, ro, ty, tr, tb, i);
+	return i;
+}
+
+#endif /* ENC_INPUT_VECTOR */
+
+/* n pixels of 32 bit RGB with red at byte ro and blue at byte 2 - ro,
+ * giving what _dv_rgbtoycb_mmx gives for the same pixels packed */
+static void rgb32_to_ycb_span(const uint8_t *src, int n, int ro,
+			      short *ty, short *tr, short *tb)
+{
+	int i = 0;
+
+#if ENC_INPUT_VECTOR
+	if (_dv_simd.avx2) {
+		i = rgb32_to_ycb_avx2(src, n, ro, ty, tr, tb);
+	} else if (_dv_simd.sse2) {
+		i = rgb32_to_ycb_sse2(src, n, ro, ty, tr, tb);
+	}
+#endif
+	for (; i < n; i += 2) {
+		const uint8_t *p = src + 4 * i, *q = p + 4;
+
+		ty[i] = RGB32_Y(p[ro], p[1], p[2 - ro]);
+		ty[i + 1] = RGB32_Y(q[ro], q[1], q[2 - ro]);
+		tr[i / 2] = (RGB32_CR(p[ro], p[1], p[2 - ro])
+			     + RGB32_CR(q[ro], q[1], q[2 - ro])) >> 1;
+		tb[i / 2] = (RGB32_CB(p[ro], p[1], p[2 - ro])
+			     + RGB32_CB(q[ro], q[1], q[2 - ro])) >> 1;
+	}
+}
+
+#endif /* ARCH_X86 || ARCH_X86_64 */
+
+/* Converts n pixels of packed RGB, bpp bytes each with red at byte ro
+ * and blue at byte 2 - ro, to Y and 4:2:2 Cr/Cb.  prev is the pixel
+ * before img_rgb in the frame, NULL at its start; the MMX code wants n
+ * to be a multiple of 8. */
+static void rgb_to_ycb_span(unsigned char* img_rgb, unsigned char* prev,
+			    int n, int bpp, int ro,
+			    short* ty, short* tr, short* tb)
 {
 #if (!ARCH_X86) && (!ARCH_X86_64)
-#if 1
        int i;
-       int ti;
        unsigned char *ip;
        register long r,g,b ;
        long colr, colb;
-       register short int *ty, *tr, *tb;
-       ip =  img_rgb;  
+       ip =  img_rgb;
        colr = colb =  0;
-       ty = img_y;     
-       tr = img_cr;
-       tb = img_cb;
-       ti = height * DV_WIDTH ;
-       for (i = 0; i < ti; i++) {
-	       r = *ip++;
-	       g = *ip++; 
-	       b = *ip++;
+       if (prev) {
+	       /* a chroma sample also takes in the pixel before its pair,
+		  even across lines */
+	       r = prev[ro];
+	       g = prev[1];
+	       b = prev[2 - ro];
+	       colr =  ( (28784 * r) + (-24121 * g) + (-4663 * b) ) ; 
+	       colb =  ( (-9729 * r) + (-19055 * g) + (28784 * b) ) ;
+       }
+       for (i = 0; i < n; i++) {
+	       r = ip[ro];
+	       g = ip[1]; 
+	       b = ip[2 - ro];
+	       ip += bpp;
 
 	       *ty++ =  (( ( (16828 * r) + (33038 * g) + (6416 * b) )
 			   >> 16   ) - 128 + 16) << DCT_YUV_PRECISION;
@@ -122,6 +249,22 @@ void dv_enc_rgb_to_ycb(unsigned char* img_rgb, int height,
 	       }       
        }
 #else
+	if (bpp == 4) {
+		rgb32_to_ycb_span(img_rgb, n, ro, ty, tr, tb);
+		return;
+	}
+#if ARCH_X86_64
+	_dv_rgbtoycb_mmx_x86_64(img_rgb, 1, n, ty, tr, tb);
+#else
+	_dv_rgbtoycb_mmx(img_rgb, 1, n, ty, tr, tb);
+#endif
+#endif
+}
+
+void dv_enc_rgb_to_ycb(unsigned char* img_rgb, int height,
+		       short* img_y, short* img_cr, short* img_cb)
+{
+#if 0
 	int x,y;
 	/* This is the RGB -> YUV color matrix */
 	static const double cm[3][3] = {
@@ -164,18 +307,30 @@ void dv_enc_rgb_to_ycb(unsigned char* img_rgb, int height,
 				      tmp_cb[y][2*x+1]) / 2.0);
 		}
 	}
-#endif
-#elif ARCH_X86_64
-	_dv_rgbtoycb_mmx_x86_64(img_rgb, height, DV_WIDTH, (short*) img_y,
-		     (short*) img_cr, (short*) img_cb);
-	emms();
 #else
-	_dv_rgbtoycb_mmx(img_rgb, height, DV_WIDTH, (short*) img_y,
-		     (short*) img_cr, (short*) img_cb);
+	rgb_to_ycb_span(img_rgb, NULL, height * DV_WIDTH, 3, 0,
+			img_y, img_cr, img_cb);
+#if ARCH_X86 || ARCH_X86_64
 	emms();
 #endif
+#endif
+}
+
+/* The 32 bit variants of dv_enc_rgb_to_ycb(), for B, G, R, 0 and for
+ * R, G, B, A pixels; the fourth byte is ignored. */
+void dv_enc_bgr0_to_ycb(unsigned char* img_bgr0, int height,
+			short* img_y, short* img_cr, short* img_cb)
+{
+	rgb_to_ycb_span(img_bgr0, NULL, height * DV_WIDTH, 4, 2,
+			img_y, img_cr, img_cb);
 }
 
+void dv_enc_rgba_to_ycb(unsigned char* img_rgba, int height,
+			short* img_y, short* img_cr, short* img_cb)
+{
+	rgb_to_ycb_span(img_rgba, NULL, height * DV_WIDTH, 4, 0,
+			img_y, img_cr, img_cb);
+}
 
 static unsigned char* readbuf = NULL;
 static unsigned char* real_readbuf = 0; /* for wrong interlacing */
@@ -186,6 +341,119 @@ static short* img_y = NULL; /* [DV_PAL_HEIGHT * DV_WIDTH]; */
 static short* img_cr = NULL; /* [DV_PAL_HEIGHT * DV_WIDTH / 2]; */
 static short* img_cb = NULL; /* [DV_PAL_HEIGHT * DV_WIDTH / 2]; */
 
+/* ---------------------------------------------------------------------------
+ * 2-4-8 DCT decision with GCC vector extensions.  For every block the
+ * absolute differences between horizontally and between vertically
+ * adjacent samples are summed over all rows at once (over two blocks
+ * at once with AVX2); a block whose inter-line differences are large
+ * compared with those along the lines has motion between the fields
+ * and gets the 2-4-8 DCT.  The sums and the decision are exactly those
+ * of need_dct_248_transposed() and _dv_need_dct_248_mmx*_rows.
+ */
+#if ENC_INPUT_VECTOR
+
+typedef int16_t dct_mode_v8 __attribute__ ((vector_size (16)));
+
+#define DCT_MODE_ABS(d) (((d) ^ ((d) >> 15)) - ((d) >> 15))
+
+/* the lane right of each lane, the last one of a row repeated */
+#define DCT_MODE_NEXT8  1, 2, 3, 4, 5, 6, 7, 7
+#define DCT_MODE_NEXT16 1, 2, 3, 4, 5, 6, 7, 7, 9, 10, 11, 12, 13, 14, 15, 15
+
+/* sums along (h) and across (v) the rows of n blocks held side by
+ * side in r, eight lanes per block */
+#define DCT_MODE_SUMS(r, V, NEXT, LAST, h, v) do {			\
+	V sh = { 0 }, sv = { 0 }, d;					\
+	int i_;								\
+	for (i_ = 0; i_ < 8; i_++) {					\
+		d = (r[i_] - DV_SHUFFLE(r[i_], r[i_], V, NEXT)) & LAST;	\
+		sh += DCT_MODE_ABS(d);					\
+		if (i_ < 7) {						\
+			d = r[i_] - r[i_ + 1];				\
+			sv += DCT_MODE_ABS(d);				\
+		}							\
+	}								\
+	for (i_ = 0; i_ < (int) (sizeof(V) / sizeof(int16_t)); i_++) {	\
+		h[i_ / 8] += sh[i_];					\
+		v[i_ / 8] += sv[i_];					\
+	}								\
+} while (0)
+
+#if ARCH_X86_64 || ARCH_X86
+__attribute__ ((target ("sse2")))
+#endif
+static void dct_mode_sums_v8(const dv_block_t *bl, int *h, int *v)
+{
+	static const dct_mode_v8 last = { -1, -1, -1, -1, -1, -1, -1, 0 };
+	dct_mode_v8 r[8];
+
+	memcpy(r, bl->coeffs, sizeof(r));
+	DCT_MODE_SUMS(r, dct_mode_v8, DCT_MODE_NEXT8, last, h, v);
+}
+
+#if ARCH_X86_64 || ARCH_X86
+
+typedef int16_t dct_mode_v16 __attribute__ ((vector_size (32)));
+
+__attribute__ ((target ("avx2")))
+static void dct_mode_sums_v16(const dv_block_t *bl, int *h, int *v)
+{
+	static const dct_mode_v16 last = { 
+		-1, -1, -1, -1, -1, -1, -1, 0, -1, -1, -1, -1, -1, -1, -1, 0 };
+	dct_mode_v16 r[8];
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		__m128i a, b;
+
+		a = _mm_loadu_si128((const __m128i *) (bl[0].coeffs + 8 * i));
+		b = _mm_loadu_si128((const __m128i *) (bl[1].coeffs + 8 * i));
+		r[i] = (dct_mode_v16) _mm256_inserti128_si256(
+			_mm256_castsi128_si256(a), b, 1);
+	}
+	DCT_MODE_SUMS(r, dct_mode_v16, DCT_MODE_NEXT16, last, h, v);
+}
+
+#endif /* ARCH_X86_64 || ARCH_X86 */
+
+#endif /* ENC_INPUT_VECTOR */
+
+/* Sets the dct_mode of the six blocks of a macroblock, whose samples
+ * are transposed or not.  Returns 0 if there is no vector version on
+ * this machine, and the caller has to decide itself. */
+static int choose_dct_modes(dv_block_t * bl, int transposed)
+{
+#if ENC_INPUT_VECTOR
+	int h[6] = { 0, 0, 0, 0, 0, 0 };
+	int v[6] = { 0, 0, 0, 0, 0, 0 };
+	int b;
+#if ARCH_X86_64 || ARCH_X86
+	if (!_dv_simd.sse2) {
+		return 0;
+	}
+	if (_dv_simd.avx2) {
+		for (b = 0; b < 6; b += 2) {
+			dct_mode_sums_v16(bl + b, h + b, v + b);
+		}
+	} else
+#endif
+	for (b = 0; b < 6; b++) {
+		dct_mode_sums_v8(bl + b, h + b, v + b);
+	}
+
+	for (b = 0; b < 6; b++) {
+		int inter = (transposed ? h[b] : v[b]) + 1;
+		int intra = (transposed ? v[b] : h[b]) + 1;
+
+		bl[b].dct_mode = ((inter * 65536 / intra) > DCT_248_THRESHOLD)
+			? DV_DCT_248 : DV_DCT_88;
+	}
+	return 1;
+#else
+	return 0;
+#endif
+}
+
 #if (!ARCH_X86) && (!ARCH_X86_64)
 
 static int need_dct_248_transposed(dv_coeff_t * bl)
@@ -230,13 +498,14 @@ static void finish_mb_mmx(dv_macroblock_t* mb)
 {
 	int b;
 	int need_dct_248_rows[6];
+	int vec = 0;
 	dv_block_t* bl = mb->b;
 
 	if (force_dct != -1) {
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = force_dct;
 		}
-	} else {
+	} else if (!(vec = choose_dct_modes(bl, 0))) {
 		for (b = 0; b < 6; b++) {
 			need_dct_248_rows[b]
 				= _dv_need_dct_248_mmx_rows(bl[b].coeffs) + 1;
@@ -249,7 +518,7 @@ static void finish_mb_mmx(dv_macroblock_t* mb)
 	_dv_transpose_mmx(bl[4].coeffs);
 	_dv_transpose_mmx(bl[5].coeffs);
 
-	if (force_dct == -1) {
+	if (force_dct == -1 && !vec) {
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = 
 				((need_dct_248_rows[b] * 65536 / 
@@ -272,13 +541,14 @@ static void finish_mb_mmx_x86_64(dv_macroblock_t* mb)
 {
 	int b;
 	int need_dct_248_rows[6];
+	int vec = 0;
 	dv_block_t* bl = mb->b;
 
 	if (force_dct != -1) {
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = force_dct;
 		}
-	} else {
+	} else if (!(vec = choose_dct_modes(bl, 0))) {
 		for (b = 0; b < 6; b++) {
 			need_dct_248_rows[b]
 				= _dv_need_dct_248_mmx_x86_64_rows(bl[b].coeffs) + 1;
@@ -291,7 +561,7 @@ static void finish_mb_mmx_x86_64(dv_macroblock_t* mb)
 	_dv_transpose_mmx_x86_64(bl[4].coeffs);
 	_dv_transpose_mmx_x86_64(bl[5].coeffs);
 
-	if (force_dct == -1) {
+	if (force_dct == -1 && !vec) {
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = 
 				((need_dct_248_rows[b] * 65536 / 
@@ -303,7 +573,8 @@ static void finish_mb_mmx_x86_64(dv_macroblock_t* mb)
 
 #endif /* ARCH_X86 */
 
-static int read_ppm_stream(FILE* f, int * isPAL, int * height_)
+static int read_ppm_stream_buf(FILE* f, int * isPAL, int * height_,
+			       unsigned char * buf)
 {
 	int height, width, depth = 0;
 	char line[200];
@@ -330,19 +601,24 @@ static int read_ppm_stream(FILE* f, int * isPAL, int * height_)
 	if (depth == 0)
 		fgets(line, sizeof(line), f);	/* 255 */
 	
-	fread(readbuf, 1, 3 * DV_WIDTH * height, f);
+	fread(buf, 1, 3 * DV_WIDTH * height, f);
 
 	*height_ = height;
 	*isPAL = (height == DV_PAL_HEIGHT);
 
 	if (wrong_interlace) {
-		memcpy(readbuf + DV_WIDTH * height*3, 
-		       readbuf + DV_WIDTH * (height-1)*3, DV_WIDTH*3);
+		memcpy(buf + DV_WIDTH * height*3, 
+		       buf + DV_WIDTH * (height-1)*3, DV_WIDTH*3);
 	}
 
 	return 0;
 }
 
+static int read_ppm_stream(FILE* f, int * isPAL, int * height_)
+{
+	return read_ppm_stream_buf(f, isPAL, height_, readbuf);
+}
+
 static int ppm_init(int wrong_interlace_, int force_dct_) 
 {
 	wrong_interlace = wrong_interlace_;
@@ -406,6 +682,39 @@ static int ppm_skip(const char* filename, int * isPAL)
 	return rval;
 }
 
+static int ppm_read(const char* filename, int * isPAL, unsigned char * buf)
+{
+	FILE* ppm_in = NULL;
+	int rval = -1;
+	int height;
+
+	if (strcmp(filename, "-") == 0) {
+		ppm_in = stdin;
+	} else {
+		ppm_in = fopen(filename, "r");
+		if (ppm_in == NULL) {
+			return -1;
+		}
+	}
+
+	rval = read_ppm_stream_buf(ppm_in, isPAL, &height, buf);
+	if (ppm_in != stdin) {
+		fclose(ppm_in);
+	}
+	return rval;
+}
+
+static void ppm_convert(unsigned char * buf, int isPAL, dv_encoder_t * enc)
+{
+	if (wrong_interlace) {
+		buf += DV_WIDTH * 3;
+	}
+	dv_enc_rgb_to_ycb(buf, isPAL ? DV_PAL_HEIGHT : DV_NTSC_HEIGHT,
+			  enc->img_y, enc->img_cr, enc->img_cb);
+	enc->isPAL = isPAL;
+	enc->force_dct = force_dct;
+}
+
 static void ppm_fill_macroblock(dv_macroblock_t *mb, int isPAL)
 {
 	int y = mb->y;
@@ -505,7 +814,7 @@ static void ppm_fill_macroblock(dv_macroblock_t *mb, int isPAL)
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = force_dct;
 		}
-	} else {
+	} else if (!choose_dct_modes(bl, 1)) {
 		int b;
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = need_dct_248_transposed(bl[b].coeffs) 
@@ -851,7 +1160,7 @@ static void pgm_fill_macroblock(dv_macroblock_t *mb, int isPAL)
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = force_dct;
 		}
-	} else {
+	} else if (!choose_dct_modes(bl, 1)) {
 		int b;
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = need_dct_248_transposed(bl[b].coeffs) 
@@ -1220,7 +1529,7 @@ static void video_fill_macroblock(dv_macroblock_t *mb, int isPAL)
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = force_dct;
 		}
-	} else {
+	} else if (!choose_dct_modes(bl, 1)) {
 		int b;
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = need_dct_248_transposed(bl[b].coeffs) 
@@ -1369,14 +1678,15 @@ static void video_fill_macroblock(dv_macroblock_t *mb, int isPAL)
 
 static dv_enc_input_filter_t filters[DV_ENC_MAX_INPUT_FILTERS] = {
 	{ ppm_init, ppm_finish, ppm_load, ppm_skip, 
-	  ppm_fill_macroblock, "ppm" },
+	  ppm_fill_macroblock, "ppm",
+	  DV_WIDTH * (DV_PAL_HEIGHT + 1) * 3, ppm_read, ppm_convert },
 #if HAVE_DEV_VIDEO
 	{ video_init, video_finish, video_load, video_load, 
 	  video_fill_macroblock,"video" },
 #endif
 	{ pgm_init, pgm_finish, pgm_load, pgm_skip, 
 	  pgm_fill_macroblock, "pgm" },
-	{ NULL, NULL, NULL, NULL }};
+	{ NULL, NULL, NULL, NULL, NULL, NULL }};
 
 void dv_enc_register_input_filter(dv_enc_input_filter_t filter)
 {
@@ -1400,36 +1710,33 @@ int dv_enc_get_input_filters(dv_enc_input_filter_t ** filters_,
 
 /****** public encoder implementation ***********************************/
 /* By Dan Dennedy <dan@dennedy.org> */
-void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
+static void ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_block_t *bl,
+				int x, int y, short *img_y, short *img_cr,
+				short *img_cb)
 {
-	int y = mb->y;
-	int x = mb->x;
-	dv_block_t *bl = mb->b;
-
-
 #if (!ARCH_X86) && (!ARCH_X86_64)
 	if (dv_enc->isPAL) { /* PAL */
 		int i,j;
 		for (j = 0; j < 8; j++) {
 			for (i = 0; i < 8; i++) {
 				bl[0].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + j) * DV_WIDTH +  x + i];
+					img_y[(y + j) * DV_WIDTH +  x + i];
 				bl[1].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + j) * DV_WIDTH +  x + 8 + i];
+					img_y[(y + j) * DV_WIDTH +  x + 8 + i];
 				bl[2].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + 8 + j) * DV_WIDTH + x + i];
+					img_y[(y + 8 + j) * DV_WIDTH + x + i];
 				bl[3].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + 8 + j) * DV_WIDTH 
+					img_y[(y + 8 + j) * DV_WIDTH 
 					     + x + 8 + i];
 				bl[4].coeffs[8 * i + j] = 
-					(dv_enc->img_cr[(y + 2*j) * DV_WIDTH/2 
+					(img_cr[(y + 2*j) * DV_WIDTH/2 
 					       + x / 2 + i]
-					+ dv_enc->img_cr[(y + 2*j + 1) * DV_WIDTH/2
+					+ img_cr[(y + 2*j + 1) * DV_WIDTH/2
 						+ x / 2 + i]) >> 1;
 				bl[5].coeffs[8 * i + j] = 
-					(dv_enc->img_cb[(y + 2*j) * DV_WIDTH/2
+					(img_cb[(y + 2*j) * DV_WIDTH/2
 					      + x / 2 + i]
-					+ dv_enc->img_cb[(y + 2*j + 1) * DV_WIDTH/2
+					+ img_cb[(y + 2*j + 1) * DV_WIDTH/2
 						+ x / 2 + i]) >> 1;
 
 				if (dv_enc->clamp_luma == TRUE) {
@@ -1449,36 +1756,36 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 		for (j = 0; j < 8; j++) {
 			for (i = 0; i < 8; i++) {
 				bl[0].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + j) * DV_WIDTH +  x + i];
+					img_y[(y + j) * DV_WIDTH +  x + i];
 				bl[1].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + j) * DV_WIDTH +  x + 8 + i];
+					img_y[(y + j) * DV_WIDTH +  x + 8 + i];
 				bl[2].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + 8 + j) * DV_WIDTH + x + i];
+					img_y[(y + 8 + j) * DV_WIDTH + x + i];
 				bl[3].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + 8 + j) * DV_WIDTH 
+					img_y[(y + 8 + j) * DV_WIDTH 
 					     + x + 8 + i];
 			}
 
 			for (i = 0; i < 4; i++) {
 				bl[4].coeffs[8 * i + j] = 
-					(dv_enc->img_cr[(y + j) * DV_WIDTH/2
+					(img_cr[(y + j) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cr[(y + j) * DV_WIDTH/2 
+					 + img_cr[(y + j) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 				bl[5].coeffs[8 * i + j] = 
-					(dv_enc->img_cb[(y + j) * DV_WIDTH/2
+					(img_cb[(y + j) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cb[(y + j) * DV_WIDTH/2 
+					 + img_cb[(y + j) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 				bl[4].coeffs[8 * (i + 4) + j] = 
-					(dv_enc->img_cr[(y + j + 8) * DV_WIDTH/2
+					(img_cr[(y + j + 8) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cr[(y + j + 8) * DV_WIDTH/2 
+					 + img_cr[(y + j + 8) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 				bl[5].coeffs[8 * (i + 4) + j] = 
-					(dv_enc->img_cb[(y + j + 8) * DV_WIDTH/2
+					(img_cb[(y + j + 8) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cb[(y + j + 8) * DV_WIDTH/2 
+					 + img_cb[(y + j + 8) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 			}
 			for (i = 0; i < 8; i++) {
@@ -1499,22 +1806,22 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 		for (j = 0; j < 8; j++) {
 			for (i = 0; i < 8; i++) {
 				bl[0].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + j) * DV_WIDTH +  x + i];
+					img_y[(y + j) * DV_WIDTH +  x + i];
 				bl[1].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + j) * DV_WIDTH +  x + 8 + i];
+					img_y[(y + j) * DV_WIDTH +  x + 8 + i];
 				bl[2].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + j) * DV_WIDTH + x + 16 + i];
+					img_y[(y + j) * DV_WIDTH + x + 16 + i];
 				bl[3].coeffs[8 * i + j] = 
-					dv_enc->img_y[(y + j) * DV_WIDTH + x + 24 + i];
+					img_y[(y + j) * DV_WIDTH + x + 24 + i];
 				bl[4].coeffs[8 * i + j] = 
-					(dv_enc->img_cr[(y + j) * DV_WIDTH/2
+					(img_cr[(y + j) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cr[(y + j) * DV_WIDTH/2 
+					 + img_cr[(y + j) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 				bl[5].coeffs[8 * i + j] = 
-					(dv_enc->img_cb[(y + j) * DV_WIDTH/2
+					(img_cb[(y + j) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cb[(y + j) * DV_WIDTH/2 
+					 + img_cb[(y + j) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 
 				if (dv_enc->clamp_luma == TRUE) {
@@ -1535,7 +1842,7 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = dv_enc->force_dct;
 		}
-	} else {
+	} else if (!choose_dct_modes(bl, 1)) {
 		int b;
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = need_dct_248_transposed(bl[b].coeffs) 
@@ -1545,19 +1852,20 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 #elif ARCH_X86
 	int b;
 	int need_dct_248_rows[6];
+	int vec = 0;
 
 	if (dv_enc->isPAL) { /* PAL or rightmost NTSC block */
-		short* start_y = dv_enc->img_y + y * DV_WIDTH + x;
+		short* start_y = img_y + y * DV_WIDTH + x;
 		_dv_ppm_copy_y_block_mmx(bl[0].coeffs, start_y);
 		_dv_ppm_copy_y_block_mmx(bl[1].coeffs, start_y + 8);
 		_dv_ppm_copy_y_block_mmx(bl[2].coeffs, start_y + 8 * DV_WIDTH);
 		_dv_ppm_copy_y_block_mmx(bl[3].coeffs, start_y + 8 * DV_WIDTH + 8);
 		_dv_ppm_copy_pal_c_block_mmx(bl[4].coeffs,
-					 dv_enc->img_cr+y * DV_WIDTH/2+ x/2);
+					 img_cr+y * DV_WIDTH/2+ x/2);
 		_dv_ppm_copy_pal_c_block_mmx(bl[5].coeffs,
-					 dv_enc->img_cb+y * DV_WIDTH/2+ x/2);
+					 img_cb+y * DV_WIDTH/2+ x/2);
 	} else if (x == DV_WIDTH- 16) { /* rightmost NTSC block */
-		short* start_y = dv_enc->img_y + y * DV_WIDTH + x;
+		short* start_y = img_y + y * DV_WIDTH + x;
 		int i,j;
 
 		_dv_ppm_copy_y_block_mmx(bl[0].coeffs, start_y);
@@ -1568,37 +1876,37 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 		for (j = 0; j < 8; j++) {
 			for (i = 0; i < 4; i++) {
 				bl[4].coeffs[8 * j + i] = 
-					(dv_enc->img_cr[(y + j) * DV_WIDTH/2
+					(img_cr[(y + j) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cr[(y + j) * DV_WIDTH/2 
+					 + img_cr[(y + j) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 				bl[5].coeffs[8 * j + i] = 
-					(dv_enc->img_cb[(y + j) * DV_WIDTH/2
+					(img_cb[(y + j) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cb[(y + j) * DV_WIDTH/2 
+					 + img_cb[(y + j) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 				bl[4].coeffs[8 * j + i + 4] = 
-					(dv_enc->img_cr[(y + j + 8) * DV_WIDTH/2
+					(img_cr[(y + j + 8) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cr[(y + j + 8) * DV_WIDTH/2 
+					 + img_cr[(y + j + 8) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 				bl[5].coeffs[8 * j + i + 4] = 
-					(dv_enc->img_cb[(y + j + 8) * DV_WIDTH/2
+					(img_cb[(y + j + 8) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cb[(y + j + 8) * DV_WIDTH/2 
+					 + img_cb[(y + j + 8) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 			}
 		}
 	} else {                              /* NTSC */
-		short* start_y = dv_enc->img_y + y * DV_WIDTH + x;
+		short* start_y = img_y + y * DV_WIDTH + x;
 		_dv_ppm_copy_y_block_mmx(bl[0].coeffs, start_y);
 		_dv_ppm_copy_y_block_mmx(bl[1].coeffs, start_y + 8);
 		_dv_ppm_copy_y_block_mmx(bl[2].coeffs, start_y + 16);
 		_dv_ppm_copy_y_block_mmx(bl[3].coeffs, start_y + 24);
 		_dv_ppm_copy_ntsc_c_block_mmx(bl[4].coeffs,
-					  dv_enc->img_cr + y*DV_WIDTH/2 + x/2);
+					  img_cr + y*DV_WIDTH/2 + x/2);
 		_dv_ppm_copy_ntsc_c_block_mmx(bl[5].coeffs,
-					  dv_enc->img_cb + y*DV_WIDTH/2 + x/2);
+					  img_cb + y*DV_WIDTH/2 + x/2);
 	}
 
 	
@@ -1607,7 +1915,7 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = dv_enc->force_dct;
 		}
-	} else {
+	} else if (!(vec = choose_dct_modes(bl, 0))) {
 		for (b = 0; b < 6; b++) {
 			need_dct_248_rows[b]
 				= _dv_need_dct_248_mmx_rows(bl[b].coeffs) + 1;
@@ -1620,7 +1928,7 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 	_dv_transpose_mmx(bl[4].coeffs);
 	_dv_transpose_mmx(bl[5].coeffs);
 
-	if (dv_enc->force_dct == -1) {
+	if (dv_enc->force_dct == -1 && !vec) {
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = 
 				((need_dct_248_rows[b] * 65536 / 
@@ -1633,19 +1941,20 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 #else
 	int b;
 	int need_dct_248_rows[6];
+	int vec = 0;
 
 	if (dv_enc->isPAL) { /* PAL or rightmost NTSC block */
-		short* start_y = dv_enc->img_y + y * DV_WIDTH + x;
+		short* start_y = img_y + y * DV_WIDTH + x;
 		_dv_ppm_copy_y_block_mmx_x86_64(bl[0].coeffs, start_y);
 		_dv_ppm_copy_y_block_mmx_x86_64(bl[1].coeffs, start_y + 8);
 		_dv_ppm_copy_y_block_mmx_x86_64(bl[2].coeffs, start_y + 8 * DV_WIDTH);
 		_dv_ppm_copy_y_block_mmx_x86_64(bl[3].coeffs, start_y + 8 * DV_WIDTH + 8);
 		_dv_ppm_copy_pal_c_block_mmx_x86_64(bl[4].coeffs,
-					 dv_enc->img_cr+y * DV_WIDTH/2+ x/2);
+					 img_cr+y * DV_WIDTH/2+ x/2);
 		_dv_ppm_copy_pal_c_block_mmx_x86_64(bl[5].coeffs,
-					 dv_enc->img_cb+y * DV_WIDTH/2+ x/2);
+					 img_cb+y * DV_WIDTH/2+ x/2);
 	} else if (x == DV_WIDTH- 16) { /* rightmost NTSC block */
-		short* start_y = dv_enc->img_y + y * DV_WIDTH + x;
+		short* start_y = img_y + y * DV_WIDTH + x;
 		int i,j;
 
 		_dv_ppm_copy_y_block_mmx_x86_64(bl[0].coeffs, start_y);
@@ -1656,37 +1965,37 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 		for (j = 0; j < 8; j++) {
 			for (i = 0; i < 4; i++) {
 				bl[4].coeffs[8 * j + i] = 
-					(dv_enc->img_cr[(y + j) * DV_WIDTH/2
+					(img_cr[(y + j) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cr[(y + j) * DV_WIDTH/2 
+					 + img_cr[(y + j) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 				bl[5].coeffs[8 * j + i] = 
-					(dv_enc->img_cb[(y + j) * DV_WIDTH/2
+					(img_cb[(y + j) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cb[(y + j) * DV_WIDTH/2 
+					 + img_cb[(y + j) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 				bl[4].coeffs[8 * j + i + 4] = 
-					(dv_enc->img_cr[(y + j + 8) * DV_WIDTH/2
+					(img_cr[(y + j + 8) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cr[(y + j + 8) * DV_WIDTH/2 
+					 + img_cr[(y + j + 8) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 				bl[5].coeffs[8 * j + i + 4] = 
-					(dv_enc->img_cb[(y + j + 8) * DV_WIDTH/2
+					(img_cb[(y + j + 8) * DV_WIDTH/2
 					       + x / 2 + i*2]
-					 + dv_enc->img_cb[(y + j + 8) * DV_WIDTH/2 
+					 + img_cb[(y + j + 8) * DV_WIDTH/2 
 						 + x / 2 + 1 + i*2]) >> 1;
 			}
 		}
 	} else {                              /* NTSC */
-		short* start_y = dv_enc->img_y + y * DV_WIDTH + x;
+		short* start_y = img_y + y * DV_WIDTH + x;
 		_dv_ppm_copy_y_block_mmx_x86_64(bl[0].coeffs, start_y);
 		_dv_ppm_copy_y_block_mmx_x86_64(bl[1].coeffs, start_y + 8);
 		_dv_ppm_copy_y_block_mmx_x86_64(bl[2].coeffs, start_y + 16);
 		_dv_ppm_copy_y_block_mmx_x86_64(bl[3].coeffs, start_y + 24);
 		_dv_ppm_copy_ntsc_c_block_mmx_x86_64(bl[4].coeffs,
-					  dv_enc->img_cr + y*DV_WIDTH/2 + x/2);
+					  img_cr + y*DV_WIDTH/2 + x/2);
 		_dv_ppm_copy_ntsc_c_block_mmx_x86_64(bl[5].coeffs,
-					  dv_enc->img_cb + y*DV_WIDTH/2 + x/2);
+					  img_cb + y*DV_WIDTH/2 + x/2);
 	}
 
 	
@@ -1695,7 +2004,7 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = dv_enc->force_dct;
 		}
-	} else {
+	} else if (!(vec = choose_dct_modes(bl, 0))) {
 		for (b = 0; b < 6; b++) {
 			need_dct_248_rows[b]
 				= _dv_need_dct_248_mmx_x86_64_rows(bl[b].coeffs) + 1;
@@ -1708,7 +2017,7 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 	_dv_transpose_mmx_x86_64(bl[4].coeffs);
 	_dv_transpose_mmx_x86_64(bl[5].coeffs);
 
-	if (dv_enc->force_dct == -1) {
+	if (dv_enc->force_dct == -1 && !vec) {
 		for (b = 0; b < 6; b++) {
 			bl[b].dct_mode = 
 				((need_dct_248_rows[b] * 65536 / 
@@ -1720,3 +2029,359 @@ void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
 	emms();
 #endif
 }
+
+/* n 8 bit samples to the signed fixed point of the img_* planes */
+static inline void widen_samples(const uint8_t *src, short *dst, int n)
+{
+	int i = 0;
+
+#if ENC_INPUT_VECTOR
+	for (; i + 8 <= n; i += 8) {
+		enc_in_v8b b;
+		enc_in_v8 v;
+
+		memcpy(&b, src + i, sizeof(b));
+		v = (__builtin_convertvector(b, enc_in_v8) - 128) 
+			<< DCT_YUV_PRECISION;
+		memcpy(dst + i, &v, sizeof(v));
+	}
+#endif
+	for (; i < n; i++) {
+		dst[i] = (((short) src[i]) - 128) << DCT_YUV_PRECISION;
+	}
+}
+
+/* n pairs of interleaved 8 bit samples, e.g. the CbCr plane of NV12 */
+static inline void split_samples(const uint8_t *src, short *even, 
+				 short *odd, int n)
+{
+	int i = 0;
+
+#if ENC_INPUT_VECTOR
+	for (; i + 8 <= n; i += 8) {
+		enc_in_v8u q;
+		enc_in_v8 lo, hi;
+
+		memcpy(&q, src + 2 * i, sizeof(q));
+		lo = (enc_in_v8) (q & 0xff);
+		hi = (enc_in_v8) (q >> 8);
+#if (BYTE_ORDER == BIG_ENDIAN)
+		{ enc_in_v8 t = lo; lo = hi; hi = t; }
+#endif
+		lo = (lo - 128) << DCT_YUV_PRECISION;
+		hi = (hi - 128) << DCT_YUV_PRECISION;
+		memcpy(even + i, &lo, sizeof(lo));
+		memcpy(odd + i, &hi, sizeof(hi));
+	}
+#endif
+	for (; i < n; i++) {
+		even[i] = (((short) src[2*i]) - 128) << DCT_YUV_PRECISION;
+		odd[i]  = (((short) src[2*i+1]) - 128) << DCT_YUV_PRECISION;
+	}
+}
+
+/* n pixels of YUY2 */
+static inline void yuy2_to_ycb_span(const uint8_t *src, short *ty, 
+				    short *tcb, short *tcr, int n)
+{
+	int i = 0;
+
+#if ENC_INPUT_VECTOR
+	for (; i + 16 <= n; i += 16) {
+		enc_in_v8u q[2];
+		enc_in_v8 y0, y1, c0, c1, cb, cr;
+
+		memcpy(q, src + 2 * i, sizeof(q));
+#if (BYTE_ORDER == BIG_ENDIAN)
+		y0 = (enc_in_v8) (q[0] >> 8);
+		y1 = (enc_in_v8) (q[1] >> 8);
+		c0 = (enc_in_v8) (q[0] & 0xff);
+		c1 = (enc_in_v8) (q[1] & 0xff);
+#else
+		y0 = (enc_in_v8) (q[0] & 0xff);
+		y1 = (enc_in_v8) (q[1] & 0xff);
+		c0 = (enc_in_v8) (q[0] >> 8);
+		c1 = (enc_in_v8) (q[1] >> 8);
+#endif
+		cb = DV_SHUFFLE(c0, c1, enc_in_v8, ENC_IN_EVEN);
+		cr = DV_SHUFFLE(c0, c1, enc_in_v8, ENC_IN_ODD);
+		y0 = (y0 - 128) << DCT_YUV_PRECISION;
+		y1 = (y1 - 128) << DCT_YUV_PRECISION;
+		cb = (cb - 128) << DCT_YUV_PRECISION;
+		cr = (cr - 128) << DCT_YUV_PRECISION;
+		memcpy(ty + i, &y0, sizeof(y0));
+		memcpy(ty + i + 8, &y1, sizeof(y1));
+		memcpy(tcb + i / 2, &cb, sizeof(cb));
+		memcpy(tcr + i / 2, &cr, sizeof(cr));
+	}
+#endif
+	for (; i < n; i += 2) {
+		const uint8_t *p = src + 2 * i;
+		ty[i]       = (((short) p[0]) - 128) << DCT_YUV_PRECISION;
+		tcb[i / 2]  = (((short) p[1]) - 128) << DCT_YUV_PRECISION;
+		ty[i + 1]   = (((short) p[2]) - 128) << DCT_YUV_PRECISION;
+		tcr[i / 2]  = (((short) p[3]) - 128) << DCT_YUV_PRECISION;
+	}
+}
+
+/* Converts the part of the caller's frame (dv_enc->in) that lies under
+ * lines y..y+h-1 and columns x..x+w-1, and applies the NTSC setup
+ * removal and the clamping of dv_encode_full_frame() to it.  The tile
+ * is laid out like img_y/img_cr/img_cb with line y as its first line,
+ * so ycb_fill_macroblock() can read it as it reads those.  4:2:0
+ * chroma lines serve both frame lines they cover; the 4:1:1
+ * decimation for NTSC happens in ycb_fill_macroblock(). */
+static void ycb_convert_tile(dv_encoder_t *dv_enc, int x, int y, int w,
+			     int h, short *tile_y, short *tile_cr,
+			     short *tile_cb)
+{
+	uint8_t **in = dv_enc->in;
+	int *pitches = dv_enc->in_pitches;
+	int i, j;
+
+	for (j = 0; j < h; j++) {
+		int line = y + j;
+		uint8_t *row = in[0] + line * pitches[0];
+		short *py = tile_y + j * DV_WIDTH + x;
+		short *pcr = tile_cr + j * DV_WIDTH / 2 + x / 2;
+		short *pcb = tile_cb + j * DV_WIDTH / 2 + x / 2;
+
+		switch (dv_enc->in_color_space) {
+		case e_dv_color_rgb:
+		case e_dv_color_bgr0:
+		case e_dv_color_rgba:
+		{
+			int bpp = (dv_enc->in_color_space == e_dv_color_rgb)
+				? 3 : 4;
+			int ro = (dv_enc->in_color_space == e_dv_color_bgr0)
+				? 2 : 0;
+			uint8_t *prev = NULL;
+
+			if (x > 0) {
+				prev = row + bpp * (x - 1);
+			} else if (line > 0) {
+				prev = row - pitches[0] + bpp * (DV_WIDTH - 1);
+			}
+			rgb_to_ycb_span(row + bpp * x, prev, w, bpp, ro, 
+					py, pcr, pcb);
+			break;
+		}
+		case e_dv_color_i420:
+			widen_samples(row + x, py, w);
+			widen_samples(in[1] + (line / 2) * pitches[1] + x / 2,
+				      pcb, w / 2);
+			widen_samples(in[2] + (line / 2) * pitches[2] + x / 2,
+				      pcr, w / 2);
+			break;
+		case e_dv_color_nv12:
+			widen_samples(row + x, py, w);
+			split_samples(in[1] + (line / 2) * pitches[1] + x,
+				      pcb, pcr, w / 2);
+			break;
+		case e_dv_color_yv16:
+			widen_samples(row + x, py, w);
+			widen_samples(in[1] + line * pitches[1] + x / 2, 
+				      pcr, w / 2);
+			widen_samples(in[2] + line * pitches[2] + x / 2, 
+				      pcb, w / 2);
+			break;
+		default:
+			yuy2_to_ycb_span(row + 2 * x, py, pcb, pcr, w);
+			break;
+		}
+
+		if (dv_enc->isPAL == FALSE && dv_enc->rem_ntsc_setup == TRUE) {
+			for (i = 0; i < w; i++) {
+				py[i] -= 32;
+			}
+		}
+		/* -224 = (16-128)*2, 214 = (235-128)*2, 224 = (240-128)*2 */
+		if (dv_enc->clamp_luma == TRUE) {
+			for (i = 0; i < w; i++) {
+				py[i] = CLAMP(py[i], -224, 214);
+			}
+		}
+		if (dv_enc->clamp_chroma == TRUE) {
+			for (i = 0; i < w / 2; i++) {
+				pcr[i] = CLAMP(pcr[i], -224, 224);
+				pcb[i] = CLAMP(pcb[i], -224, 224);
+			}
+		}
+	}
+#if ARCH_X86 || ARCH_X86_64
+	emms();
+#endif
+}
+
+/* bytes per pixel of the first input plane */
+static int input_bpp(dv_color_space_t color_space)
+{
+	switch (color_space) {
+	case e_dv_color_rgb:
+		return 3;
+	case e_dv_color_bgr0:
+	case e_dv_color_rgba:
+		return 4;
+	case e_dv_color_yuv:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+/* Starts loading the input under a macroblock into the cache.  The
+ * macroblocks of a video segment are spread over the whole picture,
+ * so the hardware prefetcher cannot guess these reads. */
+void _dv_ycb_prefetch_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb)
+{
+#if defined(__GNUC__)
+	int w = 16, h = 16, bpp = input_bpp(dv_enc->in_color_space), j;
+
+	if (!dv_enc->in) {
+		return;
+	}
+	if (!dv_enc->isPAL && mb->x != DV_WIDTH - 16) {
+		w = 32;
+		h = 8;
+	}
+	for (j = 0; j < h; j++) {
+		int line = mb->y + j;
+		uint8_t *p = dv_enc->in[0] + line * dv_enc->in_pitches[0]
+			+ mb->x * bpp;
+
+		__builtin_prefetch(p);
+		__builtin_prefetch(p + w * bpp - 1);
+		switch (dv_enc->in_color_space) {
+		case e_dv_color_i420:
+			if (!(line & 1)) {
+				__builtin_prefetch(dv_enc->in[1] + (line / 2) 
+					* dv_enc->in_pitches[1] + mb->x / 2);
+				__builtin_prefetch(dv_enc->in[2] + (line / 2) 
+					* dv_enc->in_pitches[2] + mb->x / 2);
+			}
+			break;
+		case e_dv_color_nv12:
+			if (!(line & 1)) {
+				__builtin_prefetch(dv_enc->in[1] + (line / 2) 
+					* dv_enc->in_pitches[1] + mb->x);
+			}
+			break;
+		case e_dv_color_yv16:
+			__builtin_prefetch(dv_enc->in[1] + line 
+					   * dv_enc->in_pitches[1] + mb->x / 2);
+			__builtin_prefetch(dv_enc->in[2] + line 
+					   * dv_enc->in_pitches[2] + mb->x / 2);
+			break;
+		default:
+			break;
+		}
+	}
+#endif
+}
+
+/* Mixes n bytes into a running checksum, eight at a time */
+static inline uint64_t sum_bytes(uint64_t sum, const uint8_t *p, int n)
+{
+	uint64_t v;
+	int i;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		memcpy(&v, p + i, sizeof(v));
+		sum = (sum ^ v) * 0x9e3779b97f4a7c15ULL;
+		sum ^= sum >> 32;
+	}
+	for (; i < n; i++) {
+		sum = (sum ^ p[i]) * 0x100000001b3ULL;
+	}
+	return sum;
+}
+
+/* Mixes every input byte that goes into a macroblock into sum.  Used by
+ * the skip_static mode of dv_encode_full_frame() to spot video segments
+ * whose input did not change. */
+uint64_t _dv_ycb_checksum_macroblock(dv_encoder_t *dv_enc, 
+				     dv_macroblock_t *mb, uint64_t sum)
+{
+	uint8_t **in = dv_enc->in;
+	int *pitches = dv_enc->in_pitches;
+	int w = 16, h = 16, bpp = input_bpp(dv_enc->in_color_space), j;
+	int x = mb->x;
+
+	if (!dv_enc->isPAL && x != DV_WIDTH - 16) {
+		w = 32;
+		h = 8;
+	}
+	for (j = 0; j < h; j++) {
+		int line = mb->y + j;
+		uint8_t *row = in[0] + line * pitches[0];
+
+		switch (dv_enc->in_color_space) {
+		case e_dv_color_rgb:
+		case e_dv_color_bgr0:
+		case e_dv_color_rgba:
+			/* the C conversion also takes in the pixel before */
+			if (x > 0) {
+				sum = sum_bytes(sum, row + bpp * (x - 1), 
+						bpp * (w + 1));
+				break;
+			}
+			if (line > 0) {
+				sum = sum_bytes(sum, row - pitches[0] 
+						+ bpp * (DV_WIDTH - 1), bpp);
+			}
+			sum = sum_bytes(sum, row, bpp * w);
+			break;
+		case e_dv_color_i420:
+			sum = sum_bytes(sum, row + x, w);
+			if (!(line & 1)) {
+				sum = sum_bytes(sum, in[1] + (line / 2) 
+						* pitches[1] + x / 2, w / 2);
+				sum = sum_bytes(sum, in[2] + (line / 2) 
+						* pitches[2] + x / 2, w / 2);
+			}
+			break;
+		case e_dv_color_nv12:
+			sum = sum_bytes(sum, row + x, w);
+			if (!(line & 1)) {
+				sum = sum_bytes(sum, in[1] + (line / 2) 
+						* pitches[1] + x, w);
+			}
+			break;
+		case e_dv_color_yv16:
+			sum = sum_bytes(sum, row + x, w);
+			sum = sum_bytes(sum, in[1] + line * pitches[1] + x / 2, 
+					w / 2);
+			sum = sum_bytes(sum, in[2] + line * pitches[2] + x / 2, 
+					w / 2);
+			break;
+		default:
+			sum = sum_bytes(sum, row + 2 * x, 2 * w);
+			break;
+		}
+	}
+	return sum;
+}
+
+/* Fills the blocks of a macroblock, either straight from the frame
+ * dv_encode_full_frame() is working on, converted in the tile of the
+ * calling thread, or from the img_* planes. */
+void _dv_ycb_fill_macroblock(dv_encoder_t *dv_enc, dv_macroblock_t *mb,
+			     dv_enc_tile_t *tile)
+{
+	if (dv_enc->in) {
+		int w = 16, h = 16;
+
+		if (!dv_enc->isPAL && mb->x != DV_WIDTH - 16) {
+			w = 32;
+			h = 8;
+		}
+		ycb_convert_tile(dv_enc, mb->x, mb->y, w, h, 
+				 tile->y, tile->cr, tile->cb);
+		ycb_fill_macroblock(dv_enc, mb->b, mb->x, 0, 
+				    tile->y, tile->cr, tile->cb);
+	} else {
+		ycb_fill_macroblock(dv_enc, mb->b, mb->x, mb->y, 
+				    dv_enc->img_y, dv_enc->img_cr, 
+				    dv_enc->img_cb);
+	}
+}
@@ -43,14 +43,34 @@ extern "C" {
 		void (*fill_macroblock)(dv_macroblock_t *mb, int isPAL);
 
 		const char* filter_name;
+
+		/* optional, used by the pipelined dv_encoder_loop():
+		   read() only reads a frame into a buffer of frame_size
+		   bytes, convert() turns such a buffer into the planes
+		   of an encoder.  convert() runs concurrently for
+		   different frames. */
+		int frame_size;
+		int (*read)(const char* filename, int * isPAL, 
+			    unsigned char * buf);
+		void (*convert)(unsigned char * buf, int isPAL,
+				dv_encoder_t * enc);
 	} dv_enc_input_filter_t;
 
 	extern void dv_enc_rgb_to_ycb(unsigned char* img_rgb, int height,
 		       short* img_y, short* img_cr, short* img_cb);
+	extern void dv_enc_bgr0_to_ycb(unsigned char* img_bgr0, int height,
+		       short* img_y, short* img_cr, short* img_cb);
+	extern void dv_enc_rgba_to_ycb(unsigned char* img_rgba, int height,
+		       short* img_y, short* img_cr, short* img_cb);
 	extern void dv_enc_register_input_filter(dv_enc_input_filter_t filter);
 	extern int dv_enc_get_input_filters(dv_enc_input_filter_t ** filters,
 					    int * count);
-	extern void _dv_ycb_fill_macroblock(dv_encoder_t *dv, dv_macroblock_t *mb);
+	extern void _dv_ycb_fill_macroblock(dv_encoder_t *dv, dv_macroblock_t *mb,
+					    struct dv_enc_tile_s *tile);
+	extern void _dv_ycb_prefetch_macroblock(dv_encoder_t *dv, dv_macroblock_t *mb);
+	extern uint64_t _dv_ycb_checksum_macroblock(dv_encoder_t *dv, 
+						    dv_macroblock_t *mb,
+						    uint64_t sum);
 
 #ifdef __cplusplus
 }
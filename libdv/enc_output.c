@@ -34,6 +34,7 @@
 #include "enc_audio_input.h"
 #include "enc_output.h"
 #include "headers.h"
+#include "tables.h"
 
 FILE* out_fp = NULL;
 
@@ -47,92 +48,118 @@ static void raw_finish()
 {
 }
 
-static int dv_audio_unshuffle_60[5][9] = {
-  { 0, 15, 30, 10, 25, 40,  5, 20, 35 },
-  { 3, 18, 33, 13, 28, 43,  8, 23, 38 },
-  { 6, 21, 36,  1, 16, 31, 11, 26, 41 },
-  { 9, 24, 39,  4, 19, 34, 14, 29, 44 },
-  {12, 27, 42,  7, 22, 37,  2, 17, 32 },
-};
-
-static int dv_audio_unshuffle_50[6][9] = {
-  {  0, 18, 36, 13, 31, 49,  8, 26, 44 },
-  {  3, 21, 39, 16, 34, 52, 11, 29, 47 },
-  {  6, 24, 42,  1, 19, 37, 14, 32, 50 }, 
-  {  9, 27, 45,  4, 22, 40, 17, 35, 53 }, 
-  { 12, 30, 48,  7, 25, 43,  2, 20, 38 },
-  { 15, 33, 51, 10, 28, 46,  5, 23, 41 },
-};
-
-static void put_16_bit(unsigned char * target, unsigned char* wave_buf,
-		dv_enc_audio_info_t * audio, int dif_seg, int isPAL,
-		int channel)
+/* The 16 bit samples of one channel for the audio DIF blocks of one
+ * DIF sequence.  The samples of a block are gathered first, so the
+ * conversion to big endian runs over a plain array. */
+static void put_16_bit(unsigned char * target, const int16_t * samples,
+		       const uint16_t (* shuffle)[36])
 {
-	int bp;
-	int audio_dif;
-	unsigned char* p = target;
+	int audio_dif, n;
+	uint16_t block[36];
 
-	if (isPAL) {
-		for (audio_dif = 0; audio_dif < 9; audio_dif++) {
-			for (bp = 8; bp < 80; bp += 2) {
-				int i = dv_audio_unshuffle_50[dif_seg]
-					[audio_dif] + (bp - 8)/2 * 54;
-				p[bp] = wave_buf[
-					audio->bytealignment * i
-					+ 2*channel];
-				p[bp + 1] = wave_buf[
-					audio->bytealignment * i + 1
-					+ 2*channel];
-				if (p[bp] == 0x80 && p[bp+1] == 0x00) {
-					p[bp+1] = 0x01;
-				}
-			}
-			p += 16 * 80;
+	for (audio_dif = 0; audio_dif < 9; audio_dif++) {
+		const uint16_t * idx = shuffle[audio_dif];
+		unsigned char * p = target + 8;
+
+		for (n = 0; n < 36; n++) {
+			block[n] = samples[idx[n]];
 		}
-	} else {
-		for (audio_dif = 0; audio_dif < 9; audio_dif++) {
-			for (bp = 8; bp < 80; bp += 2) {
-				int i = dv_audio_unshuffle_60[dif_seg]
-					[audio_dif] + (bp - 8)/2 * 45;
-				p[bp] = wave_buf[
-					audio->bytealignment * i
-					+ 2*channel];
-				p[bp + 1] = wave_buf[
-					audio->bytealignment * i + 1
-					+ 2*channel];
-				if (p[bp] == 0x80 && p[bp+1] == 0x00) {
-					p[bp+1] = 0x01;
-				}
-			}
-			p += 16 * 80;
+		for (n = 0; n < 36; n++) {
+			/* 0x8000 marks a bad sample */
+			uint16_t v = block[n] + (block[n] == 0x8000);
+
+			p[2 * n] = v >> 8;
+			p[2 * n + 1] = v;
 		}
+		target += 16 * 80;
 	}
 }
 
+/* A 16 bit sample as 12 bit nonlinear code, see IEC 61834-2 figure 16.
+ * Negative samples are coded as the one's complement of their
+ * magnitude, which is the inverse of dv_upsample() in audio.c */
+static inline int to_12_bit(int x)
+{
+	int neg = x < 0;
+	int shift, s;
 
-int _dv_raw_insert_audio(unsigned char * frame_buf, 
-		     dv_enc_audio_info_t * audio, int isPAL)
+	if (neg) {
+		x = ~x;
+	}
+	shift = _dv_audio_12bit_shift[x >> 8];
+	s = (x >> shift) + 256 * shift;
+	if (neg) {
+		s = ~s;
+		if (s == -2048) { /* 0x800 marks a bad sample */
+			s = -2047;
+		}
+	}
+	return s & 0xfff;
+}
+
+/* The 12 bit samples of a channel pair for the audio DIF blocks of one
+ * DIF sequence: two samples in three bytes, see IEC 61834-2 figure 18 */
+static void put_12_bit(unsigned char * target, const int16_t * y,
+		       const int16_t * z, const uint16_t (* shuffle)[36])
+{
+	int audio_dif, n;
+
+	for (audio_dif = 0; audio_dif < 9; audio_dif++) {
+		const uint16_t * idx = shuffle[audio_dif];
+		unsigned char * p = target + 8;
+
+		for (n = 0; n < 24; n++) {
+			int ys = to_12_bit(y[idx[n]]);
+			int zs = to_12_bit(z[idx[n]]);
+
+			p[3 * n] = ys >> 4;
+			p[3 * n + 1] = zs >> 4;
+			p[3 * n + 2] = ((ys & 0xf) << 4) | (zs & 0xf);
+		}
+		target += 16 * 80;
+	}
+}
+
+/* Writes the AAUX packs and the samples of one frame.  pcm holds one
+ * buffer of DV_AUDIO_MAX_SAMPLES samples per channel.  One or two
+ * channels are stored with 16 bits, a single channel going to both
+ * channels of the pair.  Three or four channels need 32 kHz and are
+ * stored with 12 bits, a missing fourth one being silent. */
+int _dv_insert_audio(unsigned char * frame_buf, 
+		     const int16_t * const * pcm, int channels, 
+		     int frequency, int samplesperframe, int isPAL)
 {
+	static const int16_t silence[DV_AUDIO_MAX_SAMPLES];
+	const int16_t * chan[4];
+	const uint16_t (* shuffle)[9][36];
 	int dif_seg;
 	int dif_seg_max = isPAL ? 12 : 10;
-	int samplesperframe = audio->bytesperframe/(2*audio->channels);
-	
 	int bits_per_sample = 16;
-	unsigned char* wave_buf = audio->data;
-
+	int i;
 	unsigned char head_50[5];
 	unsigned char head_51[5];
 	unsigned char head_52[5];
 	unsigned char head_53[5];
 
+	if (channels < 1 || channels > 4) {
+		fprintf(stderr, "libdv(%s): %d audio channels are not "
+			"supported\n", __FUNCTION__, channels);
+		return(-1);
+	}
+	if (channels > 2 && frequency != 32000) {
+		fprintf(stderr, "libdv(%s): %d audio channels need 32 kHz, "
+			"not %d Hz\n", __FUNCTION__, channels, frequency);
+		return(-1);
+	}
+
 	head_50[0] = 0x50;
 
 	if (isPAL) {
 		head_50[3] = /* stype = */ 0 | (/* isPAL */ 1 << 5)
 			| (/* ml */ 1 << 6) | (/* res */ 1 << 7);
-		switch(audio->frequency) {
+		switch(frequency) {
 		case 32000:
-			if (audio->channels == 2) {
+			if (channels <= 2) {
 				head_50[1] = (samplesperframe - 1264) 
 					| (1 << 6) | (/* unlocked = */ 1 << 7);
 				head_50[2] = /* audio_mode= */ 0 
@@ -181,9 +208,9 @@ int _dv_raw_insert_audio(unsigned char * frame_buf,
 	} else {
 		head_50[3] = /* stype = */ 0 | (/* isPAL */ 0 << 5)
 			| (/* ml */ 1 << 6) | (/* res */ 1 << 7);
-		switch(audio->frequency) {
+		switch(frequency) {
 		case 32000:
-			if (audio->channels == 2) {
+			if (channels <= 2) {
 				head_50[1] = (samplesperframe - 1053) 
 					| (1 << 6) | (/* unlocked = */ 1 << 7);
 				head_50[2] = /* audio_mode= */ 0 
@@ -254,10 +281,21 @@ int _dv_raw_insert_audio(unsigned char * frame_buf,
 	head_53[3] = frame_buf[5 * 80 + 48 + 3 * 5 + 3];
 	head_53[4] = frame_buf[5 * 80 + 48 + 3 * 5 + 4];
 
+	shuffle = isPAL ? _dv_audio_shuffle_50 : _dv_audio_shuffle_60;
+	for (i = 0; i < 4; i++) {
+		if (i < channels) {
+			chan[i] = pcm[i];
+		} else if (channels == 1) {
+			chan[i] = pcm[0];
+		} else {
+			chan[i] = silence;
+		}
+	}
+
 	for (dif_seg = 0; dif_seg < dif_seg_max; dif_seg++) {
 		int audio_dif;
 		unsigned char* target= frame_buf + dif_seg * 150 * 80 + 6 * 80;
-		int channel;
+		int pair;
 		int ds;
 
 		unsigned char* p = target + 3;
@@ -282,26 +320,51 @@ int _dv_raw_insert_audio(unsigned char * frame_buf,
 			p[2] |= 1;
 		}
 
-		switch(bits_per_sample) {
-		case 12:
-			fprintf(stderr, "Unsupported bits: 12\n FIXME!\n");
-			return(-1);
-		case 16:
-			ds = dif_seg;
-			if(ds < dif_seg_max/2) {
-				channel = 0;
-			} else {
-				channel = 1;
-				ds -= dif_seg_max / 2;
-			} 
-			put_16_bit(target, wave_buf,
-				   audio, ds, isPAL, channel);
-			break;
+		ds = dif_seg;
+		pair = 0;
+		if (ds >= dif_seg_max / 2) {
+			pair = 1;
+			ds -= dif_seg_max / 2;
+		}
+		if (bits_per_sample == 12) {
+			put_12_bit(target, chan[2 * pair], chan[2 * pair + 1],
+				   shuffle[ds]);
+		} else {
+			put_16_bit(target, chan[pair], shuffle[ds]);
 		}
 	}
 	return 0;
 }
 
+/* ---------------------------------------------------------------------------
+ * The same for big endian, interleaved samples as read by the audio
+ * input filters.
+ */
+int _dv_raw_insert_audio(unsigned char * frame_buf, 
+		     dv_enc_audio_info_t * audio, int isPAL)
+{
+	int16_t pcm[4][DV_AUDIO_MAX_SAMPLES];
+	const int16_t * chan[4];
+	int channels = audio->channels;
+	int c, i;
+
+	if (channels < 1 || channels > 4) {
+		fprintf(stderr, "libdv(%s): %d audio channels are not "
+			"supported\n", __FUNCTION__, channels);
+		return(-1);
+	}
+	for (c = 0; c < channels; c++) {
+		const unsigned char * p = audio->data + 2 * c;
+
+		for (i = 0; i < DV_AUDIO_MAX_SAMPLES; i++) {
+			pcm[c][i] = (p[0] << 8) | p[1];
+			p += audio->bytealignment;
+		}
+		chan[c] = pcm[c];
+	}
+	return _dv_insert_audio(frame_buf, chan, channels, audio->frequency,
+				audio->bytesperframe / (2 * channels), isPAL);
+}
 
 static int frame_counter = 0;
 
@@ -48,6 +48,9 @@ extern "C" {
 		const char* filter_name;
 	} dv_enc_output_filter_t;
 
+	extern int _dv_insert_audio(unsigned char * frame_buf, 
+		     const int16_t * const * pcm, int channels, 
+		     int frequency, int samplesperframe, int isPAL);
 	extern int _dv_raw_insert_audio(unsigned char * frame_buf, 
 		     dv_enc_audio_info_t * audio, int isPAL);
 
@@ -58,6 +58,8 @@
 #include "parse.h"
 #include "place.h"
 #include "headers.h"
+#include "tables.h"
+#include "util.h"
 #if ARCH_X86 || ARCH_X86_64
 #include "mmx.h"
 #endif
@@ -107,12 +109,67 @@ extern int     dv_super_map_horizontal[5];
 extern int    dv_parse_bit_start[6];
 extern int    dv_parse_bit_end[6];
 
-static long runs_used[15];
-static long cycles_used[15*5*6];
-static long classes_used[4];
-static long qnos_used[16];
-static long dct_used[2];
-static long vlc_overflows;
+/* Every encoding function takes a pointer to the statistics it adds
+ * to, so that threads never share mutable state; a NULL pointer skips
+ * the bookkeeping. */
+typedef dv_encoder_stats_t dv_enc_stats_t;
+
+/* dv_encoder_loop() drives the single set of encodedv filters */
+static dv_enc_stats_t loop_stats;
+
+static void stats_add(dv_enc_stats_t *dst, const dv_enc_stats_t *src)
+{
+	int i;
+
+	dst->frames += src->frames;
+	dst->segs_encoded += src->segs_encoded;
+	dst->segs_skipped += src->segs_skipped;
+	for (i = 0; i < 16; i++)
+		dst->runs_used[i] += src->runs_used[i];
+	for (i = 0; i < 15*5*6; i++)
+		dst->cycles_used[i] += src->cycles_used[i];
+	for (i = 0; i < 4; i++)
+		dst->classes_used[i] += src->classes_used[i];
+	for (i = 0; i < 16; i++)
+		dst->qnos_used[i] += src->qnos_used[i];
+	for (i = 0; i < 2; i++)
+		dst->dct_used[i] += src->dct_used[i];
+	dst->vlc_overflows += src->vlc_overflows;
+	dst->bits_used += src->bits_used;
+	dst->bits_budget += src->bits_budget;
+	for (i = 0; i < DV_ENC_NUM_STAGES; i++)
+		dst->stage_seconds[i] += src->stage_seconds[i];
+}
+
+static inline double enc_seconds(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Adds the time since *t to a stage and restarts the clock */
+static inline void stage_done(dv_enc_stats_t *stats, int stage, double *t)
+{
+	double now = enc_seconds();
+
+	if (*t > 0)
+		stats->stage_seconds[stage] += now - *t;
+	*t = now;
+}
+
+/* the AC bits of a segment against the room for them */
+static void count_segment_bits(dv_enc_stats_t *stats, 
+			       const dv_vlc_block_t *vlc_block)
+{
+	int b;
+
+	for (b = 0; b < 5*6; b++)
+		stats->bits_used += vlc_block[b].coeffs_bits;
+	stats->bits_budget += 5*(4*100+2*68);
+	stats->segs_encoded++;
+}
 
 static inline void
 dv_place_411_macroblock(dv_macroblock_t *mb) 
@@ -223,303 +280,222 @@ static inline unsigned int put_bits(unsigned char *s, unsigned int offset,
 #endif
 }
 
-typedef struct {
-	int8_t run;
-	int8_t amp;
-	uint16_t val;
-	uint8_t len;
-} dv_vlc_encode_t;
-
-static dv_vlc_encode_t dv_vlc_test_table[89] = {
-	{ 0, 1, 0x0, 2 },
-	{ 0, 2, 0x2, 3 },
-	{-1, 0, 0x6, 4 },
-	{ 1, 1, 0x7, 4 },
-	{ 0, 3, 0x8, 4 },
-	{ 0, 4, 0x9, 4 },
-	{ 2, 1, 0x14, 5 },
-	{ 1, 2, 0x15, 5 },
-	{ 0, 5, 0x16, 5 },
-	{ 0, 6, 0x17, 5 },
-	{ 3, 1, 0x30, 6 },
-	{ 4, 1, 0x31, 6 },
-	{ 0, 7, 0x32, 6 },
-	{ 0, 8, 0x33, 6 },
-	{ 5, 1,  0x68, 7 },
-	{ 6, 1,  0x69, 7 },
-	{ 2, 2,  0x6a, 7 },
-	{ 1, 3,  0x6b, 7 },
-	{ 1, 4,  0x6c, 7 },
-	{ 0, 9,  0x6d, 7 },
-	{ 0, 10, 0x6e, 7 },
-	{ 0, 11, 0x6f, 7 },
-	{ 7,  1,  0xe0, 8 },
-	{ 8,  1,  0xe1, 8 },
-	{ 9,  1,  0xe2, 8 },
-	{ 10, 1,  0xe3, 8 },
-	{ 3,  2,  0xe4, 8 },
-	{ 4,  2,  0xe5, 8 },
-	{ 2,  3,  0xe6, 8 },
-	{ 1,  5,  0xe7, 8 },
-	{ 1,  6,  0xe8, 8 },
-	{ 1,  7,  0xe9, 8 },
-	{ 0,  12, 0xea, 8 },
-	{ 0,  13, 0xeb, 8 },
-	{ 0,  14, 0xec, 8 },
-	{ 0,  15, 0xed, 8 },
-	{ 0,  16, 0xee, 8 },
-	{ 0,  17, 0xef, 8 },
-	{ 11, 1,  0x1e0, 9 },
-	{ 12, 1,  0x1e1, 9 },
-	{ 13, 1,  0x1e2, 9 },
-	{ 14, 1,  0x1e3, 9 },
-	{ 5,  2,  0x1e4, 9 },
-	{ 6,  2,  0x1e5, 9 },
-	{ 3,  3,  0x1e6, 9 },
-	{ 4,  3,  0x1e7, 9 },
-	{ 2,  4,  0x1e8, 9 },
-	{ 2,  5,  0x1e9, 9 },
-	{ 1,  8,  0x1ea, 9 },
-	{ 0,  18, 0x1eb, 9 },
-	{ 0,  19, 0x1ec, 9 },
-	{ 0,  20, 0x1ed, 9 },
-	{ 0,  21, 0x1ee, 9 },
-	{ 0,  22, 0x1ef, 9 },
-	{ 5, 3,  0x3e0, 10 },
-	{ 3, 4,  0x3e1, 10 },
-	{ 3, 5,  0x3e2, 10 },
-	{ 2, 6,  0x3e3, 10 },
-	{ 1, 9,  0x3e4, 10 },
-	{ 1, 10, 0x3e5, 10 },
-	{ 1, 11, 0x3e6, 10 },
-	{ 0, 0,  0x7ce, 11 },
-	{ 1, 0,  0x7cf, 11 },
-	{ 6, 3,  0x7d0, 11 },
-	{ 4, 4,  0x7d1, 11 },
-	{ 3, 6,  0x7d2, 11 },
-	{ 1, 12, 0x7d3, 11 },
-	{ 1, 13, 0x7d4, 11 },
-	{ 1, 14, 0x7d5, 11 },
-	{ 2, 0, 0xfac, 12 },
-	{ 3, 0, 0xfad, 12 },
-	{ 4, 0, 0xfae, 12 },
-	{ 5, 0, 0xfaf, 12 },
-	{ 7,  2,  0xfb0, 12 },
-	{ 8,  2,  0xfb1, 12 },
-	{ 9,  2,  0xfb2, 12 },
-	{ 10, 2,  0xfb3, 12 },
-	{ 7,  3,  0xfb4, 12 },
-	{ 8,  3,  0xfb5, 12 },
-	{ 4,  5,  0xfb6, 12 },
-	{ 3,  7,  0xfb7, 12 },
-	{ 2,  7,  0xfb8, 12 },
-	{ 2,  8,  0xfb9, 12 },
-	{ 2,  9,  0xfba, 12 },
-	{ 2,  10, 0xfbb, 12 },
-	{ 2,  11, 0xfbc, 12 },
-	{ 1,  15, 0xfbd, 12 },
-	{ 1,  16, 0xfbe, 12 },
-	{ 1,  17, 0xfbf, 12 },
-}; /* dv_vlc_test_table */
-
-static dv_vlc_encode_t * vlc_test_lookup[512];
-
-void _dv_init_vlc_test_lookup()
+/* The run/amp -> vlc codeword tables are built by gentables (see
+ * tables.h).  The assembler versions load the table addresses through
+ * these pointers. */
+const dv_vlc_entry_t * const vlc_encode_lookup = _dv_vlc_encode_table;
+const unsigned char  * const vlc_num_bits_lookup = _dv_vlc_num_bits_table;
+
+static inline void vlc_encode(int run, int amp, int sign, dv_vlc_entry_t * o)
 {
-	int i;
-	memset(vlc_test_lookup, 0, 512 * sizeof(dv_vlc_encode_t*));
-	for (i = 0; i < 89; i++) {
-		dv_vlc_encode_t *pvc = &dv_vlc_test_table[i];
-		vlc_test_lookup[((pvc->run + 1) << 5) + pvc->amp] = pvc;
-	}
+	const dv_vlc_entry_t * s= vlc_encode_lookup + 2 * ((amp + 255) | (run << 9));
+	*o++ = *s++;
+	*o = *s++ | (sign << 8);
 }
 
-static inline dv_vlc_encode_t * find_vlc_entry(int run, int amp)
+static inline unsigned long vlc_num_bits(int run, int amp)
 {
-	if (run > 14 || amp > 22) { /* run < -1 || amp < 0 never happens! */
-		return NULL;
-	} else {
-		return vlc_test_lookup[((run + 1) << 5) + amp];
-	}
+	return vlc_num_bits_lookup[(amp + 255) | (run << 9)];
 }
 
-static inline void vlc_encode_r(int run, int amp, int sign, dv_vlc_entry_t * o)
-{
-	dv_vlc_encode_t * hit = find_vlc_entry(run, amp);
+/* ---------------------------------------------------------------------------
+ * Block scans for classification and VLC bit counting.  With the
+ * vector extensions a block is read eight (AVX2: sixteen) coefficients
+ * at a time: classify() takes the largest AC magnitude in one sweep,
+ * and the bit counters build a mask of the nonzero coefficients and
+ * walk only its set bits, which yields the zero runs directly.  The
+ * results are those of the MMX and scalar code.
+ */
+#define ENC_VECTOR DV_VECTOR
 
-	if (hit != NULL) {
-		/* 1111110 */
-		int val, len;
-		val = hit->val;
-		len = hit->len;
-		if (amp != 0) {
-			val <<= 1;
-			val |= sign;
-			len++;
-		}
-		*o = set_dv_vlc(val, len);
-	} else {
-		if (amp == 0) {
-			/* 1111110 */
-			*o = set_dv_vlc((0x7e << 6) | run, 7+6);
-		} else {
-			/* 1111111 */
-			*o = set_dv_vlc((0x7f << 9) | (amp << 1) | sign,
-					7 + 8 + 1);
-		}
-	}
-}
+#if ENC_VECTOR
+
+typedef int16_t enc_v8 __attribute__ ((vector_size (16)));
 
-static inline dv_vlc_entry_t * vlc_encode_orig(int run, int amp, int sign, 
-					       dv_vlc_entry_t * o)
+#if ARCH_X86_64 || ARCH_X86
+#include <immintrin.h>
+
+typedef int16_t enc_v16 __attribute__ ((vector_size (32)));
+
+static __attribute__ ((target ("sse2"))) uint64_t 
+nonzero_mask_sse2(const dv_coeff_t *coeffs)
 {
-	dv_vlc_encode_t * hit = find_vlc_entry(run, amp);
+	uint64_t mask = 0;
+	int i;
 
-	if (hit != NULL) {
-		/* 1111110 */
-		int val, len;
-		val = hit->val;
-		len = hit->len;
-		if (amp != 0) {
-			val <<= 1;
-			val |= sign;
-			len++;
-		}
-		*o++ = 0;
-		*o = set_dv_vlc(val, len);
-	} else {
-		if (amp == 0) {
-			*o++ = 0;
-			if (run < 62) {
-				/* 1111110 */
-				*o = set_dv_vlc((0x7e << 6) | run, 7+6);
-			} else {
-				*o = set_dv_vlc((0x7cf << 13) 
-						| (0x7e << 6) | (run - 2),
-						11 + 7 + 6);
-			}
-		} else if (run == 0) {
-			/* 1111111 */
-			*o++ = 0;
-			*o = set_dv_vlc((0x7f << 9) | (amp << 1) | sign,
-					7 + 8 + 1);
-		} else {
-			vlc_encode_r(run - 1, 0, 0, o);
-			++o;
-			vlc_encode_r(0, amp, sign, o);
-			return ++o;
-		}
+	for (i = 0; i < 4; i++) {
+		enc_v8 v[2];
+		memcpy(v, coeffs + 16 * i, sizeof(v));
+		v[0] = (enc_v8) (v[0] != 0);
+		v[1] = (enc_v8) (v[1] != 0);
+		mask |= (uint64_t) _mm_movemask_epi8(
+			_mm_packs_epi16((__m128i) v[0], (__m128i) v[1]))
+			<< (16 * i);
 	}
-	return ++o;
+	return mask;
 }
 
-dv_vlc_entry_t * vlc_encode_lookup = NULL;
-unsigned char  * vlc_num_bits_lookup = NULL;
-
-void _dv_init_vlc_encode_lookup(void)
+static __attribute__ ((target ("sse2"))) int 
+max_ac_amp_sse2(const dv_coeff_t *coeffs)
 {
-	int run,amp;
-	
-	if (vlc_encode_lookup == NULL)
-		vlc_encode_lookup = (dv_vlc_entry_t *) malloc(
-			32768 * 2 * sizeof(dv_vlc_entry_t));
-	if (vlc_num_bits_lookup == NULL)
-		vlc_num_bits_lookup = (unsigned char*) malloc(32768);
-		
-	for (run = 0; run <= 63; run++) {
-		for (amp = 0; amp <= 255; amp++) {
-			int index1 = (255 + amp) | (run << 9);
-			int index2 = (255 - amp) | (run << 9);
-			vlc_encode_orig(run,amp,0,vlc_encode_lookup+2* index1);
-			vlc_encode_orig(run,amp,1,vlc_encode_lookup+2* index2);
-			vlc_num_bits_lookup[index1] =
-				vlc_num_bits_lookup[index2] =
-				get_dv_vlc_len(vlc_encode_lookup[2*index1])
-				+get_dv_vlc_len(vlc_encode_lookup[2*index1+1]);
-		}
+	enc_v8 v[8], m;
+	int i, max = 0;
+
+	memcpy(v, coeffs, sizeof(v));
+	v[0][0] = 0;
+	m = (enc_v8) _mm_max_epi16((__m128i) v[0], (__m128i) -v[0]);
+	for (i = 1; i < 8; i++) {
+		m = (enc_v8) _mm_max_epi16((__m128i) m, (__m128i) v[i]);
+		m = (enc_v8) _mm_max_epi16((__m128i) m, (__m128i) -v[i]);
+	}
+	for (i = 0; i < 8; i++) {
+		if (max < m[i]) max = m[i];
 	}
+	return max;
 }
 
-static inline void vlc_encode(int run, int amp, int sign, dv_vlc_entry_t * o)
+static __attribute__ ((target ("avx2"))) uint64_t 
+nonzero_mask_avx2(const dv_coeff_t *coeffs)
 {
-	dv_vlc_entry_t * s= vlc_encode_lookup + 2 * ((amp + 255) | (run << 9));
-	*o++ = *s++;
-	*o = *s++ | (sign << 8);
+	enc_v16 v[4];
+	__m256i p;
+	uint64_t lo, hi;
+
+	memcpy(v, coeffs, sizeof(v));
+	/* packsswb works per 128 bit lane, the qword permute restores
+	 * the coefficient order */
+	p = _mm256_packs_epi16((__m256i) (enc_v16) (v[0] != 0), 
+			       (__m256i) (enc_v16) (v[1] != 0));
+	p = _mm256_permute4x64_epi64(p, 0xd8);
+	lo = (uint32_t) _mm256_movemask_epi8(p);
+	p = _mm256_packs_epi16((__m256i) (enc_v16) (v[2] != 0), 
+			       (__m256i) (enc_v16) (v[3] != 0));
+	p = _mm256_permute4x64_epi64(p, 0xd8);
+	hi = (uint32_t) _mm256_movemask_epi8(p);
+	return lo | (hi << 32);
 }
 
-static inline unsigned long vlc_num_bits(int run, int amp)
+static __attribute__ ((target ("avx2"))) int 
+max_ac_amp_avx2(const dv_coeff_t *coeffs)
 {
-	return vlc_num_bits_lookup[(amp + 255) | (run << 9)];
+	enc_v16 v[4], m;
+	__m256i a[4];
+	int i, max = 0;
+
+	memcpy(v, coeffs, sizeof(v));
+	v[0][0] = 0;
+	for (i = 0; i < 4; i++) {
+		a[i] = _mm256_abs_epi16((__m256i) v[i]);
+	}
+	m = (enc_v16) _mm256_max_epi16(_mm256_max_epi16(a[0], a[1]), 
+				       _mm256_max_epi16(a[2], a[3]));
+	for (i = 0; i < 16; i++) {
+		if (max < m[i]) max = m[i];
+	}
+	return max;
 }
 
-static unsigned short reorder_88[64] = {
-	1, 2, 6, 7,15,16,28,29,
-	3, 5, 8,14,17,27,30,43,
-	4, 9,13,18,26,31,42,44,
-	10,12,19,25,32,41,45,54,
-	11,20,24,33,40,46,53,55,
-	21,23,34,39,47,52,56,61,
-	22,35,38,48,51,57,60,62,
-	36,37,49,50,58,59,63,64
-};
-static unsigned short reorder_248[64] = {
-	1, 3, 7,19,21,35,37,51,
-	5, 9,17,23,33,39,49,53,
-	11,15,25,31,41,47,55,61,
-	13,27,29,43,45,57,59,63,
-
-	2, 4, 8,20,22,36,38,52,
-	6,10,18,24,34,40,50,54,
-	12,16,26,32,42,48,56,62,
-	14,28,30,44,46,58,60,64
-};
-
+#else /* ARCH_X86_64 || ARCH_X86 */
 
-void _dv_prepare_reorder_tables(void)
+static uint64_t nonzero_mask_v8(const dv_coeff_t *coeffs)
 {
-	int i;
-	for (i = 0; i < 64; i++) {
-		reorder_88[i]--;
-		reorder_88[i] *= 2;
-		reorder_248[i]--;
-		reorder_248[i] *= 2;
+	static const enc_v8 bit = { 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint64_t mask = 0;
+	int i, j;
+
+	for (i = 0; i < 8; i++) {
+		enc_v8 v;
+		int m = 0;
+		memcpy(&v, coeffs + 8 * i, sizeof(v));
+		v = (enc_v8) (v != 0) & bit;
+		for (j = 0; j < 8; j++) {
+			m |= v[j];
+		}
+		mask |= (uint64_t) m << (8 * i);
 	}
+	return mask;
 }
 
-extern int _dv_reorder_block_mmx(dv_coeff_t * a, 
-			     const unsigned short* reorder_table);
+static int max_ac_amp_v8(const dv_coeff_t *coeffs)
+{
+	enc_v8 v[8], m = { 0 };
+	int i, max = 0;
+
+	memcpy(v, coeffs, sizeof(v));
+	v[0][0] = 0;
+	for (i = 0; i < 8; i++) {
+		enc_v8 s = v[i] >> 15;
+		enc_v8 a = (v[i] ^ s) - s;
+		enc_v8 gt = (enc_v8) (a > m);
+		m = (a & gt) | (m & ~gt);
+	}
+	for (i = 0; i < 8; i++) {
+		if (max < m[i]) max = m[i];
+	}
+	return max;
+}
 
-extern int _dv_reorder_block_mmx_x86_64(dv_coeff_t * a, 
-			     const unsigned short* reorder_table);
+#endif /* ARCH_X86_64 || ARCH_X86 */
 
-static void reorder_block(dv_block_t *bl)
+/* bit i is set if coeffs[i] is nonzero */
+static inline uint64_t nonzero_mask(const dv_coeff_t *coeffs)
 {
-#if (!ARCH_X86) && (!ARCH_X86_64)
-	dv_coeff_t zigzag[64];
-	int i;
+#if ARCH_X86_64 || ARCH_X86
+	if (_dv_simd.avx2) {
+		return nonzero_mask_avx2(coeffs);
+	}
+	if (_dv_simd.sse2) {
+		return nonzero_mask_sse2(coeffs);
+	}
+#else
+	return nonzero_mask_v8(coeffs);
 #endif
-	const unsigned short *reorder;
+	{
+		uint64_t mask = 0;
+		int i;
 
-	if (bl->dct_mode == DV_DCT_88)
-		reorder = reorder_88;
-	else
-		reorder = reorder_248;
+		for (i = 0; i < 64; i++) {
+			mask |= (uint64_t) (coeffs[i] != 0) << i;
+		}
+		return mask;
+	}
+}
 
-#if ARCH_X86
-	_dv_reorder_block_mmx(bl->coeffs, reorder);
-	emms();
-#elif ARCH_X86_64
-	_dv_reorder_block_mmx_x86_64(bl->coeffs, reorder);
-	emms();
-#else	
-	for (i = 0; i < 64; i++) {
-	  //		*(unsigned short*) ((char*) zigzag + reorder[i])=bl->coeffs[i];
-	  zigzag[reorder[i] - 1] = bl->coeffs[i];
+/* VLC bits of the AC coefficients flagged in mask */
+static inline unsigned long vlc_num_bits_mask(const dv_coeff_t *coeffs, 
+					      uint64_t mask)
+{
+	unsigned long num_bits = 0;
+	int last = 0;
+
+	mask &= ~(uint64_t) 1;
+	while (mask) {
+		int i = __builtin_ctzll(mask);
+		num_bits += vlc_num_bits(i - last - 1, coeffs[i]);
+		last = i;
+		mask &= mask - 1;
+	}
+	return num_bits;
+}
+
+/* largest AC magnitude, -1 if the MMX code has to do it */
+static inline int max_ac_amp(const dv_coeff_t *coeffs)
+{
+#if ARCH_X86_64 || ARCH_X86
+	if (_dv_simd.avx2) {
+		return max_ac_amp_avx2(coeffs);
 	}
-	memcpy(bl->coeffs, zigzag, 64 * sizeof(dv_coeff_t));
+	if (_dv_simd.sse2) {
+		return max_ac_amp_sse2(coeffs);
+	}
+	return -1;
+#else
+	return max_ac_amp_v8(coeffs);
 #endif
 }
 
+#endif /* ENC_VECTOR */
+
 extern unsigned long _dv_vlc_encode_block_mmx(dv_coeff_t* coeffs,
 					  dv_vlc_entry_t ** out);
 
@@ -579,7 +555,9 @@ extern unsigned long _dv_vlc_num_bits_block_x86_64(dv_coeff_t* coeffs);
 
 extern unsigned long _dv_vlc_num_bits_block(dv_coeff_t* coeffs)
 {
-#if (!ARCH_X86) && (!ARCH_X86_64)
+#if ENC_VECTOR
+	return vlc_num_bits_mask(coeffs, nonzero_mask(coeffs));
+#elif (!ARCH_X86) && (!ARCH_X86_64)
 	dv_coeff_t * z = coeffs + 1; /* First AC coeff */
 	dv_coeff_t * z_end = coeffs + 64;
 	int run;
@@ -604,7 +582,8 @@ extern unsigned long _dv_vlc_num_bits_block(dv_coeff_t* coeffs)
 #endif
 }
 
-static void vlc_make_fit(dv_vlc_block_t * bl, int num_blocks, long bit_budget)
+static void vlc_make_fit(dv_vlc_block_t * bl, int num_blocks, long bit_budget,
+			 dv_enc_stats_t * stats)
 {
 	dv_vlc_block_t* b = bl + num_blocks;
 	long bits_used = 0;
@@ -614,7 +593,7 @@ static void vlc_make_fit(dv_vlc_block_t * bl, int num_blocks, long bit_budget)
 	if (bits_used <= bit_budget) {
 		return;
 	}
-	vlc_overflows++;
+	if (stats) stats->vlc_overflows++;
 	while (bits_used > bit_budget) {
 		b--;
 		if (b->coeffs_end != b->coeffs + 1) {
@@ -762,21 +741,28 @@ static void vlc_encode_block_pass_n(dv_vlc_block_t * blocks,
 	return;
 }
 
-extern int _dv_classify_mmx(dv_coeff_t * a, unsigned short* amp_ofs,
-			unsigned short* amp_cmp);
+extern int _dv_classify_mmx(dv_coeff_t * a, const unsigned short* amp_ofs,
+			const unsigned short* amp_cmp);
 
-extern int _dv_classify_mmx_x86_64(dv_coeff_t * a, unsigned short* amp_ofs,
-			unsigned short* amp_cmp);
+extern int _dv_classify_mmx_x86_64(dv_coeff_t * a, const unsigned short* amp_ofs,
+			const unsigned short* amp_cmp);
 
 static inline int classify(dv_coeff_t * bl)
 {
+#if ENC_VECTOR
+	int amp = max_ac_amp(bl);
+
+	if (amp >= 0) {
+		return (amp > 35) ? 3 : (amp > 23) ? 2 : (amp > 11) ? 1 : 0;
+	}
+#endif
 #if ARCH_X86
-	static unsigned short amp_ofs[3][4] = { 
+	static const unsigned short amp_ofs[3][4] = { 
 		{ 32768+35,32768+35,32768+35,32768+35 },
 		{ 32768+23,32768+23,32768+23,32768+23 },
 		{ 32768+11,32768+11,32768+11,32768+11 }
 	};
-	static unsigned short amp_cmp[3][4] = { 
+	static const unsigned short amp_cmp[3][4] = { 
 		{ 32768+(35+35),32768+(35+35),32768+(35+35),32768+(35+35) },
 		{ 32768+(23+23),32768+(23+23),32768+(23+23),32768+(23+23) },
 		{ 32768+(11+11),32768+(11+11),32768+(11+11),32768+(11+11) }
@@ -796,12 +782,12 @@ static inline int classify(dv_coeff_t * bl)
 	emms();
 	return 0;
 #elif ARCH_X86_64
-	static unsigned short amp_ofs[3][4] = { 
+	static const unsigned short amp_ofs[3][4] = { 
 		{ 32768+35,32768+35,32768+35,32768+35 },
 		{ 32768+23,32768+23,32768+23,32768+23 },
 		{ 32768+11,32768+11,32768+11,32768+11 }
 	};
-	static unsigned short amp_cmp[3][4] = { 
+	static const unsigned short amp_cmp[3][4] = { 
 		{ 32768+(35+35),32768+(35+35),32768+(35+35),32768+(35+35) },
 		{ 32768+(23+23),32768+(23+23),32768+(23+23),32768+(23+23) },
 		{ 32768+(11+11),32768+(11+11),32768+(11+11),32768+(11+11) }
@@ -824,7 +810,7 @@ static inline int classify(dv_coeff_t * bl)
 	int rval = 0;
 
 	dv_coeff_t* p = bl + 1;
-	dv_coeff_t* p_end = p + 64;
+	dv_coeff_t* p_end = bl + 64;
 
 	while (p != p_end) {
 		int a = *p++;
@@ -850,94 +836,40 @@ static inline int classify(dv_coeff_t * bl)
 #endif
 }
 
-static void do_dct(dv_macroblock_t *mb)
+static void do_dct(dv_macroblock_t *mb, dv_enc_stats_t * stats)
 {
 	unsigned int b;
 
+	_dv_dct_blocks(mb->b, 6);
+
 	for (b = 0; b < 6; b++) {
 		dv_block_t *bl = &mb->b[b];
 		
-		if (bl->dct_mode == DV_DCT_88) {
-			_dv_dct_88(bl->coeffs);
-#if (!ARCH_X86) && (!ARCH_X86_64)
-			reorder_block(bl);
-#endif
 #if BRUTE_FORCE_DCT_88
+		if (bl->dct_mode == DV_DCT_88)
 			_dv_weight_88(bl->coeffs);
 #endif
-		} else {
-			_dv_dct_248(bl->coeffs);
-			reorder_block(bl);
 #if BRUTE_FORCE_DCT_248
+		if (bl->dct_mode == DV_DCT_248)
 			_dv_weight_248(bl->coeffs);
 #endif
-		}
-		dct_used[bl->dct_mode]++;
+		if (stats) stats->dct_used[bl->dct_mode]++;
 	}
 }
 
-static int classes[3][4] = {
+static const int classes[3][4] = {
 	{ 0, 1, 2, 3},
 	{ 1, 2, 3, 3},
 	{ 2, 3, 3, 3}
 };
 
-static int qnos[4][16] = {
-	{ 15,                  8,    6,    4,    2, 0},
-	{ 15,         11, 10,  8,    6,    4,    2, 0},
-	{ 15, 14, 13, 11,      8,    6,    4,    2, 0},
-	{ 15,     13, 12, 10,  8,    6,    4,    2, 0}
-};
-
-static int quant_2_static_table[2][20] = {
+static const int quant_2_static_table[2][20] = {
 	{1700, 0, 1500, 2, 1000, 4, 900, 6, 750, 8, 650, 10, 550, 12, 512, 13, 0, 15},
 	{1700, 0, 1400, 2, 1200, 4, 1000,6, 800, 8, 650, 10, 550, 12, 512, 13, 0, 15}
 };
 
-static int qnos_class_combi[16][16];
-static int qno_next_hit[4][16];
-
-void _dv_init_qno_start(void)
-{
-	int qno;
-	int klass;
-	int qno_p[4];
-	int combi_p[16];
-
-	memset(qno_p, 0, sizeof(qno_p));
-	memset(combi_p, 0, sizeof(combi_p));
-
-	for (qno = 15; qno >= 0; qno--) {
-		int i;
-
-		for (klass = 0; klass < 4; klass++) {
-			if (qnos[klass][qno_p[klass]] > qno) {
-				qno_p[klass]++;
-			}
-                        i = 0;
-                        while (qnos[klass][i] > qno) {
-                                i++;
-                        }
-                        qno_next_hit[klass][qno] = i;
-
-		}
-		for (i = 1; i < 16; i++) {
-			int q = 0;
-			for (klass = 0; klass < 4; klass++) {
-				if ((i & (1 << klass))
-				    && qnos[klass][qno_p[klass]] > q) {
-					q = qnos[klass][qno_p[klass]];
-				}
-			}
-			if (combi_p[i] == 0 || 
-			    qnos_class_combi[i][combi_p[i] - 1] != q) {
-				qnos_class_combi[i][combi_p[i]++] = q;
-			}
-		}
-	}
-}
-
-static void do_classify(dv_macroblock_t * mb, int static_qno)
+static void do_classify(dv_macroblock_t * mb, int static_qno,
+			dv_enc_stats_t * stats)
 {
 	int b;
 	dv_block_t *bl;
@@ -952,19 +884,130 @@ static void do_classify(dv_macroblock_t * mb, int static_qno)
 	for (b = 0; b < 4; b++) {
 		bl = &mb->b[b];
 		bl->class_no = classes[0][classify(bl->coeffs)];
-		classes_used[bl->class_no]++;
+		if (stats) stats->classes_used[bl->class_no]++;
 	}
 	bl = &mb->b[4];
 	bl->class_no = classes[1][classify(bl->coeffs)];
-	classes_used[bl->class_no]++;
+	if (stats) stats->classes_used[bl->class_no]++;
 	bl = &mb->b[5];
 	bl->class_no = classes[2][classify(bl->coeffs)];
-	classes_used[bl->class_no]++;
+	if (stats) stats->classes_used[bl->class_no]++;
 	
 }
 
+/* Bit cost curves for the quantiser searches of quant_2_passes() and
+ * quant_3_passes().  Quantisation only shifts magnitudes right and
+ * the VLC size does not depend on the sign, so the size of a block
+ * for any qno follows from the magnitudes of its nonzero AC
+ * coefficients alone.  They are collected once per block, grouped by
+ * quantisation area, and the size for a qno is computed when first
+ * asked for and then remembered, instead of requantising and counting
+ * the whole block for every candidate.  When the caller only ever
+ * moves to coarser quantisers (prune), coefficients that have dropped
+ * to zero are discarded on the way.  The sizes are exact, so the
+ * searches decide as before. */
+typedef struct {
+	int      klass;
+	int      end[4];        /* end of each area in pos/amp */
+	uint8_t  pos[63];       /* zigzag positions of nonzero AC coeffs */
+	uint16_t amp[63];       /* and their magnitudes */
+	int      bits[16];      /* VLC bits per qno, -1: not known yet */
+} dv_bit_curve_t;
+
+static void bit_curve_init(dv_bit_curve_t *c, const dv_block_t *bl)
+{
+	static const int area_end[4] = { 6, 21, 43, 64 };
+	int i, area, n = 0;
+
+	c->klass = bl->class_no;
+#if ENC_VECTOR
+	{
+		uint64_t mask = nonzero_mask(bl->coeffs) & ~(uint64_t) 1;
+
+		for (area = 0; area < 4; area++) {
+			uint64_t in_area = mask;
+			if (area_end[area] < 64) {
+				in_area &= ((uint64_t) 1 << area_end[area]) - 1;
+			}
+			mask ^= in_area;
+			for (; in_area; in_area &= in_area - 1) {
+				int amp;
+				i = __builtin_ctzll(in_area);
+				amp = bl->coeffs[i];
+				c->pos[n] = i;
+				c->amp[n++] = (amp < 0) ? -amp : amp;
+			}
+			c->end[area] = n;
+		}
+	}
+#else
+	for (i = 1, area = 0; area < 4; area++) {
+		for (; i < area_end[area]; i++) {
+			int amp = bl->coeffs[i];
+			if (amp) {
+				c->pos[n] = i;
+				c->amp[n++] = (amp < 0) ? -amp : amp;
+			}
+		}
+		c->end[area] = n;
+	}
+#endif
+	for (i = 0; i < 16; i++) {
+		c->bits[i] = -1;
+	}
+}
+
+/* same as _dv_quant() followed by _dv_vlc_num_bits_block() */
+static int bit_curve_bits(dv_bit_curve_t *c, int qno, int prune)
+{
+	if (c->bits[qno] < 0) {
+		const uint8_t *pq = 
+			dv_quant_shifts[qno + dv_quant_offset[c->klass]];
+		int extra = (c->klass == 3) ? 1 : 0;
+		int noquant = (qno == 15 && c->klass != 3);
+		int i = 0, n = 0, area, last = 0, bits = 0;
+
+		for (area = 0; area < 4; area++) {
+			int shift = noquant ? 0 : pq[area] + extra;
+
+			for (; i < c->end[area]; i++) {
+				int pos = c->pos[i];
+				int amp = c->amp[i] >> shift;
+
+				if (amp) {
+					bits += vlc_num_bits(pos - last - 1, 
+							     amp);
+					last = pos;
+					if (prune) {
+						c->pos[n] = pos;
+						c->amp[n++] = c->amp[i];
+					}
+				}
+			}
+			if (prune) {
+				c->end[area] = n;
+			} else {
+				n = i;
+			}
+		}
+		c->bits[qno] = bits;
+	}
+	return c->bits[qno];
+}
+
+static inline int bit_curves_sum(dv_bit_curve_t *c, int qno, int prune)
+{
+	int b, bits = 0;
+
+	for (b = 0; b < 6; b++) {
+		bits += bit_curve_bits(c + b, qno, prune);
+	}
+	return bits;
+}
+
 static void quant_1_pass(dv_videosegment_t* videoseg, 
-			 dv_vlc_block_t * vblocks, int static_qno)
+			 dv_vlc_block_t * vblocks, int static_qno,
+			 dv_enc_stats_t * stats)
 {
 	dv_macroblock_t *mb;
 	int m;
@@ -973,14 +1016,14 @@ static void quant_1_pass(dv_videosegment_t* videoseg,
 	dv_coeff_t bb[6][64];
 
 	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
-		int smallest_qno = 15;
+		int smallest_qno = mb->qno;
 		int qno_index;
 		int cycles = 0;
 
 		for (b = 0; b < 6; b++) {
 			dv_block_t *bl = &mb->b[b];
 			unsigned int ac_coeff_budget = (((b < 4) ? 100 : 68) - 4); 
-			qno_index = qno_next_hit[bl->class_no][smallest_qno];
+			qno_index = _dv_qno_next_hit[bl->class_no][smallest_qno];
 			while (smallest_qno > 0) {
 				memcpy(bb[b], bl->coeffs, 
 				       64 *sizeof(dv_coeff_t));
@@ -990,7 +1033,7 @@ static void quant_1_pass(dv_videosegment_t* videoseg,
 					break;
 				qno_index++;
 				cycles++;
-				smallest_qno = qnos[bl->class_no][qno_index];
+				smallest_qno = _dv_qnos[bl->class_no][qno_index];
 			}
 			if (smallest_qno == 0) {
 				break;
@@ -998,8 +1041,10 @@ static void quant_1_pass(dv_videosegment_t* videoseg,
 		}
 
 		mb->qno = smallest_qno;
-		cycles_used[cycles]++;
-		qnos_used[smallest_qno]++;
+		if (stats) {
+			stats->cycles_used[cycles]++;
+			stats->qnos_used[smallest_qno]++;
+		}
 		if (smallest_qno != 15) { 
 			for (b = 0; b < 6; b++) {
 				dv_block_t *bl = &mb->b[b];
@@ -1010,7 +1055,7 @@ static void quant_1_pass(dv_videosegment_t* videoseg,
 			if (smallest_qno == 0) {
 				for (b = 0; b < 6; b++) {
 					vlc_make_fit(vblocks + b, 1,
-						     ((b < 4) ? 100 : 68));
+						     ((b < 4) ? 100 : 68), stats);
 				}
 			}
 		} else {
@@ -1023,34 +1068,25 @@ static void quant_1_pass(dv_videosegment_t* videoseg,
 }
 
 static void quant_2_passes(dv_videosegment_t* videoseg, 
-			   dv_vlc_block_t * vblocks, int static_qno)
+			   dv_vlc_block_t * vblocks, int static_qno,
+			   dv_enc_stats_t * stats)
 {
 	dv_macroblock_t *mb;
 	int m;
-	dv_coeff_t bb[6][64];
+	dv_bit_curve_t curves[6];
 	const int ac_coeff_budget = 4*100+2*68-6*4;
 
 	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
 		int b;
 		int cycles = 0;
 		int bits_used = 0;
-		int qno = 15;
+		int qno = mb->qno;
 		int run = 0;
-#if 0
-		int bits_used_ = 0;
-#endif
 
 		for (b = 0; b < 6; b++) {
-			int bits;
-			dv_block_t *bl = &mb->b[b];
-			memcpy(bb[b], bl->coeffs, 64 *sizeof(dv_coeff_t));
-			_dv_quant(bb[b], qno, bl->class_no);
-			bits = _dv_vlc_num_bits_block(bb[b]);
-			bits_used += bits;
-#if 0
-			bits_used_ += bits;
-#endif
+			bit_curve_init(&curves[b], &mb->b[b]);
 		}
+		bits_used = bit_curves_sum(curves, qno, 1);
 
 		if (static_qno && bits_used > ac_coeff_budget) {
 			int i = 0;
@@ -1064,7 +1100,7 @@ static void quant_2_passes(dv_videosegment_t* videoseg,
 				VLC_BITS_ON_FULL_MBLOCK_CYCLE_QUANT_2 + 1;
 			int qno_incr = 8;
 			int i;
-			qno++;
+			qno = 16;
 
 			for (; run < runs 
 				     && run < VLC_MAX_RUNS_PER_CYCLE_QUANT_2;
@@ -1073,14 +1109,7 @@ static void quant_2_passes(dv_videosegment_t* videoseg,
 				qno_incr >>= 1;
 			}
 			for (i = run; i < 5; i++) {
-				bits_used = 0;
-				for (b = 0; b < 6; b++) {
-					dv_block_t *bl = &mb->b[b];
-					memcpy(bb[b], bl->coeffs, 
-					       64 *sizeof(dv_coeff_t));
-					_dv_quant(bb[b], qno, bl->class_no);
-					bits_used += _dv_vlc_num_bits_block(bb[b]);
-				}
+				bits_used = bit_curves_sum(curves, qno, 0);
 
 				if (bits_used > ac_coeff_budget) {
 					qno -= qno_incr;
@@ -1095,35 +1124,32 @@ static void quant_2_passes(dv_videosegment_t* videoseg,
 				qno_incr >>= 1;
 			} 
 			qno = qno_ok;
-#if 0
-			fprintf(stderr, "%d %d\n", bits_used_, qno);
-#endif
+		}
+		if (qno > mb->qno) {
+			qno = mb->qno;
 		}
 
 		mb->qno = qno;
-		runs_used[run]++;
-		cycles_used[cycles]++;
-		qnos_used[qno]++;
-		if (qno != 15) { 
-			for (b = 0; b < 6; b++) {
-				dv_block_t *bl = &mb->b[b];
-				_dv_quant(bl->coeffs, qno, bl->class_no);
-				vlc_encode_block(bl->coeffs, vblocks + b);
-			}
-			if (qno == 0 || static_qno) {
-				vlc_make_fit(vblocks, 6, 4*100+2*68);
-			}
-		} else {
-			for (b = 0; b < 6; b++) {
-				vlc_encode_block(bb[b], vblocks + b);
-			}
+		if (stats) {
+			stats->runs_used[run]++;
+			stats->cycles_used[cycles]++;
+			stats->qnos_used[qno]++;
+		}
+		for (b = 0; b < 6; b++) {
+			dv_block_t *bl = &mb->b[b];
+			_dv_quant(bl->coeffs, qno, bl->class_no);
+			vlc_encode_block(bl->coeffs, vblocks + b);
+		}
+		if (qno != 15 && (qno == 0 || static_qno)) {
+			vlc_make_fit(vblocks, 6, 4*100+2*68, stats);
 		}
 		vblocks += 6;
 	}
 }
 
 static void quant_3_passes(dv_videosegment_t* videoseg, 
-			   dv_vlc_block_t * vblocks, int static_qno)
+			   dv_vlc_block_t * vblocks, int static_qno,
+			   dv_enc_stats_t * stats)
 {
 	dv_macroblock_t *mb;
 	int m;
@@ -1132,27 +1158,29 @@ static void quant_3_passes(dv_videosegment_t* videoseg,
 	int qno_index[5];
 	int class_combi[5];
 	int cycles = 0;
-	dv_coeff_t bb[5][6][64];
+	dv_bit_curve_t curves[5][6];
 	const int ac_coeff_budget = 5*(4*100+2*68-6*4);
 	int bits_used[5];
 	int bits_used_total;
 	for (m = 0; m < 5; m++) {
-		smallest_qno[m] = 15;
+		smallest_qno[m] = videoseg->mb[m].qno;
 		qno_index[m] = 0;
 		class_combi[m] = 0;
 	}
 
 	bits_used_total = 0;
 	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
-		bits_used[m] = 0;
 		for (b = 0; b < 6; b++) {
 			dv_block_t *bl = &mb->b[b];
-			memcpy(bb[m][b], bl->coeffs, 64 * sizeof(dv_coeff_t));
-			_dv_quant(bb[m][b], smallest_qno[m], bl->class_no);
-			bits_used[m] += _dv_vlc_num_bits_block(bb[m][b]);
+			bit_curve_init(&curves[m][b], bl);
 			class_combi[m] |= (1 << bl->class_no);
 		}
-		while (qnos_class_combi[class_combi[m]][qno_index[m]] > 15) {
+		bits_used[m] = bit_curves_sum(curves[m], smallest_qno[m], 1);
+		/* the next step down is the first quantiser below the
+		   finest one allowed */
+		while (qno_index[m] < 15 && 
+		       _dv_qnos_class_combi[class_combi[m]][qno_index[m] + 1]
+		       >= smallest_qno[m]) {
 			qno_index[m]++;
 		}
 		bits_used_total += bits_used[m];
@@ -1170,26 +1198,31 @@ static void quant_3_passes(dv_videosegment_t* videoseg,
 			while (bits_used[m] <= 
 			       quant_2_static_table[static_qno-1][i])
 				i += 2;
-			smallest_qno[m] =
-				quant_2_static_table[static_qno-1][i+1];
-			if (smallest_qno[m] < 14) {
-				smallest_qno[m] ++; /* just guessed... */
+			i = quant_2_static_table[static_qno-1][i+1];
+			if (i < 14) {
+				i++; /* just guessed... */
+			}
+			if (i < smallest_qno[m]) {
+				smallest_qno[m] = i;
 			}
 		}
 	} else while (bits_used_total > ac_coeff_budget) {
-		int m_max = 0;
-		int bits_used_ = 0;
+		int m_max = -1;
+		int bits_used_;
 		int runs = (bits_used_total - ac_coeff_budget) / 
 			VLC_BITS_ON_FULL_MBLOCK_CYCLE_QUANT_3 + 1;
 		int run;
 
-		for (m = 1; m < 5; m++) {
-			if (bits_used[m] > bits_used[m_max]) {
+		for (m = 0; m < 5; m++) {
+			if (smallest_qno[m] > 0 && (m_max < 0 || 
+			    bits_used[m] > bits_used[m_max])) {
 				m_max = m;
 			}
 		}
+		if (m_max < 0) {
+			break;
+		}
 		m = m_max;
-		mb = videoseg->mb + m;
 
 		cycles++;
 		
@@ -1198,22 +1231,17 @@ static void quant_3_passes(dv_videosegment_t* videoseg,
 		     run++) {
 			qno_index[m]++;
 			smallest_qno[m] = 
-				qnos_class_combi[class_combi[m]][qno_index[m]];
+				_dv_qnos_class_combi[class_combi[m]][qno_index[m]];
 			if (smallest_qno[m] == 0) {
 				break;
 			}
 		}
-		runs_used[run]++;
+		if (stats) stats->runs_used[run]++;
 		if (smallest_qno[m] == 0) {
 			break;
 		}
-		
-		for (b = 0; b < 6; b++) {
-			dv_block_t *bl = &mb->b[b];
-			memcpy(bb[m][b], bl->coeffs, 64 *sizeof(dv_coeff_t));
-			_dv_quant(bb[m][b], smallest_qno[m], bl->class_no);
-			bits_used_ += _dv_vlc_num_bits_block(bb[m][b]);
-		}
+
+		bits_used_ = bit_curves_sum(curves[m], smallest_qno[m], 1);
 #if 0
 		fprintf(stderr, "(qno: %d, gain: %d, run: %d) ", 
 			smallest_qno[m], bits_used[m] - bits_used_, run);
@@ -1223,81 +1251,52 @@ static void quant_3_passes(dv_videosegment_t* videoseg,
 		bits_used[m] = bits_used_;
 	}
 
-	cycles_used[cycles]++;
+	if (stats) stats->cycles_used[cycles]++;
 	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
 		mb->qno = smallest_qno[m];
-		qnos_used[smallest_qno[m]]++;
-		if (smallest_qno[m] != 15) { 
-			for (b = 0; b < 6; b++) {
-				dv_block_t *bl = &mb->b[b];
-				_dv_quant(bl->coeffs,smallest_qno[m],bl->class_no);
-				vlc_encode_block(bl->coeffs,vblocks+6 * m + b);
-			}
-		} else {
-			for (b = 0; b < 6; b++) {
-				vlc_encode_block(bb[m][b], vblocks+6 * m + b);
-			}
+		if (stats) stats->qnos_used[smallest_qno[m]]++;
+		for (b = 0; b < 6; b++) {
+			dv_block_t *bl = &mb->b[b];
+			_dv_quant(bl->coeffs,smallest_qno[m],bl->class_no);
+			vlc_encode_block(bl->coeffs,vblocks+6 * m + b);
 		}
 	}
 	if (bits_used_total > ac_coeff_budget) {
-		vlc_make_fit(vblocks, 30, 5*(4*100+2*68));
+		vlc_make_fit(vblocks, 30, 5*(4*100+2*68), stats);
 	}
 }
 
-static void process_videosegment(dv_enc_input_filter_t * input,
-				 dv_videosegment_t* videoseg,
-				 uint8_t * vsbuffer, int vlc_encode_passes,
-				 int static_qno)
+/* Chooses the quantisers of a video segment and writes it to vsbuffer.
+ * The blocks hold their coefficients in zigzag order, with the DCT
+ * modes and classes set; mb->qno is the finest quantiser allowed.  If t
+ * is not NULL, the stages are timed into stats. */
+static void pack_videosegment(dv_videosegment_t* videoseg, 
+			      uint8_t * vsbuffer, int vlc_encode_passes,
+			      int static_qno, dv_enc_stats_t * stats,
+			      double * t)
 {
 	dv_macroblock_t *mb;
 	int m;
 	unsigned int b;
 	dv_vlc_block_t vlc_block[5*6];
 
-	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
-		mb->vlc_error = 0;
-		mb->eob_count = 0;
-		mb->i = (videoseg->i+ dv_super_map_vertical[m]) 
-			% (videoseg->isPAL ? 12 : 10);
-		mb->j = dv_super_map_horizontal[m];
-		mb->k = videoseg->k;
-		
-		if (videoseg->isPAL) {
-			dv_place_420_macroblock(mb);
-		} else {
-			dv_place_411_macroblock(mb);
-		}
-		input->fill_macroblock(mb, videoseg->isPAL);
-		do_dct(mb);
-		do_classify(mb, static_qno);
-	}
-
-#if 0
-	for (m = 0; m < 5; m++) {
-		dv_vlc_block_t *v_bl = vlc_block;
-		for (b = 0; b < 6; b++) {
-			v_bl->bit_offset = (8* (80 * m))+dv_parse_bit_start[b];
-			v_bl->bit_budget = (b < 4) ? 100 : 68;
-			v_bl++;
-		}
-	}
-#endif
-
 	switch (vlc_encode_passes) {
 	case 1:
-		quant_1_pass(videoseg, vlc_block, static_qno);
+		quant_1_pass(videoseg, vlc_block, static_qno, stats);
 		break;
 	case 2:
-		quant_2_passes(videoseg, vlc_block, static_qno);
+		quant_2_passes(videoseg, vlc_block, static_qno, stats);
 		break;
 	case 3:
-		quant_3_passes(videoseg, vlc_block, static_qno);
+		quant_3_passes(videoseg, vlc_block, static_qno, stats);
 		break;
 	default:
 		fprintf(stderr, "Invalid value for vlc_encode_passes "
 			"specified: %d!\n", vlc_encode_passes);
 		exit(-1);
 	}
+	if (stats) count_segment_bits(stats, vlc_block);
+	if (t) stage_done(stats, DV_ENC_STAGE_QUANT, t);
 		
 	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
 		put_bits(vsbuffer, (8 * (80 * m)) + 28, 4, mb->qno);
@@ -1319,13 +1318,44 @@ static void process_videosegment(dv_enc_input_filter_t * input,
 					vlc_encode_passes, 2);
 	}
 	vlc_encode_block_pass_n(vlc_block, vsbuffer, vlc_encode_passes, 3);
+	if (t) stage_done(stats, DV_ENC_STAGE_VLC, t);
+}
+
+static void process_videosegment(dv_enc_input_filter_t * input,
+				 dv_videosegment_t* videoseg,
+				 uint8_t * vsbuffer, int vlc_encode_passes,
+				 int static_qno, dv_enc_stats_t * stats)
+{
+	dv_macroblock_t *mb;
+	int m;
+
+	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
+		mb->vlc_error = 0;
+		mb->eob_count = 0;
+		mb->qno = 15;
+		mb->i = (videoseg->i+ dv_super_map_vertical[m]) 
+			% (videoseg->isPAL ? 12 : 10);
+		mb->j = dv_super_map_horizontal[m];
+		mb->k = videoseg->k;
+		
+		if (videoseg->isPAL) {
+			dv_place_420_macroblock(mb);
+		} else {
+			dv_place_411_macroblock(mb);
+		}
+		input->fill_macroblock(mb, videoseg->isPAL);
+		do_dct(mb, stats);
+		do_classify(mb, static_qno, stats);
+	}
+	pack_videosegment(videoseg, vsbuffer, vlc_encode_passes, static_qno,
+			  stats, NULL);
 }
 
 static void encode(dv_enc_input_filter_t * input,
 		   int isPAL, unsigned char* target, int vlc_encode_passes,
-		   int static_qno)
+		   int static_qno, dv_enc_stats_t * stats)
 {
-	static dv_videosegment_t videoseg ALIGN64;
+	dv_videosegment_t videoseg ALIGN64;
 
 	int numDIFseq;
 	int ds;
@@ -1369,20 +1399,28 @@ static void encode(dv_enc_input_filter_t * input,
 			process_videosegment(input, 
 					     &videoseg, target + offset,
 					     vlc_encode_passes,
-					     static_qno);
+					     static_qno, stats);
 			
 			dif += 5;
 		} 
 	} 
 }
 
+static int encoder_pipeline(dv_enc_input_filter_t * input,
+			    dv_enc_audio_input_filter_t * audio_input,
+			    dv_enc_output_filter_t * output,
+			    int start, int end, const char* filename,
+			    int vlc_encode_passes, int static_qno,
+			    int verbose_mode, int fps, int is16x9,
+			    int isPAL, int num_threads, time_t now);
+
 int dv_encoder_loop(dv_enc_input_filter_t * input,
 		 dv_enc_audio_input_filter_t * audio_input,
 		 dv_enc_output_filter_t * output,
 		 int start, int end, const char* filename,
 		 const char* audio_filename,
 		 int vlc_encode_passes, int static_qno, int verbose_mode,
-		 int fps, int is16x9)
+		 int fps, int is16x9, int num_threads)
 {
 	time_t now;
 	int i;
@@ -1433,6 +1471,17 @@ int dv_encoder_loop(dv_enc_input_filter_t * input,
 		}
 	}
 
+	if (num_threads < 0) {
+		num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (num_threads > 0 && input->read && input->convert) {
+		return encoder_pipeline(input, audio_input, output, 
+					start, end, filename,
+					vlc_encode_passes, static_qno,
+					verbose_mode, fps, is16x9, isPAL,
+					num_threads, now);
+	}
+
 	for (i = start; i <= end; i++) {
 		long skip_frame_step;
 		int skipped = 0;
@@ -1458,7 +1507,8 @@ int dv_encoder_loop(dv_enc_input_filter_t * input,
 		}
 		if (skip_frame_count < 65536) {
 			encode(input, isPAL, target, vlc_encode_passes, 
-			       static_qno);
+			       static_qno, &loop_stats);
+			loop_stats.frames++;
 		} else {
 			skip_frame_count -= 65536;
 			skipped = 1;
@@ -1478,37 +1528,627 @@ int dv_encoder_loop(dv_enc_input_filter_t * input,
 	return 0;
 }
 
+/* The statistics of dv_encoder_loop(); encoders of their own have
+ * dv_encoder_get_stats() */
 void dv_show_statistics()
 {
-	int i = 0;
-	fprintf(stderr, "\n\nFinal statistics:\n"
-		"========================================================\n"
-		"\n  |CYCLES    |RUNS/CYCLE|QNOS     |CLASS    "
-		"|VLC OVERF|DCT\n"
-		"========================================================\n");
-	fprintf(stderr, "%2d: %8ld |%8ld  |%8ld |%8ld |%8ld "
-		"|%8ld (DCT88)\n", 
-		i, cycles_used[i], runs_used[i], qnos_used[i],
-		classes_used[i], vlc_overflows, dct_used[DV_DCT_88]);
-	i++;
-	fprintf(stderr, "%2d: %8ld |%8ld  |%8ld |%8ld |         "
-		"|%8ld (DCT248)\n", 
-		i, cycles_used[i], runs_used[i], qnos_used[i],
-		classes_used[i], 
-		dct_used[DV_DCT_248]);
-	i++;
-	for (;i < 4; i++) {
-		fprintf(stderr, "%2d: %8ld |%8ld  |%8ld |%8ld |         |\n", 
-			i, cycles_used[i], runs_used[i], qnos_used[i],
-			classes_used[i]);
+	dv_encoder_print_stats(&loop_stats, stderr);
+}
+
+
+/* ---------------------------------------------------------------------------
+ * Worker pool for dv_encode_full_frame() and the transcoder.  Video
+ * segments are encoded independently and each one owns a disjoint 5*80
+ * byte slice of the frame, so the workers (and the calling thread) just
+ * pull segment numbers until the frame is done.
+ */
+typedef struct enc_adjust_s enc_adjust_t;
+
+typedef struct dv_enc_pool_s {
+	int              num_threads;   /* as requested, incl. the caller */
+	int              num_workers;   /* threads actually started */
+	pthread_t        *workers;
+	pthread_mutex_t  mutex;
+	pthread_cond_t   work_cond;
+	pthread_cond_t   done_cond;
+	int              quit;
+	int              generation;    /* bumped for every frame */
+	dv_encoder_t     *dv_enc;
+	uint8_t          *target;
+	int              transcode;     /* requantise instead of encode */
+	const enc_adjust_t *adj;        /* of the transcoder, or NULL */
+	int              next_seg;
+	int              num_segs;
+	int              segs_done;
+	int              error;
+} dv_enc_pool_t;
+
+/* Allocates the img_* planes on first use.  dv_encode_full_frame()
+ * converts its input per macroblock and does without them; only
+ * dv_encode_videosegment() and the input filters of encodedv read the
+ * picture from there. */
+static int enc_planes_prepare(dv_encoder_t *dv_enc)
+{
+	if (dv_enc->img_y) {
+		return 0;
 	}
-	for (;i < 16; i++) {
-		fprintf(stderr, "%2d: %8ld |%8ld  |%8ld |         "
-			"|         |\n", 
-			i, cycles_used[i], runs_used[i], qnos_used[i]);
+	dv_enc->img_y = (short*) calloc(DV_PAL_HEIGHT * DV_WIDTH, 
+					sizeof(short));
+	dv_enc->img_cr = (short*) calloc(DV_PAL_HEIGHT * DV_WIDTH / 2, 
+					 sizeof(short));
+	dv_enc->img_cb = (short*) calloc(DV_PAL_HEIGHT * DV_WIDTH / 2, 
+					 sizeof(short));
+	if (!dv_enc->img_y || !dv_enc->img_cr || !dv_enc->img_cb) {
+		free(dv_enc->img_y);
+		free(dv_enc->img_cr);
+		free(dv_enc->img_cb);
+		dv_enc->img_y = dv_enc->img_cr = dv_enc->img_cb = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * The compressed video segments of the previous frame, for the
+ * skip_static mode of dv_encode_full_frame().  A segment whose input
+ * checksum did not change is copied from here instead of being encoded
+ * again.  Every segment has its own entry, so the workers of the pool
+ * need no locking.
+ */
+#define DV_ENC_MAX_SEGS (12 * 27)
+
+typedef struct dv_enc_seg_cache_s {
+	int      key[8];       /* settings the segments were encoded with */
+	uint64_t sums[DV_ENC_MAX_SEGS];
+	uint8_t  valid[DV_ENC_MAX_SEGS];
+	uint8_t  segs[DV_ENC_MAX_SEGS][5 * 80];
+} dv_enc_seg_cache_t;
+
+/* Gets the cache ready for a frame; forgets all segments if one of
+ * the settings that shape them changed. */
+static int seg_cache_prepare(dv_encoder_t *dv_enc)
+{
+	dv_enc_seg_cache_t *cache = dv_enc->seg_cache;
+	int key[8];
+
+	if (!cache) {
+		cache = (dv_enc_seg_cache_t *) calloc(1, sizeof(*cache));
+		if (!cache) {
+			return -1;
+		}
+		dv_enc->seg_cache = cache;
+	}
+	key[0] = dv_enc->isPAL;
+	key[1] = dv_enc->vlc_encode_passes;
+	key[2] = dv_enc->static_qno;
+	key[3] = dv_enc->force_dct;
+	key[4] = dv_enc->rem_ntsc_setup;
+	key[5] = dv_enc->clamp_luma;
+	key[6] = dv_enc->clamp_chroma;
+	key[7] = dv_enc->in_color_space;
+	if (memcmp(key, cache->key, sizeof(key))) {
+		memcpy(cache->key, key, sizeof(key));
+		memset(cache->valid, 0, sizeof(cache->valid));
+	}
+	return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * The frame template of dv_encode_full_frame(): the header, subcode,
+ * VAUX and audio DIF blocks as far as they do not change from frame to
+ * frame, and the broken down time of the last date written.
+ */
+typedef struct dv_enc_template_s {
+	int       isPAL;
+	int       is16x9;
+	time_t    time;
+	struct tm tm;
+	uint8_t   frame[144000];
+} dv_enc_template_t;
+
+/* Gets the template ready for a frame; rebuilds it if the format
+ * changed. */
+static dv_enc_template_t *frame_template_prepare(dv_encoder_t *dv_enc)
+{
+	dv_enc_template_t *tmpl = dv_enc->frame_template;
+
+	if (!tmpl) {
+		tmpl = (dv_enc_template_t *) malloc(sizeof(*tmpl));
+		if (!tmpl) {
+			return NULL;
+		}
+		tmpl->isPAL = -1;
+		dv_enc->frame_template = tmpl;
+	}
+	if (tmpl->isPAL != dv_enc->isPAL || tmpl->is16x9 != dv_enc->is16x9) {
+		_dv_write_frame_template(tmpl->frame, dv_enc->isPAL, 
+					 dv_enc->is16x9);
+		tmpl->isPAL = dv_enc->isPAL;
+		tmpl->is16x9 = dv_enc->is16x9;
+		tmpl->time = (time_t) -1;
+	}
+	return tmpl;
+}
+
+/* The per frame part of the meta data, like _dv_write_meta_data() */
+static void frame_template_write(dv_encoder_t *dv_enc, 
+				 dv_enc_template_t *tmpl,
+				 uint8_t *target, time_t now)
+{
+	int frame = dv_enc->frame_count++;
+
+	if (frame % (dv_enc->isPAL ? 25 : 30) == 0) {
+		now++;
+	}
+	if (now != tmpl->time) {
+		localtime_r(&now, &tmpl->tm);
+		tmpl->time = now;
+	}
+	_dv_write_frame_meta(target, tmpl->frame, frame, dv_enc->isPAL, 
+			     &tmpl->tm);
+}
+
+static void enc_pool_free(dv_enc_pool_t *pool);
+static int encode_videosegment(dv_encoder_t *dv_enc,
+			       dv_videosegment_t *videoseg, uint8_t *vsbuffer,
+			       dv_enc_stats_t * stats, dv_enc_tile_t *tile);
+static int transcode_segment_nr(dv_encoder_t *dv_enc, uint8_t *target, 
+				int n, const enc_adjust_t *adj,
+				dv_enc_stats_t *stats);
+
+static int encode_segment_nr(dv_encoder_t *dv_enc, uint8_t *target, int n,
+			     dv_enc_stats_t * stats, dv_enc_tile_t *tile)
+{
+	dv_videosegment_t videoseg ALIGN64;
+	int ds = n / 27;
+	int v = n % 27;
+
+	videoseg.i = ds;
+	videoseg.k = v;
+	videoseg.isPAL = dv_enc->isPAL;
+
+	/* Each DIF sequence starts with 6 header/subcode/vaux blocks, and
+	   an audio block precedes every 3rd video segment */
+	return encode_videosegment(dv_enc, &videoseg, target +
+				   (ds * 150 + 6 + v / 3 + 1 + v * 5) * 80,
+				   stats, tile);
+}
+
+/* called with pool->mutex held, tile is the calling thread's */
+static void enc_pool_work(dv_enc_pool_t *pool, dv_enc_tile_t *tile)
+{
+	dv_enc_stats_t stats;
+	int worked = 0;
+
+	while (pool->next_seg < pool->num_segs) {
+		int n = pool->next_seg++;
+		int rval;
+
+		if (!worked++)
+			memset(&stats, 0, sizeof(stats));
+		pthread_mutex_unlock(&pool->mutex);
+		if (pool->transcode)
+			rval = transcode_segment_nr(pool->dv_enc, pool->target,
+						    n, pool->adj, &stats);
+		else
+			rval = encode_segment_nr(pool->dv_enc, pool->target, n,
+						 &stats, tile);
+		pthread_mutex_lock(&pool->mutex);
+
+		if (rval < 0)
+			pool->error = 1;
+		if (++pool->segs_done == pool->num_segs)
+			pthread_cond_broadcast(&pool->done_cond);
+	}
+	/* still under the mutex, so the caller sees this once all 
+	   segments are done */
+	if (worked)
+		stats_add(pool->dv_enc->stats, &stats);
+}
+
+static void *enc_pool_thread(void *arg)
+{
+	dv_enc_pool_t *pool = (dv_enc_pool_t *) arg;
+	dv_enc_tile_t *tile;
+	int generation = 0;
+
+	/* without a tile this thread leaves the segments to the others */
+	tile = (dv_enc_tile_t *) malloc(sizeof(dv_enc_tile_t));
+
+	pthread_mutex_lock(&pool->mutex);
+	for (;;) {
+		while (!pool->quit && pool->generation == generation)
+			pthread_cond_wait(&pool->work_cond, &pool->mutex);
+		if (pool->quit)
+			break;
+		generation = pool->generation;
+		if (tile)
+			enc_pool_work(pool, tile);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	free(tile);
+	return NULL;
+}
+
+static dv_enc_pool_t *enc_pool_new(int num_threads)
+{
+	dv_enc_pool_t *pool;
+
+	pool = (dv_enc_pool_t *) calloc(1, sizeof(dv_enc_pool_t));
+	if (!pool) goto no_pool;
+	pool->workers = (pthread_t *) calloc(num_threads - 1, sizeof(pthread_t));
+	if (!pool->workers) goto no_workers;
+	if (pthread_mutex_init(&pool->mutex, NULL)) goto no_mutex;
+	if (pthread_cond_init(&pool->work_cond, NULL)) goto no_work_cond;
+	if (pthread_cond_init(&pool->done_cond, NULL)) goto no_done_cond;
+
+	pool->num_threads = num_threads;
+	for (; pool->num_workers < num_threads - 1; pool->num_workers++) {
+		if (pthread_create(&pool->workers[pool->num_workers], NULL,
+				   enc_pool_thread, pool)) {
+			fprintf(stderr, "libdv(%s): only started %d of %d "
+				"encoder threads\n", __FUNCTION__,
+				pool->num_workers + 1, num_threads);
+			break;
+		}
+	}
+	return pool;
+
+no_done_cond:
+	pthread_cond_destroy(&pool->work_cond);
+no_work_cond:
+	pthread_mutex_destroy(&pool->mutex);
+no_mutex:
+	free(pool->workers);
+no_workers:
+	free(pool);
+no_pool:
+	return NULL;
+}
+
+static void enc_pool_free(dv_enc_pool_t *pool)
+{
+	int i;
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->quit = 1;
+	pthread_cond_broadcast(&pool->work_cond);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (i = 0; i < pool->num_workers; i++)
+		pthread_join(pool->workers[i], NULL);
+
+	pthread_cond_destroy(&pool->done_cond);
+	pthread_cond_destroy(&pool->work_cond);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool->workers);
+	free(pool);
+}
+
+/* Returns the pool for num_threads of the encoder, starting it or
+ * replacing one of another size, or NULL for the calling thread alone. */
+static dv_enc_pool_t *enc_pool_prepare(dv_encoder_t *dv_enc, int num_segs)
+{
+	int num_threads = dv_enc->num_threads;
+
+	if (num_threads < 0)
+		num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (num_threads > num_segs)
+		num_threads = num_segs;
+	if (dv_enc->pool && dv_enc->pool->num_threads != num_threads) {
+		enc_pool_free(dv_enc->pool);
+		dv_enc->pool = NULL;
+	}
+	if (num_threads > 1 && !dv_enc->pool)
+		dv_enc->pool = enc_pool_new(num_threads);
+	return dv_enc->pool;
+}
+
+static int enc_pool_run(dv_enc_pool_t *pool, dv_encoder_t *dv_enc,
+			uint8_t *target, int num_segs, int transcode,
+			const enc_adjust_t *adj)
+{
+	int error;
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->dv_enc = dv_enc;
+	pool->target = target;
+	pool->transcode = transcode;
+	pool->adj = adj;
+	pool->next_seg = 0;
+	pool->num_segs = num_segs;
+	pool->segs_done = 0;
+	pool->error = 0;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->work_cond);
+
+	enc_pool_work(pool, dv_enc->tile);
+	while (pool->segs_done < pool->num_segs)
+		pthread_cond_wait(&pool->done_cond, &pool->mutex);
+	error = pool->error;
+	pthread_mutex_unlock(&pool->mutex);
+
+	return error ? -1 : 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * Pipelined dv_encoder_loop().  A reader thread loads frames (and
+ * their audio) in order into a ring of slots, encoder threads convert
+ * and encode whichever slots are loaded, and the calling thread stores
+ * the encoded frames in order.  Used for input filters that provide
+ * read() and convert().
+ */
+#define DV_ENC_SLOT_FREE     0
+#define DV_ENC_SLOT_LOADED   1
+#define DV_ENC_SLOT_ENCODING 2
+#define DV_ENC_SLOT_DONE     3
+
+typedef struct {
+	int                 state;
+	int                 frame;
+	int                 isPAL;
+	int                 skipped;   /* fps reduction: repeat last frame */
+	unsigned char       *inbuf;
+	dv_encoder_t        *dv_enc;
+	dv_enc_audio_info_t audio_info;
+	unsigned char       target[144000];
+} dv_enc_slot_t;
+
+typedef struct {
+	dv_enc_input_filter_t       *input;
+	dv_enc_audio_input_filter_t *audio_input;
+	const char                  *filename;
+	int                         start, end;
+	int                         isPAL;
+	long                        skip_frames_pal, skip_frames_ntsc;
+
+	dv_enc_slot_t               *slots;
+	int                         num_slots;
+	/* running frame counts of the three stages */
+	int                         loaded, claimed, stored;
+	int                         eof;
+	int                         error;
+	int                         abort;
+	pthread_mutex_t             mutex;
+	pthread_cond_t              cond;
+} dv_enc_pipeline_t;
+
+static void *pipeline_reader(void *arg)
+{
+	dv_enc_pipeline_t *p = (dv_enc_pipeline_t *) arg;
+	long skip_frame_count = 0;
+	int isPAL = p->isPAL;
+	char fbuf[1024];
+	int i, rval = 0;
+
+	for (i = p->start; i <= p->end; i++) {
+		dv_enc_slot_t *slot;
+		long skip_frame_step;
+
+		pthread_mutex_lock(&p->mutex);
+		while (!p->abort && p->loaded - p->stored >= p->num_slots)
+			pthread_cond_wait(&p->cond, &p->mutex);
+		pthread_mutex_unlock(&p->mutex);
+		if (p->abort)
+			break;
+
+		slot = &p->slots[p->loaded % p->num_slots];
+		snprintf(fbuf, 1024, p->filename, i);
+
+		skip_frame_step = isPAL ? p->skip_frames_pal : p->skip_frames_ntsc;
+		skip_frame_count += 65536 - skip_frame_step;
+
+		if (p->audio_input) {
+			if ((rval = p->audio_input->load(&slot->audio_info, isPAL)) < 0)
+				break;
+		}
+		if (skip_frame_count < 65536 || isPAL == -1) {
+			rval = p->input->read(fbuf, &isPAL, slot->inbuf);
+		} else {
+			rval = p->input->skip(fbuf, &isPAL);
+		}
+		if (rval < 0)
+			break;
+
+		slot->frame = i;
+		slot->isPAL = isPAL;
+		slot->skipped = 0;
+		if (skip_frame_count >= 65536) {
+			skip_frame_count -= 65536;
+			slot->skipped = 1;
+		}
+
+		pthread_mutex_lock(&p->mutex);
+		slot->state = DV_ENC_SLOT_LOADED;
+		p->loaded++;
+		pthread_cond_broadcast(&p->cond);
+		pthread_mutex_unlock(&p->mutex);
+	}
+
+	pthread_mutex_lock(&p->mutex);
+	p->eof = 1;
+	if (rval < 0)
+		p->error = 1;
+	pthread_cond_broadcast(&p->cond);
+	pthread_mutex_unlock(&p->mutex);
+	return NULL;
+}
+
+static void *pipeline_encoder(void *arg)
+{
+	dv_enc_pipeline_t *p = (dv_enc_pipeline_t *) arg;
+	dv_enc_stats_t *stats;
+
+	stats = (dv_enc_stats_t *) calloc(1, sizeof(dv_enc_stats_t));
+
+	pthread_mutex_lock(&p->mutex);
+	for (;;) {
+		dv_enc_slot_t *slot;
+		int n, num_segs;
+
+		while (!p->abort && p->claimed == p->loaded && !p->eof)
+			pthread_cond_wait(&p->cond, &p->mutex);
+		if (p->abort || p->claimed == p->loaded)
+			break;
+		slot = &p->slots[p->claimed++ % p->num_slots];
+		slot->state = DV_ENC_SLOT_ENCODING;
+		pthread_mutex_unlock(&p->mutex);
+
+		if (!slot->skipped) {
+			p->input->convert(slot->inbuf, slot->isPAL, slot->dv_enc);
+
+			memset(slot->target, 0, 144000);
+			if (slot->isPAL)
+				slot->target[3] |= 0x80;
+			num_segs = (slot->isPAL ? 12 : 10) * 27;
+			for (n = 0; n < num_segs; n++)
+				encode_segment_nr(slot->dv_enc, slot->target, n,
+						  stats, slot->dv_enc->tile);
+			if (stats) stats->frames++;
+		}
+
+		pthread_mutex_lock(&p->mutex);
+		slot->state = DV_ENC_SLOT_DONE;
+		pthread_cond_broadcast(&p->cond);
+	}
+
+	if (stats) {
+		stats_add(&loop_stats, stats);
+		free(stats);
 	}
+	pthread_mutex_unlock(&p->mutex);
+	return NULL;
 }
 
+static int encoder_pipeline(dv_enc_input_filter_t * input,
+			    dv_enc_audio_input_filter_t * audio_input,
+			    dv_enc_output_filter_t * output,
+			    int start, int end, const char* filename,
+			    int vlc_encode_passes, int static_qno,
+			    int verbose_mode, int fps, int is16x9,
+			    int isPAL, int num_threads, time_t now)
+{
+	dv_enc_pipeline_t p;
+	pthread_t reader;
+	pthread_t *encoders = NULL;
+	int num_encoders = 0;
+	unsigned char *last = NULL;
+	int i, rval = -1;
+
+	memset(&p, 0, sizeof(p));
+	p.input = input;
+	p.audio_input = audio_input;
+	p.filename = filename;
+	p.start = start;
+	p.end = end;
+	p.isPAL = isPAL;
+	p.skip_frames_pal = fps ? fps * 65536 / 25 : 65536;
+	p.skip_frames_ntsc = fps ? fps * 65536 / 30 : 65536;
+	p.num_slots = 2 * num_threads + 2;
+
+	if (pthread_mutex_init(&p.mutex, NULL)) goto no_mutex;
+	if (pthread_cond_init(&p.cond, NULL)) goto no_cond;
+	p.slots = (dv_enc_slot_t *) calloc(p.num_slots, sizeof(dv_enc_slot_t));
+	if (!p.slots) goto no_slots;
+	encoders = (pthread_t *) calloc(num_threads, sizeof(pthread_t));
+	if (!encoders) goto no_threads;
+	last = (unsigned char *) calloc(1, 144000);
+	if (!last) goto no_threads;
+	for (i = 0; i < p.num_slots; i++) {
+		dv_enc_slot_t *slot = &p.slots[i];
+
+		slot->inbuf = (unsigned char *) malloc(input->frame_size);
+		slot->dv_enc = dv_encoder_new(FALSE, FALSE, FALSE);
+		if (!slot->inbuf || !slot->dv_enc) goto no_threads;
+		if (enc_planes_prepare(slot->dv_enc) < 0) goto no_threads;
+		slot->dv_enc->vlc_encode_passes = vlc_encode_passes;
+		slot->dv_enc->static_qno = static_qno;
+	}
+
+	if (pthread_create(&reader, NULL, pipeline_reader, &p)) goto no_threads;
+	for (; num_encoders < num_threads; num_encoders++) {
+		if (pthread_create(&encoders[num_encoders], NULL,
+				   pipeline_encoder, &p))
+			break;
+	}
+	if (!num_encoders) {
+		pthread_mutex_lock(&p.mutex);
+		p.abort = 1;
+		pthread_cond_broadcast(&p.cond);
+		pthread_mutex_unlock(&p.mutex);
+		pthread_join(reader, NULL);
+		goto no_threads;
+	}
+
+	rval = 0;
+	for (;;) {
+		dv_enc_slot_t *slot;
+
+		pthread_mutex_lock(&p.mutex);
+		while (!(p.stored < p.loaded 
+			 && p.slots[p.stored % p.num_slots].state 
+			 == DV_ENC_SLOT_DONE)
+		       && !(p.eof && p.stored == p.loaded))
+			pthread_cond_wait(&p.cond, &p.mutex);
+		if (p.stored == p.loaded) {
+			if (p.error) rval = -1;
+			pthread_mutex_unlock(&p.mutex);
+			break;
+		}
+		slot = &p.slots[p.stored % p.num_slots];
+		pthread_mutex_unlock(&p.mutex);
+
+		if (slot->skipped) {
+			memcpy(slot->target, last, 144000);
+		}
+		if (output->store(slot->target, 
+				  audio_input ? &slot->audio_info : NULL, 
+				  FALSE, slot->isPAL, is16x9, now) < 0) {
+			rval = -1;
+			break;
+		}
+		memcpy(last, slot->target, 144000);
+		if (verbose_mode) {
+			if (slot->skipped) {
+				fprintf(stderr, "_%d_ ", slot->frame);
+			} else {
+				fprintf(stderr, "[%d] ", slot->frame);
+			}
+		}
+
+		pthread_mutex_lock(&p.mutex);
+		slot->state = DV_ENC_SLOT_FREE;
+		p.stored++;
+		pthread_cond_broadcast(&p.cond);
+		pthread_mutex_unlock(&p.mutex);
+	}
+
+	pthread_mutex_lock(&p.mutex);
+	p.abort = 1;
+	pthread_cond_broadcast(&p.cond);
+	pthread_mutex_unlock(&p.mutex);
+	pthread_join(reader, NULL);
+	for (i = 0; i < num_encoders; i++)
+		pthread_join(encoders[i], NULL);
+
+no_threads:
+	for (i = 0; i < p.num_slots; i++) {
+		if (p.slots[i].inbuf) free(p.slots[i].inbuf);
+		if (p.slots[i].dv_enc) dv_encoder_free(p.slots[i].dv_enc);
+	}
+	if (last) free(last);
+	if (encoders) free(encoders);
+	free(p.slots);
+no_slots:
+	pthread_cond_destroy(&p.cond);
+no_cond:
+	pthread_mutex_destroy(&p.mutex);
+no_mutex:
+	if (rval < 0 && !p.loaded && !p.eof)
+		fprintf(stderr, "libdv(%s): could not set up the encoder "
+			"pipeline\n", __FUNCTION__);
+	return rval;
+}
 
 /****** public encoder implementation ***********************************/
 /* By Dan Dennedy <dan@dennedy.org> */
@@ -1536,12 +2176,10 @@ dv_encoder_new(int ignored, int clamp_luma, int clamp_chroma) {
   
   dv_init( clamp_luma, clamp_chroma);
 
-  result->img_y = (short*) calloc(DV_PAL_HEIGHT * DV_WIDTH, sizeof(short));
-  if(!result->img_y) goto no_y;
-  result->img_cr = (short*) calloc(DV_PAL_HEIGHT * DV_WIDTH / 2, sizeof(short));
-  if(!result->img_cr) goto no_cr;
-  result->img_cb = (short*) calloc(DV_PAL_HEIGHT * DV_WIDTH / 2, sizeof(short));
-  if(!result->img_cb) goto no_cb;
+  result->stats = (dv_encoder_stats_t*) calloc(1, sizeof(dv_encoder_stats_t));
+  if(!result->stats) goto no_stats;
+  result->tile = (dv_enc_tile_t*) malloc(sizeof(dv_enc_tile_t));
+  if(!result->tile) goto no_tile;
 
   result->rem_ntsc_setup = FALSE;
   result->clamp_luma = clamp_luma;
@@ -1551,11 +2189,9 @@ dv_encoder_new(int ignored, int clamp_luma, int clamp_chroma) {
   result->frame_count = 0;
   return(result);
   
-no_cb:
-  free(result->img_cb);
-no_cr:
-  free(result->img_y);
-no_y:
+no_tile:
+  free(result->stats);
+no_stats:
   free(result);
   
   return(NULL);
@@ -1577,53 +2213,41 @@ dv_encoder_free( dv_encoder_t *encoder)
     if (encoder->img_y != NULL) free(encoder->img_y);
     if (encoder->img_cr != NULL) free(encoder->img_cr);
     if (encoder->img_cb != NULL) free(encoder->img_cb);
+    if (encoder->pool != NULL) enc_pool_free(encoder->pool);
+    if (encoder->seg_cache != NULL) free(encoder->seg_cache);
+    if (encoder->frame_template != NULL) free(encoder->frame_template);
+    if (encoder->stats != NULL) free(encoder->stats);
+    if (encoder->tile != NULL) free(encoder->tile);
     free(encoder);
   }
 } /* dv_encoder_free */
 
-/** @brief call dv_cleanup() automatically
- *
- * This function calls dv_cleanup() automatically before a dynamic
- * libdv is unloaded.
- * This fixes potential memory leaks when repeatedly loading 
- * and unloading libdv.
- */
-
-static void do_free() __attribute__ ((destructor));
-
-static void do_free() {
-  dv_cleanup();
-} /* do_free */
-
 /** @brief Free the dynamically allocated global memory.
  *
- * This function deallocates the memory allocated by dv_init().
+ * All lookup tables are now static const data, so there is nothing
+ * left to free.  Kept for API compatibility.
  *
  */
 void dv_cleanup(void) {
-  /* the encoder allocates mem on the heap and must be free-ed */
-  if (vlc_encode_lookup != NULL) {
-    free(vlc_encode_lookup);
-    vlc_encode_lookup = NULL;
-  }
-  if (vlc_num_bits_lookup != NULL) {
-    free(vlc_num_bits_lookup);
-    vlc_num_bits_lookup = NULL;
-  }
 } /* dv_cleanup */
 
 
-int dv_encode_videosegment( dv_encoder_t *dv_enc,
-				dv_videosegment_t *videoseg, uint8_t *vsbuffer)
+static int encode_videosegment(dv_encoder_t *dv_enc,
+			       dv_videosegment_t *videoseg, uint8_t *vsbuffer,
+			       dv_enc_stats_t * stats, dv_enc_tile_t *tile)
 {
 	dv_macroblock_t *mb;
 	int m;
-	unsigned int b;
-	dv_vlc_block_t vlc_block[5*6];
+	dv_enc_seg_cache_t *cache = dv_enc->in ? dv_enc->seg_cache : NULL;
+	int seg = videoseg->i * 27 + videoseg->k;
+	double t = 0;
+	int timing = stats && dv_enc->stage_timing;
 
+	if (timing) stage_done(stats, DV_ENC_STAGE_CONVERT, &t);
 	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
 		mb->vlc_error = 0;
 		mb->eob_count = 0;
+		mb->qno = 15;
 		mb->i = (videoseg->i+ dv_super_map_vertical[m]) 
 			% (videoseg->isPAL ? 12 : 10);
 		mb->j = dv_super_map_horizontal[m];
@@ -1634,107 +2258,167 @@ int dv_encode_videosegment( dv_encoder_t *dv_enc,
 		} else {
 			dv_place_411_macroblock(mb);
 		}
-		_dv_ycb_fill_macroblock(dv_enc, mb);
-		do_dct(mb);
-		do_classify(mb, dv_enc->static_qno);
+		_dv_ycb_prefetch_macroblock(dv_enc, mb);
 	}
+	if (cache) {
+		uint64_t sum = seg;
 
-#if 0
-	for (m = 0; m < 5; m++) {
-		dv_vlc_block_t *v_bl = vlc_block;
-		for (b = 0; b < 6; b++) {
-			v_bl->bit_offset = (8* (80 * m))+dv_parse_bit_start[b];
-			v_bl->bit_budget = (b < 4) ? 100 : 68;
-			v_bl++;
+		for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
+			sum = _dv_ycb_checksum_macroblock(dv_enc, mb, sum);
+		}
+		if (cache->valid[seg] && cache->sums[seg] == sum) {
+			memcpy(vsbuffer, cache->segs[seg], 5 * 80);
+			_dv_write_video_segment_headers(vsbuffer, 
+				dv_enc->frame_count, videoseg->i, videoseg->k);
+			if (stats) stats->segs_skipped++;
+			if (timing) stage_done(stats, DV_ENC_STAGE_CONVERT, &t);
+			return 0;
 		}
+		cache->sums[seg] = sum;
+		cache->valid[seg] = 0;
 	}
-#endif
-
-	switch (dv_enc->vlc_encode_passes) {
-	case 1:
-		quant_1_pass(videoseg, vlc_block, dv_enc->static_qno);
-		break;
-	case 2:
-		quant_2_passes(videoseg, vlc_block, dv_enc->static_qno);
-		break;
-	case 3:
-		quant_3_passes(videoseg, vlc_block, dv_enc->static_qno);
-		break;
-	default:
-		fprintf(stderr, "Invalid value for vlc_encode_passes "
-			"specified: %d!\n", dv_enc->vlc_encode_passes);
-		exit(-1);
+	if (dv_enc->in) {
+		/* dv_encode_full_frame() leaves the clearing of the video
+		   blocks to us, put_bits() ors into them */
+		for (m = 0; m < 5; m++) {
+			memset(vsbuffer + m * 80 + 3, 0, 80 - 3);
+		}
+		_dv_write_video_segment_headers(vsbuffer, dv_enc->frame_count,
+						videoseg->i, videoseg->k);
 	}
-
 	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
-		put_bits(vsbuffer, (8 * (80 * m)) + 28, 4, mb->qno);
-		
-		for (b = 0; b < 6; b++) {
-			dv_block_t *bl = &mb->b[b];
-			dv_vlc_block_t *v_bl = vlc_block + m*6 + b;
+		_dv_ycb_fill_macroblock(dv_enc, mb, tile);
+		if (timing) stage_done(stats, DV_ENC_STAGE_CONVERT, &t);
+		do_dct(mb, stats);
+		if (timing) stage_done(stats, DV_ENC_STAGE_DCT, &t);
+		do_classify(mb, dv_enc->static_qno, stats);
+		if (timing) stage_done(stats, DV_ENC_STAGE_CLASSIFY, &t);
+	}
 
-			v_bl->bit_offset = (8* (80 * m))+dv_parse_bit_start[b];
-			v_bl->bit_budget = (b < 4) ? 100 : 68;
+	pack_videosegment(videoseg, vsbuffer, dv_enc->vlc_encode_passes,
+			  dv_enc->static_qno, stats, timing ? &t : NULL);
 
-			put_bits(vsbuffer, v_bl->bit_offset - 12,
-				 12, (bl->coeffs[0] << 3) | (bl->dct_mode << 2)
-				 | bl->class_no);
-			vlc_encode_block_pass_1(v_bl, vsbuffer, 
-						dv_enc->vlc_encode_passes);
-		}
-		vlc_encode_block_pass_n(vlc_block + m * 6, vsbuffer, 
-					dv_enc->vlc_encode_passes, 2);
+	if (cache) {
+		memcpy(cache->segs[seg], vsbuffer, 5 * 80);
+		cache->valid[seg] = 1;
 	}
-	vlc_encode_block_pass_n(vlc_block, vsbuffer, dv_enc->vlc_encode_passes, 3);
-
 	return 0;
 }
 
-/* ---------------------------------------------------------------------------
- */
-static void
-yuy2_to_ycb( uint8_t *data, int isPAL, short *img_y, short *img_cr, short *img_cb)
+int dv_encode_videosegment( dv_encoder_t *dv_enc,
+				dv_videosegment_t *videoseg, uint8_t *vsbuffer)
 {
-	register int total = (DV_WIDTH * (isPAL ? DV_PAL_HEIGHT : DV_NTSC_HEIGHT)) >> 1;
-	register int i;
-	register uint8_t *p = data;
-
-	for (i = 0; i < total; i++) {
-		img_y[i*2]   = (((short) *p++) - 128) << DCT_YUV_PRECISION;
-		img_cb[i]    = (((short) *p++) - 128) << DCT_YUV_PRECISION;
-		img_y[i*2+1] = (((short) *p++) - 128) << DCT_YUV_PRECISION;
-		img_cr[i]    = (((short) *p++) - 128) << DCT_YUV_PRECISION;
+	if (!dv_enc->in && enc_planes_prepare(dv_enc) < 0) {
+		return -1;
 	}
+	return encode_videosegment(dv_enc, videoseg, vsbuffer, NULL,
+				   dv_enc->tile);
 }
 
+/* replaces out of range settings with the defaults */
+static void enc_check_settings(dv_encoder_t *dv_enc)
+{
+	if (dv_enc->vlc_encode_passes < 1 || dv_enc->vlc_encode_passes > 3)
+		dv_enc->vlc_encode_passes = 3;
+	if (dv_enc->static_qno < 1 || dv_enc->static_qno > 2)
+		dv_enc->static_qno = 0;
+	if (dv_enc->force_dct < DV_DCT_AUTO || dv_enc->force_dct > DV_DCT_248)
+		dv_enc->force_dct = DV_DCT_AUTO;
+}
 
-#ifdef YUV_420_USE_YV12
 /* ---------------------------------------------------------------------------
+ * Speed presets.  The rungs run from the best pictures to the fastest
+ * encoding; a textured PAL frame on one 3 GHz x86-64 core takes about
+ * 9.3, 7.0, 6.6 and 5.2 ms on them.  The presets name rungs 0, 1 and 3,
+ * and target_fps climbs the whole ladder.
  */
-static void
-yv12_to_ycb( uint8_t **in, int isPAL, short *img_y, short *img_cr, short *img_cb)
+static const struct {
+	int vlc_encode_passes;
+	int static_qno;
+	int force_dct;
+	int skip_static;
+} enc_presets[] = {
+	{ 3, 0, DV_DCT_AUTO, 0 },
+	{ 2, 1, DV_DCT_AUTO, 0 },
+	{ 2, 1, DV_DCT_88,   1 },
+	{ 1, 0, DV_DCT_88,   1 },
+};
+
+#define DV_ENC_NUM_PRESET_LEVELS \
+	((int) (sizeof(enc_presets) / sizeof(enc_presets[0])))
+
+static void enc_apply_preset_level(dv_encoder_t *dv_enc, int level)
 {
-	register int total = DV_WIDTH * (isPAL ? DV_PAL_HEIGHT : DV_NTSC_HEIGHT);
-	register int i, j, k;
-	
-	
-	for (i = 0; i < total; i++) img_y[i]   = (((short) in[0][i]) - 128) << DCT_YUV_PRECISION;
-	
-	for (i = 0; i < (isPAL ? DV_PAL_HEIGHT : DV_NTSC_HEIGHT)/2; ++i) {
-	  for (j = 0; j < DV_WIDTH/2 ; j++) {
-	    
-	    k = i * DV_WIDTH/2 + j;
-	    
-	    img_cb[2*i*DV_WIDTH/2+j]    = (((short) in[1][k]) - 128) << DCT_YUV_PRECISION;
-	    img_cr[2*i*DV_WIDTH/2+j]    = (((short) in[2][k]) - 128) << DCT_YUV_PRECISION;
-	    img_cb[(2*i+1)*DV_WIDTH/2+j]    = (((short) in[1][k]) - 128) << DCT_YUV_PRECISION;
-	    img_cr[(2*i+1)*DV_WIDTH/2+j]    = (((short) in[2][k]) - 128) << DCT_YUV_PRECISION;
-	  }//col-j
-	}//row-i
+	dv_enc->preset_level = level;
+	dv_enc->vlc_encode_passes = enc_presets[level].vlc_encode_passes;
+	dv_enc->static_qno = enc_presets[level].static_qno;
+	dv_enc->force_dct = enc_presets[level].force_dct;
+	dv_enc->skip_static = enc_presets[level].skip_static;
+	dv_enc->frame_seconds = 0;
+	dv_enc->fast_frames = 0;
+}
 
+/* Steps down the ladder as soon as the frames take more than 90% of
+ * the time target_fps allows, and back up after two seconds' worth of
+ * frames that took less than 60% of it. */
+static void enc_adapt_to_target_fps(dv_encoder_t *dv_enc, double seconds)
+{
+	double budget = 1.0 / dv_enc->target_fps;
+
+	dv_enc->frame_seconds = dv_enc->frame_seconds 
+		? 0.75 * dv_enc->frame_seconds + 0.25 * seconds : seconds;
+	if (dv_enc->frame_seconds > 0.9 * budget) {
+		if (dv_enc->preset_level < DV_ENC_NUM_PRESET_LEVELS - 1)
+			enc_apply_preset_level(dv_enc, dv_enc->preset_level + 1);
+		dv_enc->fast_frames = 0;
+	} else if (dv_enc->frame_seconds < 0.6 * budget) {
+		if (++dv_enc->fast_frames >= 2 * dv_enc->target_fps
+		    && dv_enc->preset_level > 0)
+			enc_apply_preset_level(dv_enc, dv_enc->preset_level - 1);
+	} else {
+		dv_enc->fast_frames = 0;
+	}
 }
-#endif
 
+/** @brief Set the speed of an encoder with a named preset.
+ *
+ * Sets vlc_encode_passes, static_qno, force_dct and skip_static to
+ * one of:
+ *   - DV_ENC_PRESET_BEST: 3 VLC passes and the automatic 2-4-8 DCT;
+ *     the defaults.
+ *   - DV_ENC_PRESET_BALANCED: 2 VLC passes with the static qno table
+ *     for sharp pictures, about 1.3 times as fast.
+ *   - DV_ENC_PRESET_REALTIME: 1 VLC pass, 8x8 DCT only and skip_static,
+ *     about 1.8 times as fast and much faster still on still input.
+ *
+ * With target_fps set, dv_encode_full_frame() measures its own time
+ * per frame and moves between these settings, starting from the last
+ * preset set, to keep up with that many frames per second.  More
+ * threads (num_threads) are the bigger lever on multi-core machines.
+ *
+ * @param dv_enc A pointer to a dv_encoder_t structure
+ * @param preset One of the dv_enc_preset_t values
+ * @return -1 for an unknown preset, 0 for success
+ */
+int dv_encoder_set_preset(dv_encoder_t *dv_enc, dv_enc_preset_t preset)
+{
+	switch (preset) {
+	case DV_ENC_PRESET_BEST:
+		enc_apply_preset_level(dv_enc, 0);
+		break;
+	case DV_ENC_PRESET_BALANCED:
+		enc_apply_preset_level(dv_enc, 1);
+		break;
+	case DV_ENC_PRESET_REALTIME:
+		enc_apply_preset_level(dv_enc, DV_ENC_NUM_PRESET_LEVELS - 1);
+		break;
+	default:
+		fprintf(stderr, "Invalid value for preset specified: %d!\n",
+			(int) preset);
+		return -1;
+	}
+	return 0;
+}
 
 /** @brief DV encode a buffer containing a frame of video
  * 
@@ -1756,181 +2440,593 @@ yv12_to_ycb( uint8_t **in, int isPAL, short *img_y, short *img_cr, short *img_cb
  *          the level of interfield motion in interlaced video in order to
  *          the best configuration of the DCT algorithm. This option forces
  *          a particular one. Use DV_DCT_AUTO(-1), DV_DCT_88(0), or DV_DCT_248(1).
- * @param in An array of buffers. YUV/YUY2 and RGB only require
- *          one entry. If you configured YUV for YV12. Then 3 array entries
- *          correspond to pointers to the Y (luma) buffer, Cb and Cr (chroma)
- *          buffers.
+ *        -num_threads Encode the video segments of the frame on this many
+ *          threads, the calling one included. Negative values use one
+ *          thread per online CPU, 0 or 1 encodes in the calling thread only.
+ *          The threads are kept for subsequent frames until the encoder is
+ *          freed or the setting changes.
+ *        -skip_static Set true (non-zero) for input that is often still,
+ *          like screen recordings and slates: the input under each video
+ *          segment is checksummed, and the compressed segment of the
+ *          previous frame is reused when it did not change.  The
+ *          statistics of the encoder tell how often that happened.
+ *        -stage_timing Set true (non-zero) to add the time spent in each
+ *          stage of the encoder to its statistics, see
+ *          dv_encoder_get_stats().
+ *        -target_fps Adapt the speed settings to encode this many frames
+ *          per second, see dv_encoder_set_preset().
+ * @param in An array of buffers. YUY2 (e_dv_color_yuv) and RGB (24 bit,
+ *          BGR0 or RGBA) only require one entry. I420 and YV16 take the
+ *          Y plane and the two chroma planes in the order of their names
+ *          (Cb, Cr for I420 and Cr, Cb for YV16), NV12 the Y plane and
+ *          the interleaved CbCr plane.  Builds configured with
+ *          YUV_420_USE_YV12 read e_dv_color_yuv as I420.
  * @param color_space Indicates which color space and sample pattern
  *          of the data in the \c in parameter.
- * @param out A pointer to the output buffer, which should alreayd be
- *          allocated width*height*2 bytes. The function will clear the buffer
- *          before filling it.
+ * @param out A pointer to the output buffer, which should already be
+ *          allocated, 144000 bytes for PAL and 120000 bytes for NTSC.
+ *          Every byte of the frame is written, so the output does not
+ *          depend on what the buffer held before; the buffer is not
+ *          cleared first.
  * @return -1 for failure, 0 for success
  */
 int dv_encode_full_frame(dv_encoder_t *dv_enc, uint8_t **in,
 			dv_color_space_t color_space, uint8_t *out)
 {
-	dv_videosegment_t videoseg ALIGN64;
-	int numDIFseq;
-	int ds, v, i;
-	unsigned int dif = 0;
-	unsigned int offset = 0;
+	return dv_encode_full_frame_pitched(dv_enc, in, NULL, color_space, out);
+}
+
+/** @brief DV encode a frame of video whose lines are not packed
+ *
+ * Like dv_encode_full_frame(), for input whose planes have their own
+ * distance between the starts of two lines, as capture devices deliver
+ * them.
+ *
+ * @param pitches The line pitch in bytes of each buffer in \c in, or
+ *          NULL for packed lines.
+ */
+int dv_encode_full_frame_pitched(dv_encoder_t *dv_enc, uint8_t **in,
+				 int *pitches, dv_color_space_t color_space,
+				 uint8_t *out)
+{
+	int num_segs;
+	int n;
 	uint8_t *target = out;
+	dv_enc_template_t *tmpl;
 	time_t now;
-	static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	double start = 0;
 	
 	now = time(NULL);
-	if (dv_enc->vlc_encode_passes < 1 || dv_enc->vlc_encode_passes > 3)
-		dv_enc->vlc_encode_passes = 3;
-	if (dv_enc->static_qno < 1 || dv_enc->static_qno > 2)
-		dv_enc->static_qno = 0;
-	if (dv_enc->force_dct < DV_DCT_AUTO || dv_enc->force_dct > DV_DCT_248)
-		dv_enc->force_dct = DV_DCT_AUTO;
-
-	memset(out, 0, 480 * (dv_enc->isPAL ? 300 : 250));
+	if (dv_enc->target_fps > 0)
+		start = enc_seconds();
+	enc_check_settings(dv_enc);
 
-	pthread_mutex_lock(&mutex);
+#ifdef YUV_420_USE_YV12
+	if (color_space == e_dv_color_yuv)
+		color_space = e_dv_color_i420;
+#endif
 	switch (color_space) {
 	case e_dv_color_rgb:
-		dv_enc_rgb_to_ycb(in[0], (dv_enc->isPAL ? DV_PAL_HEIGHT : DV_NTSC_HEIGHT),
-			dv_enc->img_y, dv_enc->img_cr, dv_enc->img_cb);
+		dv_enc->in_pitches[0] = DV_WIDTH * 3;
+		break;
+	case e_dv_color_bgr0:
+	case e_dv_color_rgba:
+		dv_enc->in_pitches[0] = DV_WIDTH * 4;
 		break;
 	case e_dv_color_yuv:
-#ifndef YUV_420_USE_YV12
-		yuy2_to_ycb( in[0], dv_enc->isPAL, dv_enc->img_y, dv_enc->img_cr, dv_enc->img_cb);
-#else
-		yv12_to_ycb( in, dv_enc->isPAL, dv_enc->img_y, dv_enc->img_cr, dv_enc->img_cb);
-#endif
+		dv_enc->in_pitches[0] = DV_WIDTH * 2;
+		break;
+	case e_dv_color_i420:
+	case e_dv_color_yv16:
+		dv_enc->in_pitches[0] = DV_WIDTH;
+		dv_enc->in_pitches[1] = DV_WIDTH / 2;
+		dv_enc->in_pitches[2] = DV_WIDTH / 2;
+		break;
+	case e_dv_color_nv12:
+		dv_enc->in_pitches[0] = DV_WIDTH;
+		dv_enc->in_pitches[1] = DV_WIDTH;
 		break;
 	default:
 		fprintf(stderr, "Invalid value for color_space "
 			"specified: %d!\n", (int) color_space);
-		pthread_mutex_unlock(&mutex);
 		return -1;
 	}
+	if (pitches) {
+		int planes = (color_space == e_dv_color_nv12) ? 2
+			: (color_space == e_dv_color_i420 
+			   || color_space == e_dv_color_yv16) ? 3 : 1;
+
+		for (n = 0; n < planes; n++) {
+			dv_enc->in_pitches[n] = pitches[n];
+		}
+	}
+
+	/* The input is converted, conditioned and clamped macroblock by
+	   macroblock as the segments are encoded, see
+	   _dv_ycb_fill_macroblock() */
+	dv_enc->in = in;
+	dv_enc->in_color_space = color_space;
+
+	/* Only the video segments and the counters, timecode and date
+	   change from frame to frame; the rest comes from the template */
+	tmpl = frame_template_prepare(dv_enc);
+	if (!tmpl) {
+		memset(out, 0, 480 * (dv_enc->isPAL ? 300 : 250));
+	}
+
+	num_segs = (dv_enc->isPAL ? 12 : 10) * 27;
+
+	if (!dv_enc->skip_static) {
+		if (dv_enc->seg_cache) {
+			/* the segments go stale while skip_static is off */
+			free(dv_enc->seg_cache);
+			dv_enc->seg_cache = NULL;
+		}
+	} else if (seg_cache_prepare(dv_enc) < 0) {
+		fprintf(stderr, "libdv(%s): out of memory, encoding every "
+			"video segment\n", __FUNCTION__);
+	}
+
+	if (enc_pool_prepare(dv_enc, num_segs)) {
+		if (enc_pool_run(dv_enc->pool, dv_enc, target, num_segs, 
+				 0, NULL) < 0) {
+			fprintf(stderr, "Enocder failed to process video segment.");
+			dv_enc->in = NULL;
+			return -1;
+		}
+	} else {
+		/* A video segment consists of 5 video blocks, where each
+		   video block contains one compressed macroblock.  DV bit
+		   allocation for the VLC stage can spill bits between blocks
+		   in the same video segment.  So parsing needs the whole
+		   segment to decode the VLC data */
+		for (n = 0; n < num_segs; n++) {
+			if (encode_segment_nr(dv_enc, target, n, 
+					      dv_enc->stats, dv_enc->tile) < 0) {
+				fprintf(stderr, "Enocder failed to process video segment.");
+				dv_enc->in = NULL;
+				return -1;
+			}
+		}
+	}
+	dv_enc->in = NULL;
 	
-	if (dv_enc->isPAL == FALSE && dv_enc->rem_ntsc_setup == TRUE) {
-		for (i = 0;
-			i < (DV_WIDTH * (dv_enc->isPAL ? DV_PAL_HEIGHT : DV_NTSC_HEIGHT));
-			dv_enc->img_y[i++] -= (32) );
+	if (dv_enc->stage_timing) {
+		double t = 0;
+
+		stage_done(dv_enc->stats, DV_ENC_STAGE_META, &t);
+		if (tmpl) {
+			frame_template_write(dv_enc, tmpl, target, now);
+		} else {
+			_dv_write_meta_data(target, dv_enc->frame_count++, dv_enc->isPAL, dv_enc->is16x9, &now);
+		}
+		stage_done(dv_enc->stats, DV_ENC_STAGE_META, &t);
+	} else if (tmpl) {
+		frame_template_write(dv_enc, tmpl, target, now);
+	} else {
+		_dv_write_meta_data(target, dv_enc->frame_count++, dv_enc->isPAL, dv_enc->is16x9, &now);
 	}
-			
-	/* -224 = (16-128)*2
-	    214 = (235-128)*2
-	*/
-	if (dv_enc->clamp_luma == TRUE) {
-		for (i = 0;
-			i < (DV_WIDTH * (dv_enc->isPAL ? DV_PAL_HEIGHT : DV_NTSC_HEIGHT));
-			i++ )
-				dv_enc->img_y[i] = CLAMP(dv_enc->img_y[i], -224, 214);
+	dv_enc->stats->frames++;
+
+	if (dv_enc->target_fps > 0)
+		enc_adapt_to_target_fps(dv_enc, enc_seconds() - start);
+
+	return 0;
+}
+
+/** @brief Get the statistics of an encoder.
+ *
+ * The counters cover all frames since dv_encoder_new() or the last
+ * dv_encoder_reset_stats().  Do not call this while the encoder is
+ * working on a frame.
+ *
+ * @param dv_enc A pointer to a dv_encoder_t structure
+ * @param stats Filled with a copy of the statistics
+ */
+void dv_encoder_get_stats(dv_encoder_t *dv_enc, dv_encoder_stats_t *stats)
+{
+	*stats = *dv_enc->stats;
+}
+
+/** @brief Set the statistics of an encoder back to zero.
+ *
+ * @param dv_enc A pointer to a dv_encoder_t structure
+ */
+void dv_encoder_reset_stats(dv_encoder_t *dv_enc)
+{
+	memset(dv_enc->stats, 0, sizeof(dv_encoder_stats_t));
+}
+
+/** @brief Print encoder statistics in the format of encodedv --verbose.
+ *
+ * @param stats Statistics from dv_encoder_get_stats()
+ * @param f Where to print them, e.g. stderr
+ */
+void dv_encoder_print_stats(const dv_encoder_stats_t *stats, FILE *f)
+{
+	const dv_encoder_stats_t *st = stats;
+	long segs = st->segs_encoded + st->segs_skipped;
+	double total = 0;
+	int i = 0;
+
+	fprintf(f, "\n\nFinal statistics:\n"
+		"========================================================\n"
+		"\n  |CYCLES    |RUNS/CYCLE|QNOS     |CLASS    "
+		"|VLC OVERF|DCT\n"
+		"========================================================\n");
+	fprintf(f, "%2d: %8ld |%8ld  |%8ld |%8ld |%8ld "
+		"|%8ld (DCT88)\n", 
+		i, st->cycles_used[i], st->runs_used[i], st->qnos_used[i],
+		st->classes_used[i], st->vlc_overflows, st->dct_used[DV_DCT_88]);
+	i++;
+	fprintf(f, "%2d: %8ld |%8ld  |%8ld |%8ld |         "
+		"|%8ld (DCT248)\n", 
+		i, st->cycles_used[i], st->runs_used[i], st->qnos_used[i],
+		st->classes_used[i], 
+		st->dct_used[DV_DCT_248]);
+	i++;
+	for (;i < 4; i++) {
+		fprintf(f, "%2d: %8ld |%8ld  |%8ld |%8ld |         |\n", 
+			i, st->cycles_used[i], st->runs_used[i], st->qnos_used[i],
+			st->classes_used[i]);
 	}
-		
-	/* -224 = (16-128)*2
-	    224 = (240-128)*2
-	*/
-	if (dv_enc->clamp_chroma == TRUE) {
-		for (i = 0;
-			i < (DV_WIDTH * (dv_enc->isPAL ? DV_PAL_HEIGHT : DV_NTSC_HEIGHT) >> 2);
-			i++ ) {
-			dv_enc->img_cb[i] = CLAMP(dv_enc->img_cb[i], -224, 224);
-			dv_enc->img_cr[i] = CLAMP(dv_enc->img_cr[i], -224, 224);
+	for (;i < 16; i++) {
+		fprintf(f, "%2d: %8ld |%8ld  |%8ld |         "
+			"|         |\n", 
+			i, st->cycles_used[i], st->runs_used[i], st->qnos_used[i]);
+	}
+
+	fprintf(f, "\nFrames: %ld, video segments: %ld encoded, "
+		"%ld skipped (%.1f%%)\n", st->frames, st->segs_encoded,
+		st->segs_skipped, segs ? 100.0 * st->segs_skipped / segs : 0.0);
+	if (st->bits_budget) {
+		fprintf(f, "AC bits: %" PRId64 " of %" PRId64 " (%.1f%%)\n",
+			st->bits_used, st->bits_budget, 
+			100.0 * st->bits_used / st->bits_budget);
+	}
+	for (i = 0; i < DV_ENC_NUM_STAGES; i++) {
+		total += st->stage_seconds[i];
+	}
+	if (total > 0) {
+		static const char *names[DV_ENC_NUM_STAGES] = {
+			"convert", "DCT", "classify", "quantise", "VLC pack",
+			"metadata"
+		};
+		fprintf(f, "Stage times (ms/frame):");
+		for (i = 0; i < DV_ENC_NUM_STAGES; i++) {
+			fprintf(f, " %s %.3f", names[i], st->frames ? 
+				1000.0 * st->stage_seconds[i] / st->frames : 0.0);
 		}
+		fprintf(f, "\n");
 	}
+}
 
-	if (dv_enc->isPAL) 
-		target[offset + 3] |= 0x80;
+/* ---------------------------------------------------------------------------
+ * DV to DV transcoding.  The video segments are parsed to quantised
+ * coefficients, which are scaled back to the encoder's coefficient
+ * domain and then quantised and packed again with the settings of the
+ * encoder, without (i)DCT or pixel conversion.  The blocks keep their
+ * DCT modes and classes, and no macroblock gets a finer quantiser than
+ * it had: the source holds no more detail than that, and coarser
+ * quantisers keep the amplitudes within reach of the VLC tables.
+ */
 
-	numDIFseq = dv_enc->isPAL ? 12 : 10;
-	
-	for (ds = 0; ds < numDIFseq; ds++) { 
-		/* Each DIF segment conists of 150 dif blocks, 
-		   135 of which are video blocks */
-		/* skip the first 6 dif blocks in a dif sequence */
-		dif += 6; 
+/* Scales the quantised coefficients of a parsed block back and puts
+ * them in zigzag order, as the encoder keeps them */
+static void dequantize_block(dv_block_t *bl, int qno)
+{
+	const uint8_t *pq = dv_quant_shifts[qno + dv_quant_offset[bl->class_no]];
+	int extra = (bl->class_no == 3);
+	const int8_t *reorder = dv_reorder[bl->dct_mode];
+	dv_coeff_t zz[64];
+	int i;
 
-		/* A video segment consists of 5 video blocks, where each video
-		   block contains one compressed macroblock.  DV bit allocation
-		   for the VLC stage can spill bits between blocks in the same
-		   video segment.  So parsing needs the whole segment to decode
-		   the VLC data */
-		/* Loop through video segments */
-		for (v = 0; v < 27; v++) {
-			/* skip audio block -
-			   interleaved before every 3rd video segment
-			*/
+	zz[0] = bl->coeffs[0];
+	for (i = 1; i < 64; i++) {
+		int area = (i < 6) ? 0 : (i < 21) ? 1 : (i < 43) ? 2 : 3;
+#if ZERO_MULT_ZIGZAG
+		int pos = reorder[i] / sizeof(dv_coeff_t);
+#else
+		int pos = reorder[i];
+#endif
+		zz[i] = bl->coeffs[pos] << (pq[area] + extra);
+	}
+	memcpy(bl->coeffs, zz, sizeof(zz));
+}
 
-			if(!(v % 3)) dif++; 
+/* Compressed domain picture adjustment: the luma is scaled by gain
+ * around black and then shifted by luma_offset, the chroma is scaled by
+ * gain.  gain is in 1/4096 and at most 4096, so that the amplitudes
+ * never grow. */
+struct enc_adjust_s {
+	int gain;
+	int luma_offset;
+};
 
-			offset = dif * 80;
-			
-			videoseg.i = ds;
-			videoseg.k = v;
-			videoseg.isPAL = dv_enc->isPAL;
+#define ADJUST_ONE 4096
+/* twice the black level minus 128, the DC of a black block */
+#define ADJUST_BLACK_DC (2 * (16 - 128))
 
-			if (dv_encode_videosegment(dv_enc, &videoseg, target + offset) < 0) {
-				fprintf(stderr, "Enocder failed to process video segment.");
-				pthread_mutex_unlock(&mutex);
-				return -1;
+static inline int adjust_scale(int x, int gain)
+{
+	return (x >= 0) ? (x * gain + ADJUST_ONE / 2) >> 12 
+		: -((-x * gain + ADJUST_ONE / 2) >> 12);
+}
+
+/* Applies adj to the dequantised coefficients of a video segment,
+ * returns whether anything changed */
+static int adjust_videosegment(dv_videosegment_t *videoseg, 
+			       const enc_adjust_t *adj)
+{
+	dv_macroblock_t *mb;
+	int m, b, i;
+	int changed = 0;
+
+	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
+		for (b = 0; b < 6; b++) {
+			dv_coeff_t *coeffs = mb->b[b].coeffs;
+			int dc;
+
+			if (b < 4) {
+				dc = ADJUST_BLACK_DC + adj->luma_offset * 2 +
+					adjust_scale(coeffs[0] - ADJUST_BLACK_DC,
+						     adj->gain);
+			} else {
+				dc = adjust_scale(coeffs[0], adj->gain);
 			}
-			
-			dif += 5;
-		} 
-	} 
-	
-	_dv_write_meta_data(target, dv_enc->frame_count++, dv_enc->isPAL, dv_enc->is16x9, &now);
+			if (dc < -256) dc = -256;
+			if (dc > 255) dc = 255;
+			changed |= (dc != coeffs[0]);
+			coeffs[0] = dc;
+			if (adj->gain == ADJUST_ONE) {
+				continue;
+			}
+			for (i = 1; i < 64; i++) {
+				if (coeffs[i]) {
+					int ac = adjust_scale(coeffs[i], 
+							      adj->gain);
+					changed |= (ac != coeffs[i]);
+					coeffs[i] = ac;
+				}
+			}
+		}
+	}
+	return changed;
+}
 
-	pthread_mutex_unlock(&mutex);
+/* Requantises a video segment in place.  With adj, the picture is
+ * adjusted first and segments it does not change are left as they are. */
+static int transcode_videosegment(dv_encoder_t *dv_enc, 
+				  dv_videosegment_t *videoseg, 
+				  uint8_t *vsbuffer, const enc_adjust_t *adj,
+				  dv_enc_stats_t *stats)
+{
+	bitstream_t bs;
+	dv_macroblock_t *mb;
+	int m, b;
+	double t = 0;
+	int timing = stats && dv_enc->stage_timing;
+
+	if (timing) stage_done(stats, DV_ENC_STAGE_CONVERT, &t);
+	memset(&bs, 0, sizeof(bs));
+	videoseg->bs = &bs;
+	_dv_bitstream_new_buffer(&bs, vsbuffer, 5 * 80);
+	/* the parser expects no block to be lending bits yet */
+	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
+		for (b = 0; b < 6; b++) {
+			mb->b[b].mark = 0;
+		}
+	}
+	pthread_mutex_lock(&_dv_parse_mutex);
+	dv_parse_video_segment(videoseg, DV_QUALITY_BEST);
+	pthread_mutex_unlock(&_dv_parse_mutex);
+	for (m = 0, mb = videoseg->mb; m < 5; m++, mb++) {
+		for (b = 0; b < 6; b++) {
+			dequantize_block(&mb->b[b], mb->qno);
+			if (stats) {
+				stats->dct_used[mb->b[b].dct_mode]++;
+				stats->classes_used[mb->b[b].class_no]++;
+			}
+		}
+	}
+	if (adj && !adjust_videosegment(videoseg, adj)) {
+		if (timing) stage_done(stats, DV_ENC_STAGE_CONVERT, &t);
+		return 0;
+	}
+	for (m = 0; m < 5; m++) {
+		/* keep the DIF block header and the status nibble */
+		vsbuffer[m * 80 + 3] &= 0xf0;
+		memset(vsbuffer + m * 80 + 4, 0, 80 - 4);
+	}
+	if (timing) stage_done(stats, DV_ENC_STAGE_CONVERT, &t);
 
+	pack_videosegment(videoseg, vsbuffer, dv_enc->vlc_encode_passes,
+			  dv_enc->static_qno, stats, timing ? &t : NULL);
 	return 0;
 }
 
-#ifdef __linux__
-void swab(const void*, void*, ssize_t);
-#endif
+/** @brief Requantise a video segment of a DV frame in place.
+ *
+ * Parses the segment to quantised coefficients and quantises and packs
+ * them again with vlc_encode_passes and static_qno of the encoder, see
+ * dv_transcode_full_frame().
+ *
+ * @param dv_enc The encoder whose settings to use
+ * @param videoseg The position of the segment: i, k and isPAL
+ * @param vsbuffer The 5 DIF blocks of the segment
+ * @return 0 for success
+ */
+int dv_transcode_videosegment(dv_encoder_t *dv_enc, 
+			      dv_videosegment_t *videoseg, uint8_t *vsbuffer)
+{
+	enc_check_settings(dv_enc);
+	return transcode_videosegment(dv_enc, videoseg, vsbuffer, NULL, NULL);
+}
+
+static int transcode_segment_nr(dv_encoder_t *dv_enc, uint8_t *target, 
+				int n, const enc_adjust_t *adj,
+				dv_enc_stats_t *stats)
+{
+	dv_videosegment_t videoseg ALIGN64;
+	int ds = n / 27;
+	int v = n % 27;
+
+	videoseg.i = ds;
+	videoseg.k = v;
+	videoseg.isPAL = dv_enc->isPAL;
+	return transcode_videosegment(dv_enc, &videoseg, target +
+				      (ds * 150 + 6 + v / 3 + 1 + v * 5) * 80,
+				      adj, stats);
+}
+
+static int transcode_full_frame(dv_encoder_t *dv_enc, const uint8_t *in,
+				uint8_t *out, const enc_adjust_t *adj)
+{
+	int num_segs, n;
+
+	enc_check_settings(dv_enc);
+	dv_enc->isPAL = in[3] & 0x80;
+	if (out != in) {
+		memcpy(out, in, dv_enc->isPAL ? 144000 : 120000);
+	}
+	num_segs = (dv_enc->isPAL ? 12 : 10) * 27;
+	if (enc_pool_prepare(dv_enc, num_segs)) {
+		if (enc_pool_run(dv_enc->pool, dv_enc, out, num_segs, 
+				 1, adj) < 0) {
+			return -1;
+		}
+	} else {
+		for (n = 0; n < num_segs; n++) {
+			if (transcode_segment_nr(dv_enc, out, n, adj, 
+						 dv_enc->stats) < 0) {
+				return -1;
+			}
+		}
+	}
+	dv_enc->stats->frames++;
+	return 0;
+}
+
+/** @brief Requantise the video of a DV frame without decoding it.
+ *
+ * Each video segment is parsed to quantised coefficients, which are
+ * quantised and packed again with the vlc_encode_passes and static_qno
+ * settings of the encoder; there is no (i)DCT or pixel conversion.  The
+ * blocks keep their DCT modes and classes and no macroblock gets a
+ * finer quantiser, so a frame that fits comes out with its picture
+ * unchanged, and damaged or badly packed ones are tidied up.  Headers,
+ * subcode, VAUX and audio are copied as they are.  With num_threads
+ * the segments are shared out over the encoder's worker threads, as in
+ * dv_encode_full_frame().
+ *
+ * @param dv_enc The encoder whose settings to use
+ * @param in The DV frame to transcode
+ * @param out The transcoded frame, may be the same as in
+ * @return 0 for success
+ */
+int dv_transcode_full_frame(dv_encoder_t *dv_enc, const uint8_t *in, 
+			    uint8_t *out)
+{
+	return transcode_full_frame(dv_enc, in, out, NULL);
+}
+
+static void adjust_init(enc_adjust_t *adj, double gain, int brightness)
+{
+	if (gain < 0) gain = 0;
+	if (gain > 1) gain = 1;
+	adj->gain = (int) (gain * ADJUST_ONE + 0.5);
+	adj->luma_offset = brightness;
+}
+
+/** @brief Adjust a video segment of a DV frame in place.
+ *
+ * See dv_adjust_full_frame().
+ *
+ * @param dv_enc The encoder whose settings to use
+ * @param videoseg The position of the segment: i, k and isPAL
+ * @param vsbuffer The 5 DIF blocks of the segment
+ * @param gain Scale factor, 0 to 1
+ * @param brightness Luma offset
+ * @return 0 for success
+ */
+int dv_adjust_videosegment(dv_encoder_t *dv_enc, dv_videosegment_t *videoseg,
+			   uint8_t *vsbuffer, double gain, int brightness)
+{
+	enc_adjust_t adj;
+
+	enc_check_settings(dv_enc);
+	adjust_init(&adj, gain, brightness);
+	return transcode_videosegment(dv_enc, videoseg, vsbuffer, &adj, NULL);
+}
+
+/** @brief Fade or brighten the picture of a DV frame without decoding it.
+ *
+ * Works like dv_transcode_full_frame(), but between parsing and packing
+ * the DC coefficients are changed and, for gains below 1, all
+ * coefficients are scaled.  The luma is scaled by gain towards black
+ * and then lifted by brightness, the chroma is scaled by gain towards
+ * grey; a gain of 0.5 fades half way to black, and a gain of 1 with a
+ * brightness of 8 lifts the luma by 8 levels.  Video segments that come
+ * out the same, like the black ones of a fade, are copied as they are.
+ *
+ * @param dv_enc The encoder whose settings to use
+ * @param in The DV frame to adjust
+ * @param out The adjusted frame, may be the same as in
+ * @param gain Scale factor, 0 to 1
+ * @param brightness Luma offset, in 8 bit luma levels
+ * @return 0 for success
+ */
+int dv_adjust_full_frame(dv_encoder_t *dv_enc, const uint8_t *in, 
+			 uint8_t *out, double gain, int brightness)
+{
+	enc_adjust_t adj;
+
+	adjust_init(&adj, gain, brightness);
+	if (adj.gain == ADJUST_ONE && adj.luma_offset == 0) {
+		if (out != in) {
+			memcpy(out, in, (in[3] & 0x80) ? 144000 : 120000);
+		}
+		dv_enc->stats->frames++;
+		return 0;
+	}
+	return transcode_full_frame(dv_enc, in, out, &adj);
+}
 
 /** @brief Encode signed 16-bit integer PCM audio data into a frame of DV video.
  *
  * @param dv_enc A pointer to a dv_encoder_t struct containing relevant options:
  *        -isPAL  Set true (non-zero) to encode the data in PAL format.
+ *        -samples_this_frame  The number of samples per channel in this
+ *         frame, see dv_calculate_samples(), or 0 for the average.
  * @param pcm An array of buffers containing PCM audio data where each
- *          array entry corresponds to a single channel of audio.
- * @param channels The number of channels being used (<=4). Currently,
- *          only two channels are supported.
+ *          array entry corresponds to a single channel of audio.  Each
+ *          buffer holds DV_AUDIO_MAX_SAMPLES samples.
+ * @param channels The number of channels being used (<=4).  Up to two
+ *          channels are stored with 16 bits, a single one going to both
+ *          channels of the pair.  Three or four channels need 32000 Hz
+ *          and are stored with 12 bits (nonlinear), a missing fourth
+ *          channel being silent.
  * @param frequency The sampling rate of the input must be one of 32000,
  *          44100, or 48000.
  * @param frame_buf A pointer to a DV frame
  * @return -1 for failure, 0 for success
- * 
- * @todo handle 4 channels
  */
 int dv_encode_full_audio(dv_encoder_t *dv_enc, int16_t **pcm,
 			int channels, int frequency, uint8_t *frame_buf)
 {
-	/* this assumes signed 16 bit pcm audio */
-	int i,j;
-	dv_enc_audio_info_t audio;
-	audio.channels = channels;
-	audio.frequency = frequency;
-	audio.bitspersample = 16;
-	audio.bytealignment = 4;
-	audio.bytespersecond = frequency * audio.bytealignment;
+	int samples;
 
-	/* estimate the number of samples per frame if not specified. */
 	dv_enc->isPAL = frame_buf[ 3 ] & 0x80;
+	/* estimate the number of samples per frame if not specified. */
 	if ( dv_enc->samples_this_frame == 0 )
-		audio.bytesperframe = audio.bytespersecond/(dv_enc->isPAL ? 25 : 30);
+		samples = frequency / (dv_enc->isPAL ? 25 : 30);
 	else
-		audio.bytesperframe = dv_enc->samples_this_frame * 2 * channels;
-
-
-	/* interleave channels */
-	if (channels > 1) {
-		for (i=0; i < DV_AUDIO_MAX_SAMPLES; i++)
-			for (j=0; j < channels; j++)
-				swab( pcm[j]+i, audio.data + (i*2+j)*channels, 2);
-	}
+		samples = dv_enc->samples_this_frame;
 
-	return _dv_raw_insert_audio(frame_buf, &audio, dv_enc->isPAL);
+	/* the samples are shuffled into the frame straight from the
+	   channel buffers */
+	return _dv_insert_audio(frame_buf, (const int16_t * const *) pcm,
+				channels, frequency, samples, dv_enc->isPAL);
 }
 
 /** @brief Calculate number of samples to be applied to a new frame.
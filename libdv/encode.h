@@ -34,13 +34,18 @@
 #define DV_PAL_HEIGHT  576
 #define DV_NTSC_HEIGHT 480
 
+/* The input under a macroblock, converted and laid out like the img_*
+   planes, see _dv_ycb_fill_macroblock().  Each thread encoding video
+   segments has its own. */
+typedef struct dv_enc_tile_s {
+	short y[16 * DV_WIDTH];
+	short cr[16 * DV_WIDTH / 2];
+	short cb[16 * DV_WIDTH / 2];
+} dv_enc_tile_t;
+
 /* FIXME: Just guessed! */
 #define DCT_248_THRESHOLD  (17 * 65536 /10)
 
-extern void _dv_init_vlc_test_lookup(void);
-extern void _dv_init_vlc_encode_lookup(void);
-extern void _dv_init_qno_start(void);
-extern void _dv_prepare_reorder_tables(void);
 extern void dv_show_statistics(void);
 extern int  dv_encoder_loop(dv_enc_input_filter_t * input,
 			 dv_enc_audio_input_filter_t * audio_input,
@@ -49,6 +54,6 @@ extern int  dv_encoder_loop(dv_enc_input_filter_t * input,
 			 const char* audio_filename,
 			 int vlc_encode_passes, int static_qno, 
 			 int verbose_mode,
-			 int fps, int is16x9);
+			 int fps, int is16x9, int num_threads);
 
 #endif /* DV_ENCODE_H */
@@ -0,0 +1,1569 @@
+/*
+ *  gentables.c
+ *
+ *     Copyright (C) Charles 'Buck' Krasic - April 2000
+ *     Copyright (C) Erik Walthinsen - April 2000
+ *
+ *  This file is part of libdv, a free DV (IEC 61834/SMPTE 314M)
+ *  codec.
+ *
+ *  libdv is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation; either version 2.1, or (at your
+ *  option) any later version.
+ *
+ *  libdv is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with libdv; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ *  The libdv homepage is http://libdv.sourceforge.net/.
+ */
+
+/* Host program run at build time (like gasmoff) that writes tables.c
+ * to stdout.  Everything dv_init() used to compute at startup -
+ * weighting and (i)DCT scale factors, the VLC decode tables, the
+ * zigzag and quantiser tables, the YUV->RGB/YUY2/YV12 lookups for
+ * both clamp settings and the encoder VLC tables - is computed here
+ * once and compiled into libdv as const data.  The code below was
+ * moved from weighting.c, dct.c, idct_248.c, vlc.c, parse.c,
+ * quant.c, rgb.c, YUY2.c, YV12.c and encode.c; see tables.h for the
+ * symbols it defines. */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "dv_types.h"
+#include "vlc.h"
+#include "parse.h"
+#include "rgb.h"
+
+/* ---------------------------------------------------------------------------
+ * Output helpers.  Tables are printed with one level of braces per
+ * dimension so the result compiles cleanly with -Wall.
+ */
+static long long ibuf[32768 * 2];
+static double    dbuf[8 * 8 * 8 * 8];
+
+#define LOAD_INTS(src,n) \
+  do { int _i; for(_i=0;_i<(n);_i++) ibuf[_i] = (long long)(src)[_i]; } while(0)
+#define LOAD_DOUBLES(src,n) \
+  do { int _i; for(_i=0;_i<(n);_i++) dbuf[_i] = (src)[_i]; } while(0)
+
+static int
+emit_values(const int *dims, int ndims, int pos, int indent, int is_double) {
+  int i, per_line;
+
+  if(ndims == 1) {
+    per_line = is_double ? 4 : 12;
+    for(i=0; i<dims[0]; i++) {
+      if(!(i % per_line)) printf("%*s", indent, "");
+      if(is_double) printf("%.17g,", dbuf[pos+i]);
+      else printf("%lld,", ibuf[pos+i]);
+      printf(((i % per_line) == per_line-1 || i == dims[0]-1) ? "\n" : " ");
+    } /* for */
+    return(pos + dims[0]);
+  } /* if */
+  for(i=0; i<dims[0]; i++) {
+    printf("%*s{\n", indent, "");
+    pos = emit_values(dims+1, ndims-1, pos, indent+2, is_double);
+    printf("%*s},\n", indent, "");
+  } /* for */
+  return(pos);
+} /* emit_values */
+
+static void
+emit_table(const char *decl, const int *dims, int ndims, int is_double) {
+  printf("%s = {\n", decl);
+  emit_values(dims, ndims, 0, 2, is_double);
+  printf("};\n\n");
+} /* emit_table */
+
+#define EMIT_INTS(decl,src,...) \
+  do { \
+    const int _dims[] = { __VA_ARGS__ }; \
+    int _n = 1, _d; \
+    for(_d=0; _d<(int)(sizeof(_dims)/sizeof(int)); _d++) _n *= _dims[_d]; \
+    LOAD_INTS(src, _n); \
+    emit_table(decl, _dims, sizeof(_dims)/sizeof(int), 0); \
+  } while(0)
+
+#define EMIT_DOUBLES(decl,src,...) \
+  do { \
+    const int _dims[] = { __VA_ARGS__ }; \
+    int _n = 1, _d; \
+    for(_d=0; _d<(int)(sizeof(_dims)/sizeof(int)); _d++) _n *= _dims[_d]; \
+    LOAD_DOUBLES(src, _n); \
+    emit_table(decl, _dims, sizeof(_dims)/sizeof(int), 1); \
+  } while(0)
+
+static void
+emit_vlc_table(const char *decl, const dv_vlc_t *tab, int n) {
+  int i;
+
+  printf("%s = {\n", decl);
+  for(i=0; i<n; i++) {
+    if(!(i % 4)) printf("  ");
+    printf("{ %d, %d, %d },", tab[i].run, tab[i].len, tab[i].amp);
+    printf(((i % 4) == 3 || i == n-1) ? "\n" : " ");
+  } /* for */
+  printf("};\n\n");
+} /* emit_vlc_table */
+
+/* ---------------------------------------------------------------------------
+ * weighting.c
+ */
+
+static dv_coeff_t preSC[64] = {
+	16384,22725,21407,19266, 16384,12873,8867,4520,
+	22725,31521,29692,26722, 22725,17855,12299,6270,
+	21407,29692,27969,25172, 21407,16819,11585,5906,
+	19266,26722,25172,22654, 19266,15137,10426,5315,
+
+	16384,22725,21407,19266, 16384,12873,8867,4520,
+	12873,17855,16819,15137, 25746,20228,13933,7103,
+	17734,24598,23170,20853, 17734,13933,9597,4892,
+	18081,25080,23624,21261, 18081,14206,9785,4988
+};
+
+static dv_coeff_t postSC88[64];
+static dv_coeff_t postSC248[64];
+
+static double W[8];
+
+#if (!ARCH_X86) && (!ARCH_X86_64)
+static dv_coeff_t dv_weight_inverse_88_matrix[64];
+#endif
+
+#if BRUTE_FORCE_DCT_88
+static double dv_weight_88_matrix[64];
+#endif
+#if BRUTE_FORCE_DCT_248
+static double dv_weight_248_matrix[64];
+#endif
+
+static double dv_weight_inverse_248_matrix[64];
+
+static inline double CS(int m) {
+  return cos(((double)m) * M_PI / 16.0);
+}
+
+static inline short int_val(double f)
+{
+	return (short) floor(f + 0.5);
+}
+
+static void postscale88_init(double* post_sc)
+{
+	int i,j;
+	double ci,cj;
+
+	for( i = 0; i < 8; i++ ) {
+		ci = i==0 ? 1/(8.*sqrt(2.)) : 1.0/16.0;
+		/* di = i==0 ? 1.5/(sqrt(2.)) : 0.5;
+		   ps3[i] = 2.0*2.0*ci/cos(i*M_PI/16);
+		   israelh. this is table1 from AAN paper.
+		   Note the trick if 8 or 16 deivision
+		*/
+		for( j = 0; j < 8; j++) {
+			cj = j==0 ? 1/(8*sqrt(2.)) : 1.0/16.0;
+			post_sc[i * 8 + j] = 4.0*4.0 * ci * cj /
+				(cos(i*M_PI/16)*cos(j*M_PI/16));
+			/* israelh. patch the first 4.0? */
+		}
+	}
+	post_sc[63] = 1.0;
+}
+
+static void postscale248_init(double* post_sc)
+{
+	int i,j;
+	double ci,cj;
+
+	for( i = 0; i < 4; i++ ) {
+		ci = i==0 ? 1/(4.*sqrt(2.)) : 1.0/8.0;
+		for( j = 0; j < 8; j++) {
+			cj = j==0 ? 1/(8*sqrt(2.)) : 1.0/16.0;
+			post_sc[i * 8 + j] = 4.0*2.0 * ci * cj /
+				(cos(i*M_PI/8)*cos(j*M_PI/16));
+			post_sc[i * 8 + 32 + j] = 4.0*2.0 * ci * cj /
+				(cos(i*M_PI/8)*cos(j*M_PI/16));
+		}
+	}
+	post_sc[63-32] = 1.0;
+	post_sc[63] = 1.0;
+}
+
+static void weight_88_float(double *block)
+{
+	int x,y;
+	double dc;
+
+	dc = block[0];
+	for (y=0;y<8;y++) {
+		for (x=0;x<8;x++) {
+			block[y*8+x] *= W[x] * W[y] / 2.0;
+		}
+	}
+	block[0] = dc / 4.0;
+}
+
+static void weight_248_float(double *block)
+{
+	int x,z;
+	double dc;
+
+	dc = block[0];
+	for (z=0;z<4;z++) {
+		for (x=0;x<8;x++) {
+			block[z*8+x] *= W[x] * W[2*z] / 2;
+			block[(z+4)*8+x] *= W[x] * W[2*z] / 2;
+		}
+	}
+	block[0] = dc / 4;
+	block[32] = dc / 4;
+}
+
+static void weight_88_inverse_float(double *block)
+{
+	int x,y;
+	double dc;
+
+	dc = block[0];
+	for (y=0;y<8;y++) {
+		for (x=0;x<8;x++) {
+			block[y*8+x] /= (W[x] * W[y] / 2.0);
+		}
+	}
+	block[0] = dc * 4.0;
+}
+
+static void weight_init(void)
+{
+	double temp[64];
+	double temp_postsc[64];
+	int i, z, x;
+#if ARCH_X86 || ARCH_X86_64
+	const double dv_weight_bias_factor = (double)(1UL << DV_WEIGHT_BIAS);
+#endif
+
+	W[0] = 1.0;
+	W[1] = CS(4) / (4.0 * CS(7) * CS(2));
+	W[2] = CS(4) / (2.0 * CS(6));
+	W[3] = 1.0 / (2 * CS(5));
+	W[4] = 7.0 / 8.0;
+	W[5] = CS(4) / CS(3);
+	W[6] = CS(4) / CS(2);
+	W[7] = CS(4) / CS(1);
+
+	for (i = 0; i < 64; i++) {
+		temp[i] = 1.0;
+	}
+	weight_88_inverse_float(temp);
+
+	for (i=0;i<64;i++) {
+#if (!ARCH_X86) && (!ARCH_X86_64)
+		dv_weight_inverse_88_matrix[i] = (dv_coeff_t)rint(temp[i]);
+#else
+		/* If we're using MMX assembler, fold weights into the iDCT
+		   prescale */
+		preSC[i] *= temp[i] * (16.0 / dv_weight_bias_factor);
+#endif
+	}
+
+	postscale88_init(temp_postsc);
+	for (i = 0; i < 64; i++) {
+		temp[i] = 1.0;
+	}
+	weight_88_float(temp);
+
+	for (i=0;i<64;i++) {
+#if BRUTE_FORCE_DCT_88
+		dv_weight_88_matrix[i] = temp[i];
+#else
+		/* If we're not using brute force(tm),
+		   fold weights into the DCT
+		   postscale */
+		postSC88[i]= int_val(temp_postsc[i] * temp[i] * 32768.0 * 2.0);
+#endif
+	}
+	postSC88[63] = temp[63] * 32768 * 2.0;
+
+	postscale248_init(temp_postsc);
+
+	for (i = 0; i < 64; i++) {
+		temp[i] = 1.0;
+	}
+	weight_248_float(temp);
+
+	for (i=0;i<64;i++) {
+#if BRUTE_FORCE_DCT_248
+		dv_weight_248_matrix[i] = temp[i];
+#else
+		/* If we're not using brute force(tm),
+		   fold weights into the DCT
+		   postscale */
+		postSC248[i]= int_val(temp_postsc[i]* temp[i] * 32768.0 * 2.0);
+#endif
+	}
+
+	for (z=0;z<4;z++) {
+		for (x=0;x<8;x++) {
+			dv_weight_inverse_248_matrix[z*8+x] =
+				2.0 / (W[x] * W[2*z]);
+			dv_weight_inverse_248_matrix[(z+4)*8+x] =
+				2.0 / (W[x] * W[2*z]);
+
+		}
+	}
+	dv_weight_inverse_248_matrix[0] = 4.0;
+}
+
+/* ---------------------------------------------------------------------------
+ * dct.c
+ */
+
+#if BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
+static double KC248[8][4][4][8];
+#endif /* BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
+
+#if ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
+static double C[8];
+static double KC88[8][8][8][8];
+#endif /* ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
+
+static void dct_init(void) {
+#if BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
+  int u, z;
+#endif /* BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
+#if ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
+  int x, y, h, v, i;
+  for (x = 0; x < 8; x++) {
+    for (y = 0; y < 8; y++) {
+      for (v = 0; v < 8; v++) {
+        for (h = 0; h < 8; h++) {
+          KC88[x][y][h][v] =
+            cos((M_PI * v * ((2.0 * y) + 1.0)) / 16.0) *
+            cos((M_PI * h * ((2.0 * x) + 1.0)) / 16.0);
+        }
+      }
+    }
+  }
+#endif /* ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
+#if BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
+  for (x = 0; x < 8; x++) {
+    for (z = 0; z < 4; z++) {
+      for (u = 0; u < 4; u++) {
+        for (h = 0; h < 8; h++) {
+	  KC248[x][z][u][h] =
+	    cos((M_PI * u * ((2.0 * z) + 1.0)) / 8.0) *
+	    cos((M_PI * h * ((2.0 * x) + 1.0)) / 16.0);
+        }                       /* for h */
+      }                         /* for u */
+    }                           /* for z */
+  }                             /* for x */
+#endif /* BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
+#if ((!ARCH_X86) && (!ARCH_X86_64))  || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
+  for (i = 0; i < 8; i++) {
+    C[i] = (i == 0 ? 0.5 / sqrt(2.0) : 0.5);
+  } /* for i */
+#endif /* ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88 */
+}
+
+/* ---------------------------------------------------------------------------
+ * idct_248.c
+ */
+
+static dv_248_coeff_t dv_idct_248_prescale[64];
+static int32_t dv_idct_248_beta[5];
+
+static double idct_C(int u) {
+  double result;
+  if(u == 0) {
+    result = 0.5 / sqrt(2.0);
+  } else {
+    result = 0.5;
+  } // else
+  return(result);
+} // idct_C
+
+static double tickC(int u)
+{
+  double result;
+  if(u == 0) {
+    result = 1.0 / sqrt(2.0);
+  } else {
+    result = 0.5;
+  } // else
+  return(result);
+} // tickC
+
+/* Compute the prescale vector.
+ * (verify against  matlab result for kron(inv(D2),D))
+ */
+static void dct_248_init(void) {
+  int k, l;
+  double d;
+  double diag[2][8];
+  double dbeta0, dbeta1, dbeta2, dbeta3, dbeta4;
+
+  dbeta2 = cos(M_PI/4);
+  dbeta0 = dbeta2 - 0.5;
+  dbeta1 = -1 - dbeta0;
+  dbeta3 = -cos(3 * M_PI / 8);
+  dbeta4 = cos(M_PI / 8);
+
+  dv_idct_248_beta[0] = dbeta0 * pow(2,30);
+  dv_idct_248_beta[1] = dbeta1 * pow(2,30);
+  dv_idct_248_beta[2] = dbeta2 * pow(2,30);
+  dv_idct_248_beta[3] = dbeta3 * pow(2,30);
+  dv_idct_248_beta[4] = dbeta4 * pow(2,30);
+
+  for(k=0; k<4;k++) {
+    d = idct_C(k) / (2.0 * cos( (M_PI * (double)k) / 8.0 ));
+    diag[0][k] = diag[0][k+4] = d;
+  } // for
+  for(k=0; k<8;k++) {
+    diag[1][k] = tickC(k) / (2.0 * cos( M_PI * k / 16.0 ));
+  } // for
+  for(k=0; k<8;k++) {
+    for(l= 0; l<8 ; l++) {
+      // Note the 2^16 shift is for fixed point precision.
+      dv_idct_248_prescale[k*8+l] = 1.0/diag[0][k] * diag[1][l] * pow(2.0,14.0);
+      dv_idct_248_prescale[k*8+l] *= dv_weight_inverse_248_matrix[k*8+l];
+    } // for
+  } // for
+} // dct_248_init
+
+/* ---------------------------------------------------------------------------
+ * vlc.c
+ */
+
+#ifdef __GNUC__
+static const dv_vlc_tab_t dv_vlc_lookup1[32] = { 
+  /* prefix 00 */
+  [0x00 ... 0x07] = {run:  0, amp:  1, len:  1+2}, /* 00s */
+  /* prefix 010 */
+  [0x08 ... 0x0b] = {run:  0, amp:  2, len:  1+3}, /* 010s */
+  /* prefix 011 */
+  [0x0c ... 0x0d] = {run: -1, amp:  0, len:    4}, /* 0110 (EOB) */
+  [0x0e ... 0x0f] = {run:  1, amp:  1, len:  1+4}, /* 0111s */
+  /* prefix 100 */
+  [0x10 ... 0x11] = {run:  0, amp:  3, len:  1+4}, /* 1000s */
+  [0x12 ... 0x13] = {run:  0, amp:  4, len:  1+4}, /* 1001s */
+  /* prefix 101 */
+  [0x14         ] = {run:  2, amp:  1, len:  1+5}, /* 10100s */
+  [0x15         ] = {run:  1, amp:  2, len:  1+5}, /* 10101s */
+  [0x16         ] = {run:  0, amp:  5, len:  1+5}, /* 10110s */
+  [0x17         ] = {run:  0, amp:  6, len:  1+5}, /* 10111s */
+  /* prefix 110-111 */
+  [0x18 ... 0x1f] = {run: -1, amp: -1,  len: VLC_NOBITS},
+}; /* dv_vlc_lookup1 */
+#else /* ! __GNUC__ */
+static const dv_vlc_tab_t dv_vlc_lookup1[32] = {
+  /* prefix 00 */
+  {0, 1+2, 1}, {0, 1+2, 1}, {0, 1+2, 1}, {0, 1+2, 1},
+  {0, 1+2, 1}, {0, 1+2, 1}, {0, 1+2, 1}, {0, 1+2, 1},
+  /* prefix 010 */
+  {0, 1+3, 2}, {0, 1+3, 2}, {0, 1+3, 2}, {0, 1+3, 2},
+  /* prefix 011 */
+  {-1, 4, 0}, {-1, 4, 0},
+  { 1, 1+4, 1}, { 1, 1+4, 1},
+  /* prefix 100 */
+  { 0, 1+4, 3}, { 0, 1+4, 3},
+  { 0, 1+4, 4}, { 0, 1+4, 4},
+  /* prefix 101 */
+  { 2, 1+5, 1},
+  { 1, 1+5, 2},
+  { 0, 1+5, 5},
+  { 0, 1+5, 6},
+  /* prefix 110-111 */
+  { -1,VLC_NOBITS,-1}, { -1,VLC_NOBITS, -1}, { -1,VLC_NOBITS,-1},
+  { -1,VLC_NOBITS,-1}, { -1,VLC_NOBITS, -1}, { -1,VLC_NOBITS,-1},
+  { -1,VLC_NOBITS,-1}, { -1,VLC_NOBITS, -1},
+}; /* dv_vlc_lookup1 */
+#endif /* ! __GNUC__ */
+
+#ifdef __GNUC__
+static const dv_vlc_tab_t dv_vlc_lookup2[128] = { 
+  /* prefix 110 */
+  [0x00 ... 0x07] = {run:  3, amp:  1, len:  1+6}, /* 110000s */
+  [0x08 ... 0x0f] = {run:  4, amp:  1, len:  1+6}, /* 110001s */
+  [0x10 ... 0x17] = {run:  0, amp:  7, len:  1+6}, /* 110010s */
+  [0x18 ... 0x1f] = {run:  0, amp:  8, len:  1+6}, /* 110011s */
+  /* prefix 1101 */
+  [0x20 ... 0x23] = {run:  5, amp:  1, len:  1+7}, /* 1101000s */
+  [0x24 ... 0x27] = {run:  6, amp:  1, len:  1+7}, /* 1101001s */
+  [0x28 ... 0x2b] = {run:  2, amp:  2, len:  1+7}, /* 1101010s */
+  [0x2c ... 0x2f] = {run:  1, amp:  3, len:  1+7}, /* 1101011s */
+  [0x30 ... 0x33] = {run:  1, amp:  4, len:  1+7}, /* 1101100s */
+  [0x34 ... 0x37] = {run:  0, amp:  9, len:  1+7}, /* 1101101s */
+  [0x38 ... 0x3b] = {run:  0, amp: 10, len:  1+7}, /* 1101110s */
+  [0x3c ... 0x3f] = {run:  0, amp: 11, len:  1+7}, /* 1101111s */
+  /* prefix 1110 */
+  [0x40 ... 0x41] = {run:  7, amp:  1, len:  1+8}, /* 11100000s */
+  [0x42 ... 0x43] = {run:  8, amp:  1, len:  1+8}, /* 11100001s */
+  [0x44 ... 0x45] = {run:  9, amp:  1, len:  1+8}, /* 11100010s */
+  [0x46 ... 0x47] = {run: 10, amp:  1, len:  1+8}, /* 11100011s */
+  [0x48 ... 0x49] = {run:  3, amp:  2, len:  1+8}, /* 11100100s */
+  [0x4a ... 0x4b] = {run:  4, amp:  2, len:  1+8}, /* 11100101s */
+  [0x4c ... 0x4d] = {run:  2, amp:  3, len:  1+8}, /* 11100110s */
+  [0x4e ... 0x4f] = {run:  1, amp:  5, len:  1+8}, /* 11100111s */
+  [0x50 ... 0x51] = {run:  1, amp:  6, len:  1+8}, /* 11101000s */
+  [0x52 ... 0x53] = {run:  1, amp:  7, len:  1+8}, /* 11101001s */
+  [0x54 ... 0x55] = {run:  0, amp: 12, len:  1+8}, /* 11101010s */
+  [0x56 ... 0x57] = {run:  0, amp: 13, len:  1+8}, /* 11101011s */
+  [0x58 ... 0x59] = {run:  0, amp: 14, len:  1+8}, /* 11101100s */
+  [0x5a ... 0x5b] = {run:  0, amp: 15, len:  1+8}, /* 11101101s */
+  [0x5c ... 0x5d] = {run:  0, amp: 16, len:  1+8}, /* 11101110s */
+  [0x5e ... 0x5f] = {run:  0, amp: 17, len:  1+8}, /* 11101111s */
+  /* prefix 1111 0 */
+  [0x60         ] = {run: 11, amp:  1, len:  1+9}, /* 1111 0000 0s */
+  [0x61         ] = {run: 12, amp:  1, len:  1+9}, /* 1111 0000 1s */
+  [0x62         ] = {run: 13, amp:  1, len:  1+9}, /* 1111 0001 0s */
+  [0x63         ] = {run: 14, amp:  1, len:  1+9}, /* 1111 0001 1s */
+  [0x64         ] = {run: 5,  amp:  2, len:  1+9}, /* 1111 0010 0s */
+  [0x65         ] = {run: 6,  amp:  2, len:  1+9}, /* 1111 0010 1s */
+  [0x66         ] = {run: 3,  amp:  3, len:  1+9}, /* 1111 0011 0s */
+  [0x67         ] = {run: 4,  amp:  3, len:  1+9}, /* 1111 0011 1s */
+  [0x68         ] = {run: 2,  amp:  4, len:  1+9}, /* 1111 0100 0s */
+  [0x69         ] = {run: 2,  amp:  5, len:  1+9}, /* 1111 0100 1s */
+  [0x6a         ] = {run: 1,  amp:  8, len:  1+9}, /* 1111 0101 0s */
+  [0x6b         ] = {run: 0,  amp: 18, len:  1+9}, /* 1111 0101 1s */
+  [0x6c         ] = {run: 0,  amp: 19, len:  1+9}, /* 1111 0110 0s */
+  [0x6d         ] = {run: 0,  amp: 20, len:  1+9}, /* 1111 0110 1s */
+  [0x6e         ] = {run: 0,  amp: 21, len:  1+9}, /* 1111 0111 0s */
+  [0x6f         ] = {run: 0,  amp: 22, len:  1+9}, /* 1111 0111 1s */
+  /* prefix 1111 1 */
+  [0x70 ... 0x7f] = {run: -1, amp: -1,  len: VLC_NOBITS},
+}; /* dv_vlc_lookup2 */
+#else /* ! __GNUC__ */
+static const dv_vlc_tab_t dv_vlc_lookup2[128] = {
+  /* prefix 110 */
+  {3, 1+6, 1}, {3, 1+6, 1}, {3, 1+6, 1}, {3, 1+6, 1},
+  {3, 1+6, 1}, {3, 1+6, 1}, {3, 1+6, 1}, {3, 1+6, 1},
+  {4, 1+6, 1}, {4, 1+6, 1}, {4, 1+6, 1}, {4, 1+6, 1},
+  {4, 1+6, 1}, {4, 1+6, 1}, {4, 1+6, 1}, {4, 1+6, 1},
+  {0, 1+6, 7}, {0, 1+6, 7}, {0, 1+6, 7}, {0, 1+6, 7},
+  {0, 1+6, 7}, {0, 1+6, 7}, {0, 1+6, 7}, {0, 1+6, 7},
+  {0, 1+6, 8}, {0, 1+6, 8}, {0, 1+6, 8}, {0, 1+6, 8},
+  {0, 1+6, 8}, {0, 1+6, 8}, {0, 1+6, 8}, {0, 1+6, 8},
+ 
+  /* prefix 1101 */
+  {5, 1+7, 1}, {5, 1+7, 1}, {5, 1+7, 1}, {5, 1+7, 1},
+  {6, 1+7, 1}, {6, 1+7, 1}, {6, 1+7, 1}, {6, 1+7, 1},
+  {2, 1+7, 2}, {2, 1+7, 2}, {2, 1+7, 2}, {2, 1+7, 2},
+  {1, 1+7, 3}, {1, 1+7, 3}, {1, 1+7, 3}, {1, 1+7, 3},
+  {1, 1+7, 4}, {1, 1+7, 4}, {1, 1+7, 4}, {1, 1+7, 4},
+  {0, 1+7, 9}, {0, 1+7, 9}, {0, 1+7, 9}, {0, 1+7, 9},
+  {0, 1+7, 10}, {0, 1+7, 10}, {0, 1+7, 10}, {0, 1+7, 10},
+  {0, 1+7, 11}, {0, 1+7, 11}, {0, 1+7, 11}, {0, 1+7, 11},
+ 
+  /* prefix 1110 */
+  {7, 1+8, 1}, {7, 1+8, 1},
+  {8, 1+8, 1}, {8, 1+8, 1},
+  {9, 1+8, 1}, {9, 1+8, 1},
+  {10, 1+8, 1}, {10, 1+8, 1},
+  {3, 1+8, 2}, {3, 1+8, 2},
+  {4, 1+8, 2}, {4, 1+8, 2},
+  {2, 1+8, 3}, {2, 1+8, 3},
+  {1, 1+8, 5}, {1, 1+8, 5},
+  {1, 1+8, 6}, {1, 1+8, 6},
+  {1, 1+8, 7}, {1, 1+8, 7},
+  {0, 1+8, 12}, {0, 1+8, 12},
+  {0, 1+8, 13}, {0, 1+8, 13},
+  {0, 1+8, 14}, {0, 1+8, 14},
+  {0, 1+8, 15}, {0, 1+8, 15},
+  {0, 1+8, 16}, {0, 1+8, 16},
+  {0, 1+8, 17}, {0, 1+8, 17},
+
+  /* prefix 1111 0 */
+  {11, 1+9,  1}, /* 1111 0000 0s */
+  {12, 1+9,  1}, /* 1111 0000 1s */
+  {13, 1+9,  1}, /* 1111 0001 0s */
+  {14, 1+9,  1}, /* 1111 0001 1s */
+  {5,  1+9,  2}, /* 1111 0010 0s */
+  {6,  1+9,  2}, /* 1111 0010 1s */
+  {3,  1+9,  3}, /* 1111 0011 0s */
+  {4,  1+9,  3}, /* 1111 0011 1s */
+  {2,  1+9,  4}, /* 1111 0100 0s */
+  {2,  1+9,  5}, /* 1111 0100 1s */
+  {1,  1+9,  8}, /* 1111 0101 0s */
+  {0,  1+9, 18}, /* 1111 0101 1s */
+  {0,  1+9, 19}, /* 1111 0110 0s */
+  {0,  1+9, 20}, /* 1111 0110 1s */
+  {0,  1+9, 21}, /* 1111 0111 0s */
+  {0,  1+9, 22}, /* 1111 0111 1s */
+
+  /* prefix 1111 1 */
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+  {-1, VLC_NOBITS, -1},
+}; /* dv_vlc_lookup2 */
+#endif /* ! __GNUC__ */
+
+#ifdef __GNUC__
+static const dv_vlc_tab_t dv_vlc_lookup3[64] = { 
+  /* len 10+1/prefix 1111 1000 */
+  [0x00 ... 0x03] = {run:  5,  amp:  3, len: 1+10}, /* 1111 1000 00s */
+  [0x04 ... 0x07] = {run:  3,  amp:  4, len: 1+10}, /* 1111 1000 01s */
+  [0x08 ... 0x0b] = {run:  3,  amp:  5, len: 1+10}, /* 1111 1000 10s */
+  [0x0c ... 0x0f] = {run:  2,  amp:  6, len: 1+10}, /* 1111 1000 11s */
+  /* len 10+1/prefix 1111 1001 0 */
+  [0x10 ... 0x13] = {run:  1,  amp:  9, len: 1+10}, /* 1111 1001 00s */
+  [0x14 ... 0x17] = {run:  1,  amp: 10, len: 1+10}, /* 1111 1001 01s */
+  /* len 10+1/prefix 1111 1001 10 */
+  [0x18 ... 0x1b] = {run:  1,  amp: 11, len: 1+10}, /* 1111 1001 10s */
+  /* len 11/prefix 1111 1001 11 */
+  [0x1c ... 0x1d] = {run:  0,  amp:  0, len: 11}, /* 1111 1001 110s */
+  [0x1e ... 0x1f] = {run:  1,  amp:  0, len: 11}, /* 1111 1001 111s */
+  /* len 11+1/prefix 1111 1010 0 */
+  [0x20 ... 0x21] = {run:  6,  amp:  3, len: 1+11}, /* 1111 1010 000s */
+  [0x22 ... 0x23] = {run:  4,  amp:  4, len: 1+11}, /* 1111 1010 001s */
+  [0x24 ... 0x25] = {run:  3,  amp:  6, len: 1+11}, /* 1111 1010 010s */
+  [0x26 ... 0x27] = {run:  1,  amp: 12, len: 1+11}, /* 1111 1010 011s */
+  /* len 11+1/prefix 1111 1010 10 */
+  [0x28 ... 0x29] = {run:  1,  amp: 13, len: 1+11}, /* 1111 1010 100s */
+  [0x2a ... 0x2b] = {run:  1,  amp: 14, len: 1+11}, /* 1111 1010 101s */
+  /* len 12/prefix 1111 1010 11 */
+  [0x2c         ] = {run:  2,  amp:  0, len: 12}, /* 1111 1010 1100 */
+  [0x2d         ] = {run:  3,  amp:  0, len: 12}, /* 1111 1010 1101 */
+  [0x2e         ] = {run:  4,  amp:  0, len: 12}, /* 1111 1010 1110 */
+  [0x2f         ] = {run:  5,  amp:  0, len: 12}, /* 1111 1010 1111 */
+  /* len 12+1/prefix 1111 1011 */
+  [0x30         ] = {run: 7, amp:  2, len: 1+12}, /* 1111 1011 0000s */
+  [0x31         ] = {run: 8, amp:  2, len: 1+12}, /* 1111 1011 0001s */
+  [0x32         ] = {run: 9, amp:  2, len: 1+12}, /* 1111 1011 0010s */
+  [0x33         ] = {run: 10,amp:  2, len: 1+12}, /* 1111 1011 0011s */
+  [0x34         ] = {run: 7, amp:  3, len: 1+12}, /* 1111 1011 0100s */
+  [0x35         ] = {run: 8, amp:  3, len: 1+12}, /* 1111 1011 0101s */
+  [0x36         ] = {run: 4, amp:  5, len: 1+12}, /* 1111 1011 0110s */
+  [0x37         ] = {run: 3, amp:  7, len: 1+12}, /* 1111 1011 0111s */
+  [0x38         ] = {run: 2, amp:  7, len: 1+12}, /* 1111 1011 1000s */
+  [0x39         ] = {run: 2, amp:  8, len: 1+12}, /* 1111 1011 1001s */
+  [0x3a         ] = {run: 2, amp:  9, len: 1+12}, /* 1111 1011 1010s */
+  [0x3b         ] = {run: 2, amp: 10, len: 1+12}, /* 1111 1011 1011s */
+  [0x3c         ] = {run: 2, amp: 11, len: 1+12}, /* 1111 1011 1100s */
+  [0x3d         ] = {run: 1, amp: 15, len: 1+12}, /* 1111 1011 1101s */
+  [0x3e         ] = {run: 1, amp: 16, len: 1+12}, /* 1111 1011 1110s */
+  [0x3f         ] = {run: 1, amp: 17, len: 1+12}, /* 1111 1011 1111s */
+}; /* dv_vlc_lookup3 */
+#else /* ! __GNUC__ */
+static const dv_vlc_tab_t dv_vlc_lookup3[64] = {
+  /* len 10+1/prefix 1111 1000 */
+  {5,  1+10,  3}, /* 1111 1000 00s */
+  {5,  1+10,  3}, /* 1111 1000 00s */
+  {5,  1+10,  3}, /* 1111 1000 00s */
+  {5,  1+10,  3}, /* 1111 1000 00s */
+ 
+  {3,  1+10,  4}, /* 1111 1000 01s */
+  {3,  1+10,  4}, /* 1111 1000 01s */
+  {3,  1+10,  4}, /* 1111 1000 01s */
+  {3,  1+10,  4}, /* 1111 1000 01s */
+ 
+  {3,  1+10,  5}, /* 1111 1000 10s */
+  {3,  1+10,  5}, /* 1111 1000 10s */
+  {3,  1+10,  5}, /* 1111 1000 10s */
+  {3,  1+10,  5}, /* 1111 1000 10s */
+ 
+  {2,  1+10,  6}, /* 1111 1000 11s */
+  {2,  1+10,  6}, /* 1111 1000 11s */
+  {2,  1+10,  6}, /* 1111 1000 11s */
+  {2,  1+10,  6}, /* 1111 1000 11s */
+ 
+  /* len 10+1/prefix 1111 1001 0 */
+  {1,  1+10,  9}, /* 1111 1001 00s */
+  {1,  1+10,  9}, /* 1111 1001 00s */
+  {1,  1+10,  9}, /* 1111 1001 00s */
+  {1,  1+10,  9}, /* 1111 1001 00s */
+ 
+  {1,  1+10, 10}, /* 1111 1001 01s */
+  {1,  1+10, 10}, /* 1111 1001 01s */
+  {1,  1+10, 10}, /* 1111 1001 01s */
+  {1,  1+10, 10}, /* 1111 1001 01s */
+  /* len 10+1/prefix 1111 1001 10 */
+  {1,  1+10, 11}, /* 1111 1001 10s */
+  {1,  1+10, 11}, /* 1111 1001 10s */
+  {1,  1+10, 11}, /* 1111 1001 10s */
+  {1,  1+10, 11}, /* 1111 1001 10s */
+  /* len 11/prefix 1111 1001 11 */
+  {0,  11,  0}, /* 1111 1001 110s */
+  {0,  11,  0}, /* 1111 1001 110s */
+ 
+  {1,  11,  0}, /* 1111 1001 111s */
+  {1,  11,  0}, /* 1111 1001 111s */
+  /* len 11+1/prefix 1111 1010 0 */
+  {6,  1+11,  3}, /* 1111 1010 000s */
+  {6,  1+11,  3}, /* 1111 1010 000s */
+  {4,  1+11,  4}, /* 1111 1010 001s */
+  {4,  1+11,  4}, /* 1111 1010 001s */
+  {3,  1+11,  6}, /* 1111 1010 010s */
+  {3,  1+11,  6}, /* 1111 1010 010s */
+  {1,  1+11, 12}, /* 1111 1010 011s */
+  {1,  1+11, 12}, /* 1111 1010 011s */
+  /* len 11+1/prefix 1111 1010 10 */
+  {1,  1+11, 13}, /* 1111 1010 100s */
+  {1,  1+11, 13}, /* 1111 1010 100s */
+  {1,  1+11, 14}, /* 1111 1010 101s */
+  {1,  1+11, 14}, /* 1111 1010 101s */
+  /* len 12/prefix 1111 1010 11 */
+  {2,  12,  0}, /* 1111 1010 1100 */
+  {3,  12,  0}, /* 1111 1010 1101 */
+  {4,  12,  0}, /* 1111 1010 1110 */
+  {5,  12,  0}, /* 1111 1010 1111 */
+  /* len 12+1/prefix 1111 1011 */
+  {7, 1+12,  2}, /* 1111 1011 0000s */
+  {8, 1+12,  2}, /* 1111 1011 0001s */
+  {9, 1+12,  2}, /* 1111 1011 0010s */
+  {10,1+12,  2}, /* 1111 1011 0011s */
+  {7, 1+12,  3}, /* 1111 1011 0100s */
+  {8, 1+12,  3}, /* 1111 1011 0101s */
+  {4, 1+12,  5}, /* 1111 1011 0110s */
+  {3, 1+12,  7}, /* 1111 1011 0111s */
+  {2, 1+12,  7}, /* 1111 1011 1000s */
+  {2, 1+12,  8}, /* 1111 1011 1001s */
+  {2, 1+12,  9}, /* 1111 1011 1010s */
+  {2, 1+12, 10}, /* 1111 1011 1011s */
+  {2, 1+12, 11}, /* 1111 1011 1100s */
+  {1, 1+12, 15}, /* 1111 1011 1101s */
+  {1, 1+12, 16}, /* 1111 1011 1110s */
+  {1, 1+12, 17}, /* 1111 1011 1111s */
+}; /* dv_vlc_lookup3 */
+#endif /* ! __GNUC__ */
+
+#ifdef __GNUC__
+static dv_vlc_tab_t dv_vlc_lookup4[64] = {  /* len 13/prefix 1111 110 */
+  [0 ... 63]   = {run: 0, amp: -1, len: VLC_ERROR},
+}; /* dv_vlc_lookup4 */
+#else /* ! __GNUC__ */
+static dv_vlc_tab_t dv_vlc_lookup4[64] = {  /* len 13/prefix 1111 110 */
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0,VLC_ERROR, -1}, {0, VLC_ERROR, -1},
+  /* [0 ... 63]   = {run: 0, amp: -1, len: VLC_ERROR}, */
+}; /* dv_vlc_lookup4 */
+#endif /* ! __GNUC__ */
+
+#ifdef __GNUC__
+static dv_vlc_tab_t dv_vlc_lookup5[256] = { /* len 15+1/prefix 1111 111 */
+  [0 ... 255] = {run: 0, amp: -1, len: VLC_ERROR},
+}; /* dv_vlc_lookup6 */
+#else /* ! __GNUC__ */
+static dv_vlc_tab_t dv_vlc_lookup5[256] = { /* len 15+1/prefix 1111 111 */
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+  {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1}, {0,VLC_ERROR,-1},
+}; /* dv_vlc_lookup5 */
+#endif /* ! __GNUC__ */
+
+static dv_vlc_tab_t dv_vlc_class1_shortcut[128];
+
+static void construct_vlc_table(void) {
+  int i;
+
+  for(i=6; i<62; i++) {
+    dv_vlc_lookup4[i].run = i;
+    dv_vlc_lookup4[i].amp = 0;
+    dv_vlc_lookup4[i].len = 13;
+  } /* for */
+  for(i=23; i<256; i++) {
+    dv_vlc_lookup5[i].run = 0;
+    dv_vlc_lookup5[i].amp = i;
+    dv_vlc_lookup5[i].len = 1 + 15;
+  } /* for */
+
+  /* Build dv_vlc_class1_shortcut[] by attempting to match class 1 and
+     class 2 vlcs. */
+  for (i = 0; i < 128; i++) {
+    unsigned int bits = i << 9;
+    unsigned int ms7 = ((bits & 0xfe00) >> 9);
+    const dv_vlc_t *result;
+
+    if (ms7 <= 0x5f) {
+      /* class 1 */
+      result = &dv_vlc_lookup1[i >> 2];
+    } else if (ms7 <= 0x7b) {
+      /* class 2: dv_vlc_index_mask[2], dv_vlc_index_rshift[2] */
+      result = &dv_vlc_lookup2[(bits & 0x3f80) >> 7];
+      if (result->len > 7)
+	result = NULL;
+    } else {
+      result = NULL;
+    }
+
+    /* result is non-NULL if a vlc matched.  The sign bit follows the
+       codeword, i.e. sits at sign_rshift[len] == 16 - len */
+    if (result) {
+      dv_vlc_class1_shortcut[i] = *result;
+      if ((result->amp > 0) && ((bits >> (16 - result->len)) & 1))
+	dv_vlc_class1_shortcut[i].amp *= -1;
+    } else {
+      dv_vlc_class1_shortcut[i] = dv_vlc_lookup1[0x1f];
+    }
+  }
+} /* construct_vlc_table */
+
+/* ---------------------------------------------------------------------------
+ * parse.c
+ */
+
+static int8_t  dv_88_reorder_prime[64] = {
+0, 1, 8, 16, 9, 2, 3, 10,		17, 24, 32, 25, 18, 11, 4, 5,
+12, 19, 26, 33, 40, 48, 41, 34,		27, 20, 13, 6, 7, 14, 21, 28,
+35, 42, 49, 56, 57, 50, 43, 36,		29, 22, 15, 23, 30, 37, 44, 51,
+58, 59, 52, 45, 38, 31, 39, 46,		53, 60, 61, 54, 47, 55, 62, 63
+};
+
+static int8_t  dv_reorder[2][64] = {
+  { 0 },
+  {
+    0, 32, 1, 33, 8, 40, 2, 34,		9, 41, 16, 48, 24, 56, 17, 49,
+    10, 42, 3, 35, 4, 36, 11, 43,		18, 50, 25, 57, 26, 58, 19, 51,
+    12, 44, 5, 37, 6, 38, 13, 45,		20, 52, 27, 59, 28, 60, 21, 53,
+    14, 46, 7, 39, 15, 47, 22, 54,		29, 61, 30, 62, 23, 55, 31, 63 }
+};
+
+static void parse_init(void) {
+  int i;
+  for(i=0;i<64;i++) {
+#if (!ARCH_X86) && (!ARCH_X86_64)
+    dv_reorder[DV_DCT_88][i] = ((dv_88_reorder_prime[i] / 8) * 8) + (dv_88_reorder_prime[i] % 8);
+#else
+    dv_reorder[DV_DCT_88][i] = ((dv_88_reorder_prime[i] % 8) * 8) + (dv_88_reorder_prime[i] / 8);
+#endif
+  } /* for  */
+  for(i=0;i<64;i++) {
+#if ZERO_MULT_ZIGZAG
+    dv_reorder[DV_DCT_88][i] = (dv_reorder[DV_DCT_88][i]) * sizeof(dv_coeff_t);
+    dv_reorder[DV_DCT_248][i] = (dv_reorder[DV_DCT_248][i]) * sizeof(dv_coeff_t);
+#endif
+  } /* for */
+} /* parse_init */
+
+/* ---------------------------------------------------------------------------
+ * quant.c
+ */
+
+static uint8_t dv_88_areas[64] = {
+-1,0,0,1,1,1,2,2,
+ 0,0,1,1,1,2,2,2,
+ 0,1,1,1,2,2,2,3,
+ 1,1,1,2,2,2,3,3,
+
+ 1,1,2,2,2,3,3,3,
+ 1,2,2,2,3,3,3,3,
+ 2,2,2,3,3,3,3,3,
+ 2,2,3,3,3,3,3,3 };
+
+static uint8_t dv_248_areas[64] = {
+-1,0,1,1,1,2,2,3,
+ 0,1,1,2,2,2,3,3,
+ 1,1,2,2,2,3,3,3,
+ 1,2,2,2,3,3,3,3,
+
+ 0,0,1,1,2,2,2,3,
+ 0,1,1,2,2,2,3,3,
+ 1,1,2,2,2,3,3,3,
+ 1,2,2,3,3,3,3,3 };
+
+static uint8_t dv_quant_shifts[22][4] = {
+  { 3,3,4,4 },
+  { 3,3,4,4 },
+
+  { 2,3,3,4 },
+  { 2,3,3,4 },
+
+  { 2,2,3,3 },
+  { 2,2,3,3 },
+
+  { 1,2,2,3 },
+  { 1,2,2,3 },
+
+  { 1,1,2,2 },
+  { 1,1,2,2 },
+
+  { 0,1,1,2 },
+  { 0,1,1,2 },
+
+  { 0,0,1,1 },
+  { 0,0,1,1 },
+
+  { 0,0,0,1 },
+
+  { 0,0,0,0 },
+  { 0,0,0,0 },
+  { 0,0,0,0 },
+  { 0,0,0,0 },
+  { 0,0,0,0 },
+  { 0,0,0,0 },
+  { 0,0,0,0 }
+};
+
+static uint32_t dv_quant_248_mul_tab [2] [22] [64];
+static uint32_t dv_quant_88_mul_tab [2] [22] [64];
+
+static void quant_init(void)
+{
+  int	ex, qno, i;
+
+  for (ex = 0; ex < 2; ++ex) {
+    for (qno = 0; qno < 22; ++qno) {
+      for (i = 0; i < 64; ++i) {
+ 	dv_quant_248_mul_tab [ex] [qno] [i] =
+	  (1 << (dv_quant_shifts [qno] [dv_248_areas [i]] + ex)) * dv_idct_248_prescale[i];
+      }
+      dv_quant_248_mul_tab [ex] [qno] [0] = dv_idct_248_prescale[0];
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------------
+ * rgb.c, YUY2.c and YV12.c: one table per clamp setting, indexed by
+ * (clamp_{luma,chroma} == TRUE).
+ */
+
+static int32_t rgb_table_2_018[2][256];
+static int32_t rgb_table_0_813[2][256];
+static int32_t rgb_table_0_391[2][256];
+static int32_t rgb_table_1_596[2][256];
+static int32_t rgb_ylut[2][768];
+static int32_t rgb_ylut_setup[2][768];
+static uint8_t rgb_rgblut[768];
+
+static uint8_t yuv_uvlut[2][256];
+static uint8_t YUY2_ylut[2][768];
+static uint8_t YUY2_ylut_setup[2][768];
+static uint8_t YV12_ylut[2][768];
+
+static void rgb_init(int clamp) {
+  int i;
+  int clamped_offset;
+  int32_t *table_2_018 = rgb_table_2_018[clamp] + 128;
+  int32_t *table_0_813 = rgb_table_0_813[clamp] + 128;
+  int32_t *table_0_391 = rgb_table_0_391[clamp] + 128;
+  int32_t *table_1_596 = rgb_table_1_596[clamp] + 128;
+  int32_t *ylut = rgb_ylut[clamp] + 256;
+  int32_t *ylut_setup = rgb_ylut_setup[clamp] + 256;
+  uint8_t *rgblut = rgb_rgblut + 256;
+
+  for(i=-128;
+      i<128;
+      ++i) {
+    if ((clamp == TRUE) && (i < (16-128))) {
+      clamped_offset = (16-128);
+    } else if ((clamp == TRUE) && (i > (240-128))) {
+      clamped_offset = (240-128);
+    } else {
+      clamped_offset = i;
+    } // else
+    table_2_018[i] = (int32_t)rint(2.018 * COLOR_FRACTION_MUL * clamped_offset);
+    table_0_813[i] = (int32_t)rint(0.813 * COLOR_FRACTION_MUL * clamped_offset);
+    table_0_391[i] = (int32_t)rint(0.391 * COLOR_FRACTION_MUL * clamped_offset);
+    table_1_596[i] = (int32_t)rint(1.596 * COLOR_FRACTION_MUL * clamped_offset);
+  } // for
+
+  for(i=-256; i < 512; i++) {
+    clamped_offset = i + 128 - 16;
+    if (clamp == TRUE) clamped_offset = CLAMP(clamped_offset, 16, 235);
+    ylut[i] = (int32_t)rint(1.164 * COLOR_FRACTION_MUL * clamped_offset);
+    ylut_setup[i] = (int32_t)rint(1.164 * COLOR_FRACTION_MUL * (clamped_offset+16));
+  } // for
+
+  for(i=-256; i < 512; i++) {
+    rgblut[i] = CLAMP(i, 0, 255);
+  } // for
+} /* rgb_init */
+
+static void yuv_init(int clamp) {
+  int i;
+  int value;
+  uint8_t *uvlut = yuv_uvlut[clamp] + 128;
+  uint8_t *ylut = YUY2_ylut[clamp] + 256;
+  uint8_t *ylut_setup = YUY2_ylut_setup[clamp] + 256;
+  uint8_t *yv12_ylut = YV12_ylut[clamp] + 256;
+
+  for(i=-128;
+      i<128;
+      ++i) {
+    value = i + 128;
+    if (clamp == TRUE) value = CLAMP(value, 16, 240);
+    uvlut[i] = value;
+  } /* for */
+
+  for(i=-256;
+      i<512;
+      ++i) {
+	value = i + 128;
+	if (clamp == TRUE) value = CLAMP(value, 16, 235);
+	/* YV12 does not saturate unclamped luma; keep its wrap */
+	yv12_ylut[i] = value;
+	if (clamp != TRUE) value = CLAMP(value, 0, 255);
+	ylut[i] = value;
+	value += 16;
+	ylut_setup[i] = CLAMP(value, 0, 255);
+  } /* for */
+} /* yuv_init */
+
+/* ---------------------------------------------------------------------------
+ * encode.c
+ */
+
+typedef uint32_t dv_vlc_entry_t;
+
+static inline unsigned long get_dv_vlc_len(dv_vlc_entry_t v)
+{
+	return v & 0xff;
+}
+
+static inline dv_vlc_entry_t set_dv_vlc(unsigned long val, unsigned long len)
+{
+	return len | (val << 8);
+}
+
+typedef struct {
+	int8_t run;
+	int8_t amp;
+	uint16_t val;
+	uint8_t len;
+} dv_vlc_encode_t;
+
+static dv_vlc_encode_t dv_vlc_test_table[89] = {
+	{ 0, 1, 0x0, 2 },
+	{ 0, 2, 0x2, 3 },
+	{-1, 0, 0x6, 4 },
+	{ 1, 1, 0x7, 4 },
+	{ 0, 3, 0x8, 4 },
+	{ 0, 4, 0x9, 4 },
+	{ 2, 1, 0x14, 5 },
+	{ 1, 2, 0x15, 5 },
+	{ 0, 5, 0x16, 5 },
+	{ 0, 6, 0x17, 5 },
+	{ 3, 1, 0x30, 6 },
+	{ 4, 1, 0x31, 6 },
+	{ 0, 7, 0x32, 6 },
+	{ 0, 8, 0x33, 6 },
+	{ 5, 1,  0x68, 7 },
+	{ 6, 1,  0x69, 7 },
+	{ 2, 2,  0x6a, 7 },
+	{ 1, 3,  0x6b, 7 },
+	{ 1, 4,  0x6c, 7 },
+	{ 0, 9,  0x6d, 7 },
+	{ 0, 10, 0x6e, 7 },
+	{ 0, 11, 0x6f, 7 },
+	{ 7,  1,  0xe0, 8 },
+	{ 8,  1,  0xe1, 8 },
+	{ 9,  1,  0xe2, 8 },
+	{ 10, 1,  0xe3, 8 },
+	{ 3,  2,  0xe4, 8 },
+	{ 4,  2,  0xe5, 8 },
+	{ 2,  3,  0xe6, 8 },
+	{ 1,  5,  0xe7, 8 },
+	{ 1,  6,  0xe8, 8 },
+	{ 1,  7,  0xe9, 8 },
+	{ 0,  12, 0xea, 8 },
+	{ 0,  13, 0xeb, 8 },
+	{ 0,  14, 0xec, 8 },
+	{ 0,  15, 0xed, 8 },
+	{ 0,  16, 0xee, 8 },
+	{ 0,  17, 0xef, 8 },
+	{ 11, 1,  0x1e0, 9 },
+	{ 12, 1,  0x1e1, 9 },
+	{ 13, 1,  0x1e2, 9 },
+	{ 14, 1,  0x1e3, 9 },
+	{ 5,  2,  0x1e4, 9 },
+	{ 6,  2,  0x1e5, 9 },
+	{ 3,  3,  0x1e6, 9 },
+	{ 4,  3,  0x1e7, 9 },
+	{ 2,  4,  0x1e8, 9 },
+	{ 2,  5,  0x1e9, 9 },
+	{ 1,  8,  0x1ea, 9 },
+	{ 0,  18, 0x1eb, 9 },
+	{ 0,  19, 0x1ec, 9 },
+	{ 0,  20, 0x1ed, 9 },
+	{ 0,  21, 0x1ee, 9 },
+	{ 0,  22, 0x1ef, 9 },
+	{ 5, 3,  0x3e0, 10 },
+	{ 3, 4,  0x3e1, 10 },
+	{ 3, 5,  0x3e2, 10 },
+	{ 2, 6,  0x3e3, 10 },
+	{ 1, 9,  0x3e4, 10 },
+	{ 1, 10, 0x3e5, 10 },
+	{ 1, 11, 0x3e6, 10 },
+	{ 0, 0,  0x7ce, 11 },
+	{ 1, 0,  0x7cf, 11 },
+	{ 6, 3,  0x7d0, 11 },
+	{ 4, 4,  0x7d1, 11 },
+	{ 3, 6,  0x7d2, 11 },
+	{ 1, 12, 0x7d3, 11 },
+	{ 1, 13, 0x7d4, 11 },
+	{ 1, 14, 0x7d5, 11 },
+	{ 2, 0, 0xfac, 12 },
+	{ 3, 0, 0xfad, 12 },
+	{ 4, 0, 0xfae, 12 },
+	{ 5, 0, 0xfaf, 12 },
+	{ 7,  2,  0xfb0, 12 },
+	{ 8,  2,  0xfb1, 12 },
+	{ 9,  2,  0xfb2, 12 },
+	{ 10, 2,  0xfb3, 12 },
+	{ 7,  3,  0xfb4, 12 },
+	{ 8,  3,  0xfb5, 12 },
+	{ 4,  5,  0xfb6, 12 },
+	{ 3,  7,  0xfb7, 12 },
+	{ 2,  7,  0xfb8, 12 },
+	{ 2,  8,  0xfb9, 12 },
+	{ 2,  9,  0xfba, 12 },
+	{ 2,  10, 0xfbb, 12 },
+	{ 2,  11, 0xfbc, 12 },
+	{ 1,  15, 0xfbd, 12 },
+	{ 1,  16, 0xfbe, 12 },
+	{ 1,  17, 0xfbf, 12 },
+}; /* dv_vlc_test_table */
+
+static dv_vlc_encode_t * vlc_test_lookup[512];
+
+static void init_vlc_test_lookup(void)
+{
+	int i;
+	memset(vlc_test_lookup, 0, 512 * sizeof(dv_vlc_encode_t*));
+	for (i = 0; i < 89; i++) {
+		dv_vlc_encode_t *pvc = &dv_vlc_test_table[i];
+		vlc_test_lookup[((pvc->run + 1) << 5) + pvc->amp] = pvc;
+	}
+}
+
+static inline dv_vlc_encode_t * find_vlc_entry(int run, int amp)
+{
+	if (run > 14 || amp > 22) { /* run < -1 || amp < 0 never happens! */
+		return NULL;
+	} else {
+		return vlc_test_lookup[((run + 1) << 5) + amp];
+	}
+}
+
+static inline void vlc_encode_r(int run, int amp, int sign, dv_vlc_entry_t * o)
+{
+	dv_vlc_encode_t * hit = find_vlc_entry(run, amp);
+
+	if (hit != NULL) {
+		/* 1111110 */
+		int val, len;
+		val = hit->val;
+		len = hit->len;
+		if (amp != 0) {
+			val <<= 1;
+			val |= sign;
+			len++;
+		}
+		*o = set_dv_vlc(val, len);
+	} else {
+		if (amp == 0) {
+			/* 1111110 */
+			*o = set_dv_vlc((0x7e << 6) | run, 7+6);
+		} else {
+			/* 1111111 */
+			*o = set_dv_vlc((0x7f << 9) | (amp << 1) | sign,
+					7 + 8 + 1);
+		}
+	}
+}
+
+static inline dv_vlc_entry_t * vlc_encode_orig(int run, int amp, int sign,
+					       dv_vlc_entry_t * o)
+{
+	dv_vlc_encode_t * hit = find_vlc_entry(run, amp);
+
+	if (hit != NULL) {
+		/* 1111110 */
+		int val, len;
+		val = hit->val;
+		len = hit->len;
+		if (amp != 0) {
+			val <<= 1;
+			val |= sign;
+			len++;
+		}
+		*o++ = 0;
+		*o = set_dv_vlc(val, len);
+	} else {
+		if (amp == 0) {
+			*o++ = 0;
+			if (run < 62) {
+				/* 1111110 */
+				*o = set_dv_vlc((0x7e << 6) | run, 7+6);
+			} else {
+				*o = set_dv_vlc((0x7cf << 13)
+						| (0x7e << 6) | (run - 2),
+						11 + 7 + 6);
+			}
+		} else if (run == 0) {
+			/* 1111111 */
+			*o++ = 0;
+			*o = set_dv_vlc((0x7f << 9) | (amp << 1) | sign,
+					7 + 8 + 1);
+		} else {
+			vlc_encode_r(run - 1, 0, 0, o);
+			++o;
+			vlc_encode_r(0, amp, sign, o);
+			return ++o;
+		}
+	}
+	return ++o;
+}
+
+static dv_vlc_entry_t vlc_encode_table[32768 * 2];
+static unsigned char  vlc_num_bits_table[32768];
+
+static void init_vlc_encode_lookup(void)
+{
+	int run,amp;
+
+	for (run = 0; run <= 63; run++) {
+		for (amp = 0; amp <= 255; amp++) {
+			int index1 = (255 + amp) | (run << 9);
+			int index2 = (255 - amp) | (run << 9);
+			vlc_encode_orig(run,amp,0,vlc_encode_table+2* index1);
+			vlc_encode_orig(run,amp,1,vlc_encode_table+2* index2);
+			vlc_num_bits_table[index1] =
+				vlc_num_bits_table[index2] =
+				get_dv_vlc_len(vlc_encode_table[2*index1])
+				+get_dv_vlc_len(vlc_encode_table[2*index1+1]);
+		}
+	}
+}
+
+static unsigned short reorder_88[64] = {
+	1, 2, 6, 7,15,16,28,29,
+	3, 5, 8,14,17,27,30,43,
+	4, 9,13,18,26,31,42,44,
+	10,12,19,25,32,41,45,54,
+	11,20,24,33,40,46,53,55,
+	21,23,34,39,47,52,56,61,
+	22,35,38,48,51,57,60,62,
+	36,37,49,50,58,59,63,64
+};
+static unsigned short reorder_248[64] = {
+	1, 3, 7,19,21,35,37,51,
+	5, 9,17,23,33,39,49,53,
+	11,15,25,31,41,47,55,61,
+	13,27,29,43,45,57,59,63,
+
+	2, 4, 8,20,22,36,38,52,
+	6,10,18,24,34,40,50,54,
+	12,16,26,32,42,48,56,62,
+	14,28,30,44,46,58,60,64
+};
+
+static void prepare_reorder_tables(void)
+{
+	int i;
+	for (i = 0; i < 64; i++) {
+		reorder_88[i]--;
+		reorder_88[i] *= 2;
+		reorder_248[i]--;
+		reorder_248[i] *= 2;
+	}
+}
+
+static int qnos[4][16] = {
+	{ 15,                  8,    6,    4,    2, 0},
+	{ 15,         11, 10,  8,    6,    4,    2, 0},
+	{ 15, 14, 13, 11,      8,    6,    4,    2, 0},
+	{ 15,     13, 12, 10,  8,    6,    4,    2, 0}
+};
+
+static int qnos_class_combi[16][16];
+static int qno_next_hit[4][16];
+
+static void init_qno_start(void)
+{
+	int qno;
+	int klass;
+	int qno_p[4];
+	int combi_p[16];
+
+	memset(qno_p, 0, sizeof(qno_p));
+	memset(combi_p, 0, sizeof(combi_p));
+
+	for (qno = 15; qno >= 0; qno--) {
+		int i;
+
+		for (klass = 0; klass < 4; klass++) {
+			if (qnos[klass][qno_p[klass]] > qno) {
+				qno_p[klass]++;
+			}
+                        i = 0;
+                        while (qnos[klass][i] > qno) {
+                                i++;
+                        }
+                        qno_next_hit[klass][qno] = i;
+
+		}
+		for (i = 1; i < 16; i++) {
+			int q = 0;
+			for (klass = 0; klass < 4; klass++) {
+				if ((i & (1 << klass))
+				    && qnos[klass][qno_p[klass]] > q) {
+					q = qnos[klass][qno_p[klass]];
+				}
+			}
+			if (combi_p[i] == 0 ||
+			    qnos_class_combi[i][combi_p[i] - 1] != q) {
+				qnos_class_combi[i][combi_p[i]++] = q;
+			}
+		}
+	}
+}
+
+/* ---------------------------------------------------------------------------
+ * enc_output.c: where the samples of each audio DIF block come from.
+ * Indexed by DIF sequence (within the half of the frame that carries
+ * a channel (pair)), audio DIF block, then sample in the block: 36 of
+ * 16 bits or the first 24 for 12 bit.
+ */
+static int dv_audio_unshuffle_60[5][9] = {
+  { 0, 15, 30, 10, 25, 40,  5, 20, 35 },
+  { 3, 18, 33, 13, 28, 43,  8, 23, 38 },
+  { 6, 21, 36,  1, 16, 31, 11, 26, 41 },
+  { 9, 24, 39,  4, 19, 34, 14, 29, 44 },
+  {12, 27, 42,  7, 22, 37,  2, 17, 32 },
+};
+
+static int dv_audio_unshuffle_50[6][9] = {
+  {  0, 18, 36, 13, 31, 49,  8, 26, 44 },
+  {  3, 21, 39, 16, 34, 52, 11, 29, 47 },
+  {  6, 24, 42,  1, 19, 37, 14, 32, 50 }, 
+  {  9, 27, 45,  4, 22, 40, 17, 35, 53 }, 
+  { 12, 30, 48,  7, 25, 43,  2, 20, 38 },
+  { 15, 33, 51, 10, 28, 46,  5, 23, 41 },
+};
+
+static uint16_t audio_shuffle_60[5][9][36];
+static uint16_t audio_shuffle_50[6][9][36];
+/* the exponent of the 12 bit nonlinear code of a 16 bit magnitude,
+   indexed by magnitude >> 8, see IEC 61834-2 figure 16 */
+static uint8_t audio_12bit_shift[128];
+
+static void init_audio_shuffle(void)
+{
+	int ds, dif, n;
+
+	for (ds = 0; ds < 6; ds++) {
+		for (dif = 0; dif < 9; dif++) {
+			for (n = 0; n < 36; n++) {
+				if (ds < 5) {
+					audio_shuffle_60[ds][dif][n] = 
+						dv_audio_unshuffle_60[ds][dif]
+						+ n * 45;
+				}
+				audio_shuffle_50[ds][dif][n] = 
+					dv_audio_unshuffle_50[ds][dif] 
+					+ n * 54;
+			}
+		}
+	}
+	for (n = 0; n < 128; n++) {
+		int shift = 0;
+
+		while ((n >> shift) > 1) {
+			shift++;
+		}
+		audio_12bit_shift[n] = shift;
+	}
+}
+
+/* ---------------------------------------------------------------------------
+ */
+int main(int argc, char *argv[])
+{
+  weight_init();
+  dct_init();
+  dct_248_init();
+  construct_vlc_table();
+  parse_init();
+  quant_init();
+  rgb_init(FALSE);
+  rgb_init(TRUE);
+  yuv_init(FALSE);
+  yuv_init(TRUE);
+  init_vlc_test_lookup();
+  init_vlc_encode_lookup();
+  prepare_reorder_tables();
+  init_qno_start();
+  init_audio_shuffle();
+
+  printf("/* tables.c -- generated by gentables, do not edit */\n\n");
+  printf("#if HAVE_CONFIG_H\n# include <config.h>\n#endif\n\n");
+  printf("#include \"tables.h\"\n\n");
+
+  /* weighting.c, dct.c, idct_248.c */
+  EMIT_INTS("const dv_coeff_t preSC[64] ALIGN32", preSC, 64);
+  EMIT_INTS("const dv_coeff_t postSC88[64] ALIGN32", postSC88, 64);
+  EMIT_INTS("const dv_coeff_t postSC248[64] ALIGN32", postSC248, 64);
+#if (!ARCH_X86) && (!ARCH_X86_64)
+  EMIT_INTS("const dv_coeff_t dv_weight_inverse_88_matrix[64]",
+	    dv_weight_inverse_88_matrix, 64);
+#endif
+#if BRUTE_FORCE_DCT_88
+  EMIT_DOUBLES("const double dv_weight_88_matrix[64]", dv_weight_88_matrix, 64);
+#endif
+#if BRUTE_FORCE_DCT_248
+  EMIT_DOUBLES("const double dv_weight_248_matrix[64]", dv_weight_248_matrix, 64);
+#endif
+#if BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
+  EMIT_DOUBLES("const double _dv_dct_KC248[8][4][4][8]", &KC248[0][0][0][0], 8, 4, 4, 8);
+#endif
+#if ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
+  EMIT_DOUBLES("const double _dv_dct_C[8]", C, 8);
+  EMIT_DOUBLES("const double _dv_dct_KC88[8][8][8][8]", &KC88[0][0][0][0], 8, 8, 8, 8);
+#endif
+  EMIT_INTS("const dv_248_coeff_t dv_idct_248_prescale[64]", dv_idct_248_prescale, 64);
+  EMIT_INTS("const int32_t dv_idct_248_beta[5]", dv_idct_248_beta, 5);
+
+  /* vlc.c */
+  emit_vlc_table("const dv_vlc_tab_t dv_vlc_lookup1[32]", dv_vlc_lookup1, 32);
+  emit_vlc_table("const dv_vlc_tab_t dv_vlc_lookup2[128]", dv_vlc_lookup2, 128);
+  emit_vlc_table("const dv_vlc_tab_t dv_vlc_lookup3[64]", dv_vlc_lookup3, 64);
+  emit_vlc_table("const dv_vlc_tab_t dv_vlc_lookup4[64]", dv_vlc_lookup4, 64);
+  emit_vlc_table("const dv_vlc_tab_t dv_vlc_lookup5[256]", dv_vlc_lookup5, 256);
+  emit_vlc_table("const dv_vlc_tab_t dv_vlc_class1_shortcut[128]",
+		 dv_vlc_class1_shortcut, 128);
+
+  /* parse.c, quant.c */
+  EMIT_INTS("const int8_t dv_reorder[2][64]", &dv_reorder[0][0], 2, 64);
+  EMIT_INTS("const uint8_t dv_88_areas[64]", dv_88_areas, 64);
+  EMIT_INTS("const uint8_t dv_248_areas[64]", dv_248_areas, 64);
+  EMIT_INTS("const uint8_t dv_quant_shifts[22][4]", &dv_quant_shifts[0][0], 22, 4);
+  EMIT_INTS("const uint32_t dv_quant_248_mul_tab[2][22][64]",
+	    &dv_quant_248_mul_tab[0][0][0], 2, 22, 64);
+  EMIT_INTS("const uint32_t dv_quant_88_mul_tab[2][22][64]",
+	    &dv_quant_88_mul_tab[0][0][0], 2, 22, 64);
+
+  /* rgb.c, YUY2.c, YV12.c */
+  EMIT_INTS("const int32_t _dv_rgb_table_2_018[2][256]", &rgb_table_2_018[0][0], 2, 256);
+  EMIT_INTS("const int32_t _dv_rgb_table_0_813[2][256]", &rgb_table_0_813[0][0], 2, 256);
+  EMIT_INTS("const int32_t _dv_rgb_table_0_391[2][256]", &rgb_table_0_391[0][0], 2, 256);
+  EMIT_INTS("const int32_t _dv_rgb_table_1_596[2][256]", &rgb_table_1_596[0][0], 2, 256);
+  EMIT_INTS("const int32_t _dv_rgb_ylut[2][768]", &rgb_ylut[0][0], 2, 768);
+  EMIT_INTS("const int32_t _dv_rgb_ylut_setup[2][768]", &rgb_ylut_setup[0][0], 2, 768);
+  EMIT_INTS("const uint8_t _dv_rgb_rgblut[768]", rgb_rgblut, 768);
+  EMIT_INTS("const uint8_t _dv_uvlut[2][256]", &yuv_uvlut[0][0], 2, 256);
+  EMIT_INTS("const uint8_t _dv_YUY2_ylut[2][768]", &YUY2_ylut[0][0], 2, 768);
+  EMIT_INTS("const uint8_t _dv_YUY2_ylut_setup[2][768]", &YUY2_ylut_setup[0][0], 2, 768);
+  EMIT_INTS("const uint8_t _dv_YV12_ylut[2][768]", &YV12_ylut[0][0], 2, 768);
+
+  /* encode.c */
+  EMIT_INTS("const uint32_t _dv_vlc_encode_table[32768 * 2]",
+	    vlc_encode_table, 32768 * 2);
+  EMIT_INTS("const uint8_t _dv_vlc_num_bits_table[32768]",
+	    vlc_num_bits_table, 32768);
+  EMIT_INTS("const unsigned short _dv_reorder_88[64]", reorder_88, 64);
+  EMIT_INTS("const unsigned short _dv_reorder_248[64]", reorder_248, 64);
+  EMIT_INTS("const int _dv_qnos[4][16]", &qnos[0][0], 4, 16);
+  EMIT_INTS("const int _dv_qnos_class_combi[16][16]", &qnos_class_combi[0][0], 16, 16);
+  EMIT_INTS("const int _dv_qno_next_hit[4][16]", &qno_next_hit[0][0], 4, 16);
+
+  /* enc_output.c */
+  EMIT_INTS("const uint16_t _dv_audio_shuffle_60[5][9][36]",
+	    &audio_shuffle_60[0][0][0], 5, 9, 36);
+  EMIT_INTS("const uint16_t _dv_audio_shuffle_50[6][9][36]",
+	    &audio_shuffle_50[0][0][0], 6, 9, 36);
+  EMIT_INTS("const uint8_t _dv_audio_12bit_shift[128]", audio_12bit_shift, 128);
+
+  return 0;
+}
@@ -31,6 +31,7 @@
 #include <string.h>
 #include <inttypes.h>
 
+#include "dv_types.h"
 #include "headers.h"
 
 static void write_header_block(unsigned char* target, int ds, int isPAL)
@@ -53,7 +54,7 @@ static inline void write_bcd(unsigned char* target, int val)
 	*target = ((val / 10) << 4) + (val % 10);
 }
 
-static void write_timecode_13(unsigned char* target, struct tm * now, int frame,
+static void write_timecode_13(unsigned char* target, const struct tm * now, int frame,
 		       int isPAL)
 {
 	target[0] = 0x13;
@@ -88,7 +89,7 @@ static void write_timecode_61(unsigned char* target, struct tm * now,
 	target[4] = 0xff;
 }
 
-static void write_timecode_62(unsigned char* target, struct tm * now)
+static void write_timecode_62(unsigned char* target, const struct tm * now)
 {
 	target[0] = 0x62;
 	target[1] = 0xff;
@@ -97,7 +98,7 @@ static void write_timecode_62(unsigned char* target, struct tm * now)
 	write_bcd(target + 4, now->tm_year % 100);
 }
 
-static void write_timecode_63(unsigned char* target, struct tm * now)
+static void write_timecode_63(unsigned char* target, const struct tm * now)
 {
 	target[0] = 0x63;
 	target[1] = 0xff;
@@ -106,11 +107,58 @@ static void write_timecode_63(unsigned char* target, struct tm * now)
 	write_bcd(target + 4, now->tm_hour);
 }
 
+/* where the second half of a DIF sequence carries its subcode packs,
+   relative to the first subcode block */
+static const int subcode_tc_offsets[4] = {
+	6, 80 + 6, 6 + 3*8, 80 + 6 + 3*8
+};
+
+static void write_subcode_block_count(unsigned char* target, int ds, 
+				      int frame, int isPAL)
+{
+	/* The subcode block number runs on from sequence to sequence and
+	   frame to frame, so derive it from the position in the stream
+	   rather than keeping a counter around. */
+	int block_count = ((frame * (isPAL ? 12 : 10) + ds) * 0x20) & 0xfff;
+	int flag = (ds >= 6) ? 0x80 : 0x00;
+
+	target[3] = flag | (block_count >> 8);
+	target[4] = block_count;
+
+	target[80 + 3] = flag | (block_count >> 8);
+	target[80 + 4] = block_count + 6;
+}
+
+/* the recording date and time packs of the subcode blocks, ds >= 6 */
+static void write_subcode_dates(unsigned char* target, const struct tm * now)
+{
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		write_timecode_62(target + subcode_tc_offsets[i] + 8, now);
+		write_timecode_63(target + subcode_tc_offsets[i] + 2*8, now);
+	}
+}
+
+/* the parts of the subcode blocks that change from frame to frame */
+static void write_subcode_counters(unsigned char* target, int ds, int frame,
+				   const struct tm * now, int isPAL)
+{
+	int i;
+
+	write_subcode_block_count(target, ds, frame, isPAL);
+	if (ds >= 6) {
+		for (i = 0; i < 4; i++) {
+			write_timecode_13(target + subcode_tc_offsets[i], 
+					  now, frame, isPAL);
+		}
+		write_subcode_dates(target, now);
+	}
+}
+
 static void write_subcode_blocks(unsigned char* target, int ds, int frame, 
 				 struct tm * now, int isPAL)
 {
-	static int block_count = 0;
-
 	memset(target, 0xff, 2*80);
 
 	target[0] = 0x3f; /* subcode magic */
@@ -123,40 +171,19 @@ static void write_subcode_blocks(unsigned char* target, int ds, int frame,
 	
 	target[5] = target[80 + 5] = 0xff;
 
-	if (ds >= 6) {
-		target[3] = 0x80 | (block_count >> 8);
-		target[4] = block_count;
-
-		target[80 + 3] = 0x80 | (block_count >> 8);
-		target[80 + 4] = block_count + 6;
-
-		write_timecode_13(target + 6, now, frame, isPAL);
-		write_timecode_13(target + 80 + 6, now, frame, isPAL);
-
-		write_timecode_62(target + 6 + 8, now);
-		write_timecode_62(target + 80 + 6 + 8, now);
-
-		write_timecode_63(target + 6 + 2*8, now);
-		write_timecode_63(target + 80 + 6 + 2*8, now);
-
-		write_timecode_13(target + 6 + 3*8, now, frame, isPAL);
-		write_timecode_13(target + 80 + 6 + 3*8, now, frame, isPAL);
-
-		write_timecode_62(target + 6 + 4*8, now);
-		write_timecode_62(target + 80 + 6 + 4*8, now);
-
-		write_timecode_63(target + 6 + 5*8, now);
-		write_timecode_63(target + 80 + 6 + 5*8, now);
-	} else {
-		target[3] = (block_count >> 8);
-		target[4] = block_count;
+	write_subcode_counters(target, ds, frame, now, isPAL);
+}
 
-		target[80 + 3] = (block_count >> 8);
-		target[80 + 4] = block_count + 6;
-		
+/* the recording date and time packs of the VAUX blocks */
+static void write_vaux_dates(unsigned char* target, int ds, 
+			     const struct tm* now)
+{
+	if (ds & 1) {
+		write_timecode_62(target + 3 + 2*5, now);
+		write_timecode_63(target + 3 + 3*5, now);
 	}
-	block_count += 0x20;
-	block_count &= 0xfff;
+	write_timecode_62(target + 2*80+ 48 + 2*5, now);
+	write_timecode_63(target + 2*80+ 48 + 3*5, now);
 }
 
 static void write_vaux_blocks(unsigned char* target, int ds, struct tm* now,
@@ -198,13 +225,10 @@ static void write_vaux_blocks(unsigned char* target, int ds, struct tm* now,
 	} else {
 		write_timecode_60(target + 3, now, isPAL);
 		write_timecode_61(target + 3 + 5, now, is16x9);
-		write_timecode_62(target + 3 + 2*5, now);
-		write_timecode_63(target + 3 + 3*5, now);
 	}
 	write_timecode_60(target + 2*80+ 48, now, isPAL);
 	write_timecode_61(target + 2*80+ 48 + 5, now, is16x9);
-	write_timecode_62(target + 2*80+ 48 + 2*5, now);
-	write_timecode_63(target + 2*80+ 48 + 3*5, now);
+	write_vaux_dates(target, ds, now);
 }
 
 static void write_video_headers(unsigned char* target, int frame, int ds)
@@ -243,7 +267,8 @@ void _dv_write_meta_data(unsigned char* target, int frame, int isPAL,
 {
 	int numDIFseq;
 	int ds;
-	struct tm * now_t = NULL;
+	struct tm now_tm;
+	struct tm * now_t = &now_tm;
 
 	numDIFseq = isPAL ? 12 : 10;
 
@@ -251,7 +276,7 @@ void _dv_write_meta_data(unsigned char* target, int frame, int isPAL,
 		(*now)++;
 	}
 
-	now_t = localtime(now);
+	localtime_r(now, now_t);
 
 	for (ds = 0; ds < numDIFseq; ds++) { 
 		write_header_block(target, ds, isPAL);
@@ -266,6 +291,63 @@ void _dv_write_meta_data(unsigned char* target, int frame, int isPAL,
 	}
 }
 
+/* ---------------------------------------------------------------------------
+ * Frame templates.  dv_encode_full_frame() builds the parts of a frame
+ * that stay the same once; per frame it copies the blocks without video
+ * from the template, fills in the counters, timecode and date, and
+ * leaves the video DIF blocks to the segment encoder.
+ */
+
+/* the DIF block headers of video segment v of DIF sequence ds */
+void _dv_write_video_segment_headers(unsigned char* vsbuffer, int frame, 
+				     int ds, int v)
+{
+	int m;
+
+	for (m = 0; m < 5; m++) {
+		vsbuffer[0] = 0x90 | ((frame + 0xb) % 12);
+		vsbuffer[1] = 0x07 | (ds << 4);
+		vsbuffer[2] = v * 5 + m;
+		vsbuffer += 80;
+	}
+}
+
+void _dv_write_frame_template(unsigned char* target, int isPAL, int is16x9)
+{
+	struct tm zero;
+	int ds;
+
+	memset(&zero, 0, sizeof(zero));
+	memset(target, 0, isPAL ? 144000 : 120000);
+	for (ds = 0; ds < (isPAL ? 12 : 10); ds++) { 
+		write_header_block(target, ds, isPAL);
+		write_subcode_blocks(target + 80, ds, 0, &zero, isPAL);
+		write_vaux_blocks(target + 3 * 80, ds, &zero, isPAL, is16x9);
+		write_audio_headers(target + 6 * 80, 0, ds);
+		target += 150 * 80;
+	}
+}
+
+void _dv_write_frame_meta(unsigned char* target, const unsigned char* tmpl,
+			  int frame, int isPAL, const struct tm* now)
+{
+	int ds, i;
+
+	for (ds = 0; ds < (isPAL ? 12 : 10); ds++) { 
+		/* header, subcode and VAUX blocks */
+		memcpy(target, tmpl, 6 * 80);
+		write_subcode_counters(target + 80, ds, frame, now, isPAL);
+		write_vaux_dates(target + 3 * 80, ds, now);
+		for (i = 0; i < 9; i++) {
+			unsigned char *audio = target + (6 + i * 16) * 80;
+
+			memcpy(audio, tmpl + (6 + i * 16) * 80, 80);
+			audio[0] = 0x70 | ((frame + 0xb) % 12);
+		}
+		target += 150 * 80;
+		tmpl += 150 * 80;
+	}
+}
 
 /** @brief Write the recording datetime and timecode into a frame of DV video.
  *
@@ -346,3 +428,174 @@ void dv_encode_timecode(uint8_t* target, int isPAL, int frame)
 		buf += 144 * 80;
 	}
 }
+
+/* ---------------------------------------------------------------------------
+ * Metadata stamper.  Keeps the subcode and VAUX blocks of every DIF
+ * sequence prebuilt, with the date packs of the last second stamped, so
+ * that restamping a frame comes down to copying them and patching the
+ * block numbers and timecodes.
+ */
+struct dv_metadata_stamper_s {
+	int           isPAL;
+	int           is16x9;
+	time_t        time;     /* of the date packs in blocks */
+	struct tm     tm;
+	int           have_time;
+	unsigned char blocks[12][5 * 80];
+};
+
+static void stamper_set_time(dv_metadata_stamper_t *st, const struct tm *now)
+{
+	int ds;
+
+	for (ds = 0; ds < (st->isPAL ? 12 : 10); ds++) {
+		if (ds >= 6) {
+			write_subcode_dates(st->blocks[ds], now);
+		}
+		write_vaux_dates(st->blocks[ds] + 2 * 80, ds, now);
+	}
+}
+
+/* the pack 13 timecodes of one frame */
+static void stamper_write_timecodes(dv_metadata_stamper_t *st,
+				    uint8_t *target, const struct tm *now,
+				    int frame)
+{
+	unsigned char pack[5];
+	int ds, i;
+
+	write_timecode_13(pack, now, frame, st->isPAL);
+	target += 6 * 150 * 80 + 80;
+	for (ds = 6; ds < (st->isPAL ? 12 : 10); ds++) {
+		for (i = 0; i < 4; i++) {
+			memcpy(target + subcode_tc_offsets[i], pack, 5);
+		}
+		target += 150 * 80;
+	}
+}
+
+/** @brief Create a metadata stamper.
+ *
+ * A stamper writes the same subcode and VAUX blocks as
+ * dv_encode_metadata() and the same timecodes as dv_encode_timecode(),
+ * but builds everything that stays the same from frame to frame once.
+ * Use it to restamp long runs of frames.
+ *
+ * @param isPAL Set true (non-zero) to stamp frames in PAL format.
+ * @param is16x9 Set true (non-zero) to flag the frames as widescreen.
+ *
+ * @return the new stamper, or NULL if out of memory.
+ */
+dv_metadata_stamper_t *dv_metadata_stamper_new(int isPAL, int is16x9)
+{
+	dv_metadata_stamper_t *st;
+	struct tm zero;
+	int ds;
+
+	st = (dv_metadata_stamper_t *) calloc(1, sizeof(*st));
+	if (!st) {
+		return NULL;
+	}
+	st->isPAL = isPAL;
+	st->is16x9 = is16x9;
+
+	memset(&zero, 0, sizeof(zero));
+	for (ds = 0; ds < (isPAL ? 12 : 10); ds++) {
+		write_subcode_blocks(st->blocks[ds], ds, 0, &zero, isPAL);
+		write_vaux_blocks(st->blocks[ds] + 2 * 80, ds, &zero, 
+				  isPAL, is16x9);
+	}
+	return st;
+}
+
+/** @brief Destroy a metadata stamper.
+ *
+ * @param st A stamper from dv_metadata_stamper_new(), or NULL.
+ */
+void dv_metadata_stamper_free(dv_metadata_stamper_t *st)
+{
+	free(st);
+}
+
+/** @brief Write the recording datetime and timecode into a frame, like
+ * dv_encode_metadata().
+ *
+ * @param st The stamper, which fixes the format of the frame.
+ * @param target A pointer to a buffer containing one DV frame.
+ * @param datetime The recording time, advanced by one second on every
+ *        frame number that is a multiple of the frame rate.
+ * @param frame A zero-based running frame counter.
+ */
+void dv_metadata_stamp(dv_metadata_stamper_t *st, uint8_t *target, 
+		       time_t *datetime, int frame)
+{
+	int ds;
+
+	if (frame % (st->isPAL ? 25 : 30) == 0) {
+		(*datetime)++;
+	}
+	if (!st->have_time || *datetime != st->time) {
+		if (localtime_r(datetime, &st->tm) == NULL) {
+			st->have_time = 0;
+			return;
+		}
+		stamper_set_time(st, &st->tm);
+		st->time = *datetime;
+		st->have_time = 1;
+	}
+	for (ds = 0; ds < (st->isPAL ? 12 : 10); ds++) {
+		uint8_t *subcode = target + ds * 150 * 80 + 80;
+
+		memcpy(subcode, st->blocks[ds], 5 * 80);
+		write_subcode_block_count(subcode, ds, frame, st->isPAL);
+	}
+	stamper_write_timecodes(st, target, &st->tm, frame);
+}
+
+/** @brief Convert a frame count into a timecode and write it into a
+ * frame, like dv_encode_timecode().
+ *
+ * @param st The stamper, which fixes the format of the frame.
+ * @param target A pointer to a buffer containing one DV frame.
+ * @param frame A zero-based running frame counter.
+ */
+void dv_metadata_stamp_timecode(dv_metadata_stamper_t *st, uint8_t *target,
+				int frame)
+{
+	int fps = st->isPAL ? 25 : 30;
+	struct tm time;
+
+	time.tm_sec = (frame / fps) % 60;
+	time.tm_min = (frame / (fps * 60)) % 60;
+	time.tm_hour = frame / (fps * 3600);
+	stamper_write_timecodes(st, target, &time, frame % fps);
+}
+
+/** @brief Stamp a run of consecutive frames.
+ *
+ * Equivalent to calling dv_metadata_stamp() and, if asked for,
+ * dv_metadata_stamp_timecode() for frame, frame + 1, ...
+ *
+ * @param st The stamper, which fixes the format of the frames.
+ * @param frames count DV frames, one after the other.
+ * @param count The number of frames.
+ * @param datetime The recording time, see dv_metadata_stamp().
+ * @param frame The running frame counter of the first frame.
+ * @param timecode Set true (non-zero) to write timecodes counted from the
+ *        frame counter instead of from datetime.
+ */
+void dv_metadata_stamp_frames(dv_metadata_stamper_t *st, uint8_t *frames,
+			      int count, time_t *datetime, int frame,
+			      int timecode)
+{
+	int size = st->isPAL ? 144000 : 120000;
+	int n;
+
+	for (n = 0; n < count; n++) {
+		dv_metadata_stamp(st, frames, datetime, frame + n);
+		if (timecode) {
+			dv_metadata_stamp_timecode(st, frames, frame + n);
+		}
+		frames += size;
+	}
+}
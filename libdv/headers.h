@@ -34,6 +34,13 @@ extern "C" {
 
 extern void _dv_write_meta_data(unsigned char* target, int frame, int isPAL,
 			    int is16x9, time_t * now);
+extern void _dv_write_video_segment_headers(unsigned char* vsbuffer, 
+					    int frame, int ds, int v);
+extern void _dv_write_frame_template(unsigned char* target, int isPAL, 
+				     int is16x9);
+extern void _dv_write_frame_meta(unsigned char* target, 
+				 const unsigned char* tmpl, int frame, 
+				 int isPAL, const struct tm* now);
 
 #ifdef __cplusplus
 }
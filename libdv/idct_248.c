@@ -45,50 +45,12 @@
 #endif
 
 #include <stdio.h>
-#include <math.h>
 
 #include "idct_248.h"
+#include "tables.h"
 
 #define IDCT_248_UNIT_TEST 0
 
-dv_248_coeff_t dv_idct_248_prescale[64];
-
-/*
-  beta2 = cos(M_PI/4);
-  beta0 = beta2 - 0.5;
-  beta1 = -1 - beta0;
-  beta3 = -cos(3 * M_PI / 8);
-  beta4 = cos(M_PI / 8);
-*/
-  
-
-static int32_t beta0;
-static int32_t beta1;
-static int32_t beta2;
-static int32_t beta3;
-static int32_t beta4;
-
-static double C(int u) {
-  double result;
-  if(u == 0) {
-    result = 0.5 / sqrt(2.0);
-  } else {
-    result = 0.5;
-  } // else
-  return(result);
-} // C
-
-static double tickC(int u) 
-{
-  double result;
-  if(u == 0) {
-    result = 1.0 / sqrt(2.0);
-  } else {
-    result = 0.5;
-  } // else
-  return(result);
-} // tickC
-
 #if (ARCH_X86 || ARCH_X86_64) && defined(__GNUC__)
 
 static inline int32_t fixed_multiply(int32_t a, int32_t b) {
@@ -117,44 +79,6 @@ static inline int32_t fixed_multiply(int32_t a, int32_t b) {
 
 #endif
 
-/* Compute the prescale vector.
- * (verify against  matlab result for kron(inv(D2),D))
- */
-void dv_dct_248_init() {
-  extern double dv_weight_inverse_248_matrix[];
-  int k, l;
-  double d;
-  double diag[2][8];
-  double dbeta0, dbeta1, dbeta2, dbeta3, dbeta4;
-
-  dbeta2 = cos(M_PI/4);
-  dbeta0 = dbeta2 - 0.5;
-  dbeta1 = -1 - dbeta0;
-  dbeta3 = -cos(3 * M_PI / 8);
-  dbeta4 = cos(M_PI / 8);
-
-  beta0 = dbeta0 * pow(2,30);
-  beta1 = dbeta1 * pow(2,30);
-  beta2 = dbeta2 * pow(2,30);
-  beta3 = dbeta3 * pow(2,30);
-  beta4 = dbeta4 * pow(2,30);
-
-  for(k=0; k<4;k++) {
-    d = C(k) / (2.0 * cos( (M_PI * (double)k) / 8.0 ));
-    diag[0][k] = diag[0][k+4] = d;
-  } // for
-  for(k=0; k<8;k++) {
-    diag[1][k] = tickC(k) / (2.0 * cos( M_PI * k / 16.0 ));
-  } // for
-  for(k=0; k<8;k++) {
-    for(l= 0; l<8 ; l++) {
-      // Note the 2^16 shift is for fixed point precision.
-      dv_idct_248_prescale[k*8+l] = 1.0/diag[0][k] * diag[1][l] * pow(2.0,14.0);
-      dv_idct_248_prescale[k*8+l] *= dv_weight_inverse_248_matrix[k*8+l];
-    } // for
-  } // for
-} // dv_dct_248_init
-
 /* Total cost: 144 mults, 576 adds, 144 shifts. AAN is cited as having
    cost 144 mults, 464 mults. Doing some CSE below would probably get
    us there.  In principle, 2-4-8 is less complex than 88, since one
@@ -203,7 +127,7 @@ void dv_idct_248(dv_248_coeff_t *x248, dv_coeff_t *out)
 		z = in[3*8+i];
 		lhs[0*8+i] = DIV_FOUR(u) + DIV_TWO(v);
 		lhs[1*8+i] = DIV_FOUR(u) - DIV_TWO(v);
-		lhs[2*8+i] = fixed_multiply(w,beta0) + fixed_multiply(z,beta1);
+		lhs[2*8+i] = fixed_multiply(w,dv_idct_248_beta[0]) + fixed_multiply(z,dv_idct_248_beta[1]);
                 lhs[3*8+i] = -(DIV_TWO(w+z));
 		u = in[4*8+i];
 		v = in[6*8+i];
@@ -211,7 +135,7 @@ void dv_idct_248(dv_248_coeff_t *x248, dv_coeff_t *out)
 		z = in[7*8+i];
 		lhs[4*8+i] = DIV_FOUR(u) + DIV_TWO(v);
 		lhs[5*8+i] = DIV_FOUR(u) - DIV_TWO(v);
-		lhs[6*8+i] = fixed_multiply(w,beta0) + fixed_multiply(z,beta1);
+		lhs[6*8+i] = fixed_multiply(w,dv_idct_248_beta[0]) + fixed_multiply(z,dv_idct_248_beta[1]);
                 lhs[7*8+i] = -(DIV_TWO(w+z));
 	} // for 
 #if IDCT_248_UNIT_TEST
@@ -259,15 +183,15 @@ void dv_idct_248(dv_248_coeff_t *x248, dv_coeff_t *out)
 		lhs[i*8+1] = in[i*8+4];
 		u = in[i*8+2];
 		v = in[i*8+6];
-		lhs[i*8+2] = fixed_multiply(u - v,beta2);
+		lhs[i*8+2] = fixed_multiply(u - v,dv_idct_248_beta[2]);
 		lhs[i*8+3] = u + v;
 		u = in[i*8+1];
 		v = in[i*8+3];
                 w = in[i*8+5];
 		z = in[i*8+7];
-		lhs[i*8+4] = fixed_multiply(u - z,beta3) + fixed_multiply(v - w,beta4);
-		lhs[i*8+5] = fixed_multiply(u - v - w + z,beta2);
-		lhs[i*8+6] = fixed_multiply(u - z,beta4) + fixed_multiply(w - v,beta3);
+		lhs[i*8+4] = fixed_multiply(u - z,dv_idct_248_beta[3]) + fixed_multiply(v - w,dv_idct_248_beta[4]);
+		lhs[i*8+5] = fixed_multiply(u - v - w + z,dv_idct_248_beta[2]);
+		lhs[i*8+6] = fixed_multiply(u - z,dv_idct_248_beta[4]) + fixed_multiply(w - v,dv_idct_248_beta[3]);
 		lhs[i*8+7] = u + v + w + z;
 	} // for
 #if IDCT_248_UNIT_TEST
@@ -52,12 +52,15 @@
 #include "vlc.h"
 #include "audio.h"
 #include "parse.h"
+#include "tables.h"
 
 #define STRICT_SYNTAX 0
 #define VLC_BOUNDS_CHECK 0
 
 #define PARSE_VLC_TRACE 0
 
+pthread_mutex_t _dv_parse_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 #ifdef __GNUC__
 #if PARSE_VLC_TRACE
 #define vlc_trace(format,args...) fprintf(stdout,format,##args)
@@ -76,8 +79,6 @@ static inline void vlc_trace(char *format, ...)
 }
 #endif /* __GNUC__ */
 
-/* Assign coefficient in zigzag order without indexing multiply */
-#define ZERO_MULT_ZIGZAG 1
 #if ZERO_MULT_ZIGZAG
 #define SET_COEFF(COEFFS,REORDER,VALUE) \
   (*((dv_coeff_t *)(((uint8_t *)(COEFFS)) + *(REORDER)++)) = (VALUE))
@@ -91,21 +92,7 @@ int    dv_parse_bit_end[6]   = { 18*8,    32*8,    46*8,    60*8,    70*8,    80
 int     dv_super_map_vertical[5] = { 2, 6, 8, 0, 4 };
 int     dv_super_map_horizontal[5] = { 2, 1, 3, 0, 4 };
 
-static int8_t  dv_88_reorder_prime[64] = {
-0, 1, 8, 16, 9, 2, 3, 10,		17, 24, 32, 25, 18, 11, 4, 5,
-12, 19, 26, 33, 40, 48, 41, 34,		27, 20, 13, 6, 7, 14, 21, 28,
-35, 42, 49, 56, 57, 50, 43, 36,		29, 22, 15, 23, 30, 37, 44, 51,
-58, 59, 52, 45, 38, 31, 39, 46,		53, 60, 61, 54, 47, 55, 62, 63 
-};
-
-int8_t  dv_reorder[2][64] = {
-  { 0 },
-  {
-    0, 32, 1, 33, 8, 40, 2, 34,		9, 41, 16, 48, 24, 56, 17, 49,
-    10, 42, 3, 35, 4, 36, 11, 43,		18, 50, 25, 57, 26, 58, 19, 51,
-    12, 44, 5, 37, 6, 38, 13, 45,		20, 52, 27, 59, 28, 60, 21, 53,
-    14, 46, 7, 39, 15, 47, 22, 54,		29, 61, 30, 62, 23, 55, 31, 63 }
-};
+/* dv_reorder[] is built by gentables (see tables.h) */
 
 #if HAVE_LIBPOPT
 /* ---------------------------------------------------------------------------
@@ -150,6 +137,14 @@ dv_video_new(void)
   result->arg_block_quality = 3; /* Default is best quality  */
 
 #if HAVE_LIBPOPT
+  result->option_table = (struct poptOption *)
+    calloc(DV_VIDEO_NUM_OPTS+1, sizeof(struct poptOption));
+  if(!result->option_table) {
+    free(result);
+    result = NULL;
+    goto noopt;
+  } /* if */
+
   result->option_table[DV_VIDEO_OPT_BLOCK_QUALITY] = (struct poptOption){
     longName:   "quality", 
     shortName:  'q', 
@@ -182,26 +177,6 @@ dv_video_new(void)
   return(result);
 } /* dv_video_new */
 
-/* ---------------------------------------------------------------------------
- */
-void
-dv_parse_init(void) {
-  int i;
-  for(i=0;i<64;i++) {
-#if (!ARCH_X86) && (!ARCH_X86_64)
-    dv_reorder[DV_DCT_88][i] = ((dv_88_reorder_prime[i] / 8) * 8) + (dv_88_reorder_prime[i] % 8);
-#else
-    dv_reorder[DV_DCT_88][i] = ((dv_88_reorder_prime[i] % 8) * 8) + (dv_88_reorder_prime[i] / 8);
-#endif
-  } /* for  */
-  for(i=0;i<64;i++) {
-#if ZERO_MULT_ZIGZAG
-    dv_reorder[DV_DCT_88][i] = (dv_reorder[DV_DCT_88][i]) * sizeof(dv_coeff_t);
-    dv_reorder[DV_DCT_248][i] = (dv_reorder[DV_DCT_248][i]) * sizeof(dv_coeff_t);
-#endif
-  } /* for */
-} /* dv_parse_init */
-
 /* ---------------------------------------------------------------------------
  * Scan the blocks of a macroblock.  We're looking to find the next
  * block from which unused space was borrowed
@@ -342,7 +317,7 @@ dv_parse_ac_coeffs(dv_videosegment_t *seg) {
   int             m, b, pass;
   int             bits_left;
   int         vlc_error;
-  int8_t           **reorder, *reorder_sentinel;
+  const int8_t     **reorder, *reorder_sentinel;
   dv_coeff_t      *coeffs;
   dv_macroblock_t *mb;
   dv_block_t      *bl, *bl_bit_source;
@@ -793,8 +768,8 @@ dv_parse_packs(dv_decoder_t *dv, const uint8_t *buffer) {
 
 /* ---------------------------------------------------------------------------
  */
-int
-dv_parse_header(dv_decoder_t *dv, const uint8_t *buffer) {
+static int
+dv_parse_header_blocks(dv_decoder_t *dv, const uint8_t *buffer) {
   dv_header_t *header = &dv->header;
   bitstream_t *bs;
   dv_id_t      id;
@@ -878,8 +853,6 @@ dv_parse_header(dv_decoder_t *dv, const uint8_t *buffer) {
   dv_parse_id(bs,&id);				/* should be VA3 */
   bitstream_flush_large(bs,616);
 
-  dv_parse_audio_header(dv, buffer);
-
   free( bs );
   
   return(result);
@@ -888,6 +861,36 @@ dv_parse_header(dv_decoder_t *dv, const uint8_t *buffer) {
   free( bs );
  no_bitstream:
   return(-1);
+} /* dv_parse_header_blocks */
+
+/* ---------------------------------------------------------------------------
+ */
+int
+dv_parse_header(dv_decoder_t *dv, const uint8_t *buffer) {
+  int result;
+
+  if ((result = dv_parse_header_blocks(dv, buffer)) >= 0)
+    dv_parse_audio_header(dv, buffer);
+  return(result);
 } /* dv_parse_header */
 
+/* ---------------------------------------------------------------------------
+ * Same as dv_parse_header, but the frame is given as a list of chunks.  The
+ * six header blocks are only copied if they straddle a chunk boundary.
+ */
+int
+dv_parse_header_iov(dv_decoder_t *dv, const dv_iovec_t *iov, int iovcnt) {
+  uint8_t          scratch[6*80];
+  dv_iov_cursor_t  cursor;
+  const uint8_t   *buffer;
+  int              result;
+
+  _dv_iov_cursor_init(&cursor, iov, iovcnt);
+  if (!(buffer = _dv_iov_map(&cursor, 0, 6*80, scratch)))
+    return(-1);
+  if ((result = dv_parse_header_blocks(dv, buffer)) >= 0)
+    dv_parse_audio_header_iov(dv, iov, iovcnt);
+  return(result);
+} /* dv_parse_header_iov */
+
 /*@}*/
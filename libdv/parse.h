@@ -36,14 +36,23 @@
 #ifndef DV_PARSE_H
 #define DV_PARSE_H
 
+#include <pthread.h>
+
 #include "dv_types.h"
 
+/* Assign coefficient in zigzag order without indexing multiply */
+#define ZERO_MULT_ZIGZAG 1
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 extern dv_video_t *dv_video_new(void);
-extern void        dv_parse_init(void);
+
+/* The x86 segment parsers keep their state in static storage, so the
+ * decoder, and the transcoder on the encoder's worker threads, hold
+ * this lock around them */
+extern pthread_mutex_t _dv_parse_mutex;
 
 #ifdef __cplusplus
 }
@@ -41,37 +41,14 @@
 # include <config.h>
 #endif
 
-#include <math.h>
-
 #include "idct_248.h"
 #include "quant.h"
+#include "tables.h"
 
 #if ARCH_X86 || ARCH_X86_64
 #include <mmx.h>
 #endif
 
-static uint8_t dv_88_areas[64] = {
--1,0,0,1,1,1,2,2, 
- 0,0,1,1,1,2,2,2, 
- 0,1,1,1,2,2,2,3, 
- 1,1,1,2,2,2,3,3, 
-
- 1,1,2,2,2,3,3,3, 
- 1,2,2,2,3,3,3,3, 
- 2,2,2,3,3,3,3,3, 
- 2,2,3,3,3,3,3,3 };
-
-static uint8_t dv_248_areas[64] = {
--1,0,1,1,1,2,2,3, 
- 0,1,1,2,2,2,3,3, 
- 1,1,2,2,2,3,3,3, 
- 1,2,2,2,3,3,3,3,
-
- 0,0,1,1,2,2,2,3, 
- 0,1,1,2,2,2,3,3, 
- 1,1,2,2,2,3,3,3, 
- 1,2,2,3,3,3,3,3 };
-
 #if 0
 static uint8_t dv_quant_steps[22][4] = {
   { 8,8,16,16 }, 
@@ -107,42 +84,10 @@ static uint8_t dv_quant_steps[22][4] = {
 };
 #endif
 
-uint8_t dv_quant_shifts[22][4] = {
-  { 3,3,4,4 }, 
-  { 3,3,4,4 }, 
-
-  { 2,3,3,4 }, 
-  { 2,3,3,4 },
-
-  { 2,2,3,3 }, 
-  { 2,2,3,3 }, 
-
-  { 1,2,2,3 }, 
-  { 1,2,2,3 }, 
-
-  { 1,1,2,2 }, 
-  { 1,1,2,2 }, 
-
-  { 0,1,1,2 }, 
-  { 0,1,1,2 }, 
-
-  { 0,0,1,1 }, 
-  { 0,0,1,1 },
-
-  { 0,0,0,1 }, 
-
-  { 0,0,0,0 }, 
-  { 0,0,0,0 }, 
-  { 0,0,0,0 }, 
-  { 0,0,0,0 }, 
-  { 0,0,0,0 }, 
-  { 0,0,0,0 }, 
-  { 0,0,0,0 }
-};
+/* dv_quant_shifts, the zone tables and the 2-4-8 inverse multiplier
+ * table are built by gentables (see tables.h) */
 
 uint8_t  dv_quant_offset[4] = { 6,3,0,1 };
-uint32_t	dv_quant_248_mul_tab [2] [22] [64];
-uint32_t dv_quant_88_mul_tab [2] [22] [64];
 
 extern void             _dv_quant_x86(dv_coeff_t *block,int qno,int klass);
 extern void             _dv_quant_x86_64(dv_coeff_t *block,int qno,int klass);
@@ -154,17 +99,6 @@ void (*_dv_quant_248_inverse) (dv_coeff_t *block,int qno,int klass,dv_248_coeff_
 void
 dv_quant_init (void) 
 {
-  int	ex, qno, i;
- 
-  for (ex = 0; ex < 2; ++ex) {
-    for (qno = 0; qno < 22; ++qno) {
-      for (i = 0; i < 64; ++i) {
- 	dv_quant_248_mul_tab [ex] [qno] [i] =
-	  (1 << (dv_quant_shifts [qno] [dv_248_areas [i]] + ex)) * dv_idct_248_prescale[i];
-      }
-      dv_quant_248_mul_tab [ex] [qno] [0] = dv_idct_248_prescale[0];
-    }
-  }
   _dv_quant_248_inverse = quant_248_inverse_std;
 #if ARCH_X86
   if (dv_use_mmx) {
@@ -182,7 +116,7 @@ void _dv_quant(dv_coeff_t *block,int qno,int klass)
 		int i;
 		int extra = (klass == 3) ? 1 : 0;
 		int factor;
-		uint8_t *pq;	/* pointer to the four quantization
+		const uint8_t *pq;	/* pointer to the four quantization
 				   factors that we'll use */
 
 		pq = dv_quant_shifts[qno+dv_quant_offset[klass]];
@@ -218,7 +152,7 @@ void _dv_quant(dv_coeff_t *block,int qno,int klass)
 
 void _dv_quant_88_inverse(dv_coeff_t *block,int qno,int klass) {
   int i;
-  uint8_t *pq;			/* pointer to the four quantization
+  const uint8_t *pq;			/* pointer to the four quantization
                                    factors that we'll use */
   int extra;
 
@@ -233,7 +167,7 @@ void _dv_quant_88_inverse(dv_coeff_t *block,int qno,int klass) {
 static void
 quant_248_inverse_std(dv_coeff_t *block,int qno,int klass,dv_248_coeff_t *co) {
   int i;
-  uint8_t *pq;			/* pointer to the four quantization
+  const uint8_t *pq;			/* pointer to the four quantization
                                    factors that we'll use */
   int extra;
 
@@ -248,7 +182,7 @@ quant_248_inverse_std(dv_coeff_t *block,int qno,int klass,dv_248_coeff_t *co) {
 static void
 quant_248_inverse_mmx(dv_coeff_t *block,int qno,int klass,dv_248_coeff_t *co) {
   int i;
-  uint32_t *pm;
+  const uint32_t *pm;
 
   pm = dv_quant_248_mul_tab [klass == 3] [qno + dv_quant_offset[klass]];
   for (i = 0; i < 64; i++) {
@@ -23,6 +23,8 @@
 extern "C" {
 #endif
 
+extern uint8_t dv_quant_offset[4];
+
 extern void _dv_quant(dv_coeff_t *block,int qno,int klass);
 extern void _dv_quant_88_inverse(dv_coeff_t *block,int qno,int klass);
 extern void (*_dv_quant_248_inverse) (dv_coeff_t *block,int qno,int klass,
@@ -29,12 +29,8 @@
 # include <config.h>
 #endif
 
-#include <math.h>
-
 #include "rgb.h"
-
-#define COLOR_FRACTION_BITS 10
-#define COLOR_FRACTION_MUL  (1 << COLOR_FRACTION_BITS)
+#include "tables.h"
 
 /* yuv -> rgb converion lookup tables.  These tables are constructed
  * from the standard formulas, plus the following assumptions:
@@ -63,23 +59,24 @@
 
 /* lookups for the terms in the formula above.  Note we use
  * pointer arithmetic to make use of negative index values legal.
+ * The tables themselves are built by gentables for both clamp
+ * settings; each decoder picks its own through dv_color_luts().
  */
-
-static int32_t real_table_2_018[256];
-static int32_t real_table_0_813[256];
-static int32_t real_table_0_391[256];
-static int32_t real_table_1_596[256];
-
-static int32_t *table_2_018;
-static int32_t *table_0_813;
-static int32_t *table_0_391;
-static int32_t *table_1_596;
-
-static int32_t real_ylut[768], *ylut;
-static int32_t real_ylut_setup[768], *ylut_setup;
+#define DV_COLOR_LUTS(L,C) {                                        \
+  _dv_rgb_table_2_018[C] + 128, _dv_rgb_table_0_813[C] + 128,       \
+  _dv_rgb_table_0_391[C] + 128, _dv_rgb_table_1_596[C] + 128,       \
+  _dv_rgb_ylut[L] + 256, _dv_rgb_ylut_setup[L] + 256,               \
+  _dv_uvlut[C] + 128,                                               \
+  _dv_YUY2_ylut[L] + 256, _dv_YUY2_ylut_setup[L] + 256,             \
+  _dv_YV12_ylut[L] + 256 }
+
+static const dv_color_luts_t dv_color_luts_tab[2][2] = {
+  { DV_COLOR_LUTS(0,0), DV_COLOR_LUTS(0,1) },
+  { DV_COLOR_LUTS(1,0), DV_COLOR_LUTS(1,1) },
+};
 
 /* rgb lookup - clamps values in range -256 .. 511 to 0 .. 255 */
-static uint8_t real_rgblut[768], *rgblut;
+static const uint8_t *rgblut = _dv_rgb_rgblut + 256;
 
 /* ---------------------------------------------------------------------------
  */
@@ -90,50 +87,19 @@ clamp (int low, int val, int high) {
 
 /* ---------------------------------------------------------------------------
  */
-void
-dv_rgb_init(int clamp_luma, int clamp_chroma) {
-  int i;
-  int clamped_offset;
-  table_2_018 = real_table_2_018 + 128;
-  table_0_813 = real_table_0_813 + 128;
-  table_0_391 = real_table_0_391 + 128;
-  table_1_596 = real_table_1_596 + 128;
-
-  for(i=-128;
-      i<128;
-      ++i) {
-    if ((clamp_chroma == TRUE) && (i < (16-128))) {
-      clamped_offset = (16-128);
-    } else if ((clamp_chroma == TRUE) && (i > (240-128))) {
-      clamped_offset = (240-128);
-    } else {
-      clamped_offset = i;
-    } // else
-    table_2_018[i] = (int32_t)rint(2.018 * COLOR_FRACTION_MUL * clamped_offset);
-    table_0_813[i] = (int32_t)rint(0.813 * COLOR_FRACTION_MUL * clamped_offset);
-    table_0_391[i] = (int32_t)rint(0.391 * COLOR_FRACTION_MUL * clamped_offset);
-    table_1_596[i] = (int32_t)rint(1.596 * COLOR_FRACTION_MUL * clamped_offset);
-  } // for
-
-  ylut = real_ylut + 256;
-  ylut_setup = real_ylut_setup + 256;
-  for(i=-256; i < 512; i++) {
-    clamped_offset = i + 128 - 16;
-    if (clamp_luma == TRUE) clamped_offset = CLAMP(clamped_offset, 16, 235);
-    ylut[i] = (int32_t)rint(1.164 * COLOR_FRACTION_MUL * clamped_offset);
-    ylut_setup[i] = (int32_t)rint(1.164 * COLOR_FRACTION_MUL * (clamped_offset+16));
-  } // for
-
-  rgblut = real_rgblut + 256;
-  for(i=-256; i < 512; i++) {
-    rgblut[i] = CLAMP(i, 0, 255);
-  } // for
-} /* dv_rgb_init */
+const dv_color_luts_t *
+dv_color_luts(int clamp_luma, int clamp_chroma) {
+  return &dv_color_luts_tab[clamp_luma == TRUE][clamp_chroma == TRUE];
+} /* dv_color_luts */
 
 /* ---------------------------------------------------------------------------
  */
 void
-dv_mb411_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup) {
+dv_mb411_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+             const dv_color_luts_t *luts) {
+  const int32_t *table_2_018 = luts->table_2_018, *table_0_813 = luts->table_0_813;
+  const int32_t *table_0_391 = luts->table_0_391, *table_1_596 = luts->table_1_596;
+  const int32_t *ylut = luts->rgb_ylut, *ylut_setup = luts->rgb_ylut_setup;
   dv_coeff_t *Y[4], *cr_frame, *cb_frame;
   uint8_t *prgb, *pwrgb;
   int i,j,k, row;
@@ -179,7 +145,11 @@ dv_mb411_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_s
 /* ---------------------------------------------------------------------------
  */
 void
-dv_mb411_right_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup) {
+dv_mb411_right_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+             const dv_color_luts_t *luts) {
+  const int32_t *table_2_018 = luts->table_2_018, *table_0_813 = luts->table_0_813;
+  const int32_t *table_0_391 = luts->table_0_391, *table_1_596 = luts->table_1_596;
+  const int32_t *ylut = luts->rgb_ylut, *ylut_setup = luts->rgb_ylut_setup;
   dv_coeff_t *Ytmp;
   dv_coeff_t *Y[4], *cr_frame, *cb_frame;
   uint8_t *prgb, *pwrgb;
@@ -242,7 +212,11 @@ dv_mb411_right_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_
 /* ---------------------------------------------------------------------------
  */
 void
-dv_mb420_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches) {
+dv_mb420_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches,
+             const dv_color_luts_t *luts) {
+  const int32_t *table_2_018 = luts->table_2_018, *table_0_813 = luts->table_0_813;
+  const int32_t *table_0_391 = luts->table_0_391, *table_1_596 = luts->table_1_596;
+  const int32_t *ylut = luts->rgb_ylut;
   dv_coeff_t *Y[4], *cr_frame, *cb_frame;
   uint8_t *prgb, *pwrgb0, *pwrgb1;
   int i, j, k, row, col;
@@ -306,7 +280,11 @@ dv_mb420_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches) {
 /* ---------------------------------------------------------------------------
  */
 void
-dv_mb411_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup) {
+dv_mb411_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+             const dv_color_luts_t *luts) {
+  const int32_t *table_2_018 = luts->table_2_018, *table_0_813 = luts->table_0_813;
+  const int32_t *table_0_391 = luts->table_0_391, *table_1_596 = luts->table_1_596;
+  const int32_t *ylut = luts->rgb_ylut, *ylut_setup = luts->rgb_ylut_setup;
   dv_coeff_t *Y[4], *cr_frame, *cb_frame;
   uint8_t *prgb, *pwrgb;
   int i,j,k, row;
@@ -353,7 +331,11 @@ dv_mb411_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_
 /* ---------------------------------------------------------------------------
  */
 void
-dv_mb411_right_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup) {
+dv_mb411_right_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+             const dv_color_luts_t *luts) {
+  const int32_t *table_2_018 = luts->table_2_018, *table_0_813 = luts->table_0_813;
+  const int32_t *table_0_391 = luts->table_0_391, *table_1_596 = luts->table_1_596;
+  const int32_t *ylut = luts->rgb_ylut, *ylut_setup = luts->rgb_ylut_setup;
   dv_coeff_t *Ytmp;
   dv_coeff_t *Y[4], *cr_frame, *cb_frame;
   uint8_t *prgb, *pwrgb;
@@ -417,7 +399,11 @@ dv_mb411_right_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add
 /* ---------------------------------------------------------------------------
  */
 void
-dv_mb420_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches) {
+dv_mb420_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches,
+             const dv_color_luts_t *luts) {
+  const int32_t *table_2_018 = luts->table_2_018, *table_0_813 = luts->table_0_813;
+  const int32_t *table_0_391 = luts->table_0_391, *table_1_596 = luts->table_1_596;
+  const int32_t *ylut = luts->rgb_ylut;
   dv_coeff_t *Y[4], *cr_frame, *cb_frame;
   uint8_t *prgb, *pwrgb0, *pwrgb1;
   int i, j, k, row, col;
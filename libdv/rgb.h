@@ -29,6 +29,9 @@
 
 #include "dv_types.h"
 
+#define COLOR_FRACTION_BITS 10
+#define COLOR_FRACTION_MUL  (1 << COLOR_FRACTION_BITS)
+
 /* Convert output of decoder to RGB layout.  
  * 
  * In addition to YUV to RGB, the conversion first takes care going
@@ -48,16 +51,22 @@
 extern "C" {
 #endif
 
-extern void dv_rgb_init(int clamp_luma, int clamp_chroma);
+extern const dv_color_luts_t *dv_color_luts(int clamp_luma, int clamp_chroma);
 
 /* scalar versions */
-extern void dv_mb411_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup);
-extern void dv_mb411_right_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup);
-extern void dv_mb420_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches);
+extern void dv_mb411_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+                         const dv_color_luts_t *luts);
+extern void dv_mb411_right_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+                         const dv_color_luts_t *luts);
+extern void dv_mb420_rgb(dv_macroblock_t *mb, uint8_t **pixels, int *pitches,
+                         const dv_color_luts_t *luts);
 
-extern void dv_mb411_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup);
-extern void dv_mb411_right_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup);
-extern void dv_mb420_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches);
+extern void dv_mb411_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+                         const dv_color_luts_t *luts);
+extern void dv_mb411_right_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches, int add_ntsc_setup,
+                         const dv_color_luts_t *luts);
+extern void dv_mb420_bgr0(dv_macroblock_t *mb, uint8_t **pixels, int *pitches,
+                          const dv_color_luts_t *luts);
 
 #if ARCH_X86
 /* pentium architecture mmx version */
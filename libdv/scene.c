@@ -0,0 +1,304 @@
+/*
+ *  scene.c
+ *
+ *  This file is part of libdv, a free DV (IEC 61834/SMPTE 314M)
+ *  codec.
+ *
+ *  libdv is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation; either version 2.1, or (at your
+ *  option) any later version.
+ *
+ *  libdv is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with libdv; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ *  The libdv homepage is http://libdv.sourceforge.net/.
+ */
+
+/** @file
+ *  @ingroup decoder
+ *  @brief Shot detection on the DC images of DV frames
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dv.h"
+#include "place.h"
+#include "util.h"
+
+/* ---------------------------------------------------------------------------
+ * The DC coefficient of a block is the first 9 bits of its area in the
+ * DIF block, so the DC image needs neither the bitstream nor the VLC
+ * parser: the luma blocks of a macroblock start 14 bytes apart behind
+ * the 4 byte DIF block header.
+ */
+
+/* the images are compared 16 bytes at a time */
+#define DC_IMAGE_SIZE ((DV_DC_IMAGE_WIDTH * DV_DC_IMAGE_MAX_HEIGHT + 15) & ~15)
+
+#define HISTOGRAM_BINS 64
+
+struct dv_scene_detector_s {
+  uint8_t  image[2][DC_IMAGE_SIZE] ALIGN32;
+  int      cur;          /* image of the current frame */
+  int      height;       /* of the previous frame, 0 for none yet */
+  int      histogram[2][HISTOGRAM_BINS];
+  int      frame;
+  double   sad_threshold;
+  double   histogram_threshold;
+  double   sad_average;  /* running mean of the differences */
+  int      have_datetime;
+  long     datetime;     /* of the previous frame, in seconds */
+};
+
+#if DV_VECTOR && (ARCH_X86 || ARCH_X86_64)
+#define SCENE_SSE2 1
+#else
+#define SCENE_SSE2 0
+#endif
+
+#if SCENE_SSE2
+
+#include <immintrin.h>
+
+typedef long long scene_v2di __attribute__ ((vector_size (16)));
+
+static __attribute__ ((target ("sse2"))) unsigned int
+dc_image_sad_sse2(const uint8_t *a, const uint8_t *b, int size) {
+  scene_v2di sum = { 0, 0 };
+  __m128i va, vb;
+  int i;
+
+  for (i = 0; i < size; i += 16) {
+    va = _mm_loadu_si128((const __m128i *) (a + i));
+    vb = _mm_loadu_si128((const __m128i *) (b + i));
+    sum += (scene_v2di) _mm_sad_epu8(va, vb);
+  }
+  return (unsigned int) (sum[0] + sum[1]);
+} /* dc_image_sad_sse2 */
+
+#endif /* SCENE_SSE2 */
+
+static unsigned int
+dc_image_sad(const uint8_t *a, const uint8_t *b, int size) {
+  unsigned int sum = 0;
+  int i;
+
+#if SCENE_SSE2
+  if (_dv_simd.sse2)
+    return dc_image_sad_sse2(a, b, size);
+#endif
+  for (i = 0; i < size; i++)
+    sum += (a[i] > b[i]) ? a[i] - b[i] : b[i] - a[i];
+  return sum;
+} /* dc_image_sad */
+
+/* ---------------------------------------------------------------------------
+ */
+static inline uint8_t
+dc_level(const uint8_t *p) {
+  int dc = (p[0] << 1) | (p[1] >> 7);
+
+  if (dc > 255) dc -= 512;
+  return (uint8_t) (128 + (dc >> 1));
+} /* dc_level */
+
+/** @brief Extract the luma DC image of a DV frame.
+ *
+ * Each 8x8 luma block of the frame gives one pixel, the mean luma level
+ * of the block, read straight from its DC coefficient without parsing
+ * the AC coefficients.  The image is DV_DC_IMAGE_WIDTH pixels wide and
+ * dv->height / 8 pixels high.  dv_parse_header() must have been called
+ * for the frame.
+ *
+ * @param dv The decoder
+ * @param buffer The DV frame
+ * @param image The DC image, DV_DC_IMAGE_WIDTH * DV_DC_IMAGE_MAX_HEIGHT bytes
+ * @return The height of the DC image
+ */
+int
+dv_decode_dc_image(dv_decoder_t *dv, const uint8_t *buffer, uint8_t *image) {
+  dv_videosegment_t seg;
+  dv_macroblock_t *mb;
+  const uint8_t *p;
+  int ds, v, m, x, y;
+
+  seg.isPAL = (dv->system == e_dv_system_625_50);
+  for (ds = 0; ds < dv->num_dif_seqs; ds++) {
+    for (v = 0; v < 27; v++) {
+      seg.i = ds;
+      seg.k = v;
+      dv_place_video_segment(dv, &seg);
+      p = buffer + (ds * 150 + 6 + v / 3 + 1 + v * 5) * 80 + 4;
+      for (m = 0, mb = seg.mb; m < 5; m++, mb++, p += 80) {
+	x = mb->x / 8;
+	y = mb->y / 8;
+	if (dv->sampling == e_dv_sample_411 && x < 22 * 4) {
+	  /* four blocks side by side */
+	  image[y * DV_DC_IMAGE_WIDTH + x] = dc_level(p);
+	  image[y * DV_DC_IMAGE_WIDTH + x + 1] = dc_level(p + 14);
+	  image[y * DV_DC_IMAGE_WIDTH + x + 2] = dc_level(p + 28);
+	  image[y * DV_DC_IMAGE_WIDTH + x + 3] = dc_level(p + 42);
+	} else {
+	  /* two by two blocks */
+	  image[y * DV_DC_IMAGE_WIDTH + x] = dc_level(p);
+	  image[y * DV_DC_IMAGE_WIDTH + x + 1] = dc_level(p + 14);
+	  image[(y + 1) * DV_DC_IMAGE_WIDTH + x] = dc_level(p + 28);
+	  image[(y + 1) * DV_DC_IMAGE_WIDTH + x + 1] = dc_level(p + 42);
+	} /* else */
+      } /* for m */
+    } /* for v */
+  } /* for ds */
+  return dv->height / 8;
+} /* dv_decode_dc_image */
+
+/* ---------------------------------------------------------------------------
+ */
+
+/* seconds since 1970 of a broken down UTC time, whatever the time zone */
+static long
+datetime_seconds(const struct tm *t) {
+  int y = t->tm_year + 1900, m = t->tm_mon + 1;
+  long days;
+
+  if (m <= 2) {
+    y--;
+    m += 12;
+  }
+  days = 365L * y + y / 4 - y / 100 + y / 400 + (153 * (m - 3) + 2) / 5 +
+    t->tm_mday - 719469;
+  return ((days * 24 + t->tm_hour) * 60 + t->tm_min) * 60 + t->tm_sec;
+} /* datetime_seconds */
+
+/** @brief Create a shot detector.
+ *
+ * @return The detector, NULL if out of memory
+ */
+dv_scene_detector_t *
+dv_scene_detector_new(void) {
+  dv_scene_detector_t *sd;
+
+  if (!(sd = (dv_scene_detector_t *) calloc(1, sizeof(dv_scene_detector_t))))
+    return NULL;
+  sd->sad_threshold = 12.0;
+  sd->histogram_threshold = 0.25;
+  return sd;
+} /* dv_scene_detector_new */
+
+/** @brief Free a shot detector.
+ *
+ * @param sd The detector, may be NULL
+ */
+void
+dv_scene_detector_free(dv_scene_detector_t *sd) {
+  free(sd);
+} /* dv_scene_detector_free */
+
+/** @brief Set how different two frames must be to make a cut.
+ *
+ * @param sd The detector
+ * @param sad Mean absolute difference of the DC images, in luma levels
+ *        (default 12)
+ * @param histogram Difference of the DC image histograms, 0 to 1
+ *        (default 0.25)
+ */
+void
+dv_scene_detector_set_thresholds(dv_scene_detector_t *sd, double sad,
+				 double histogram) {
+  sd->sad_threshold = sad;
+  sd->histogram_threshold = histogram;
+} /* dv_scene_detector_set_thresholds */
+
+/** @brief Look for a shot boundary in front of a DV frame.
+ *
+ * Feed the frames of a clip in order.  The frame is a cut when its DC
+ * image differs from that of the previous frame in both the mean
+ * absolute difference and the histogram by more than the thresholds,
+ * and the difference is well above the running mean, so that steady
+ * motion does not count.  It starts a new recording when
+ * dv_is_new_recording() says so or the recording date and time of the
+ * subcode jumps by more than a second.  A step of one second backwards
+ * is let through: libdv's own encoder dates the first frame of every
+ * second one second ahead.
+ *
+ * @param sd The detector
+ * @param dv The decoder, headers and packs are parsed into it
+ * @param buffer The DV frame
+ * @param info Filled in with the measurements, may be NULL
+ * @return DV_SCENE_CUT and/or DV_SCENE_NEW_RECORDING, 0 for none, -1
+ *         if the frame header is damaged
+ */
+int
+dv_scene_detect(dv_scene_detector_t *sd, dv_decoder_t *dv,
+		const uint8_t *buffer, dv_scene_info_t *info) {
+  int *histogram, *prev_histogram;
+  uint8_t *image;
+  struct tm rec_dt;
+  double sad = 0, hist = 0;
+  int height, size, i, flags = 0;
+
+  if (dv_parse_header(dv, buffer) < 0)
+    return -1;
+  dv_parse_packs(dv, buffer);
+
+  image = sd->image[sd->cur];
+  height = dv_decode_dc_image(dv, buffer, image);
+  size = height * DV_DC_IMAGE_WIDTH;
+  memset(image + size, 0, DC_IMAGE_SIZE - size);
+  histogram = sd->histogram[sd->cur];
+  prev_histogram = sd->histogram[!sd->cur];
+  memset(histogram, 0, HISTOGRAM_BINS * sizeof(int));
+  for (i = 0; i < size; i++)
+    histogram[image[i] * HISTOGRAM_BINS / 256]++;
+
+  if (sd->height == height) {
+    sad = (double) dc_image_sad(image, sd->image[!sd->cur], DC_IMAGE_SIZE) /
+      size;
+    for (i = 0; i < HISTOGRAM_BINS; i++)
+      hist += abs(histogram[i] - prev_histogram[i]);
+    hist /= 2 * size;
+    if (sad > sd->sad_threshold && hist > sd->histogram_threshold &&
+	sad > 2 * sd->sad_average)
+      flags |= DV_SCENE_CUT;
+    sd->sad_average += (sad - sd->sad_average) / 8;
+  } else if (sd->height) {
+    /* the video system changed */
+    flags |= DV_SCENE_CUT | DV_SCENE_NEW_RECORDING;
+    sd->sad_average = 0;
+  } /* else */
+
+  if (sd->frame && dv_is_new_recording(dv, buffer) > 0)
+    flags |= DV_SCENE_NEW_RECORDING;
+  if (dv_get_recording_datetime_tm(dv, &rec_dt)) {
+    long datetime = datetime_seconds(&rec_dt);
+
+    if (sd->have_datetime &&
+	(datetime < sd->datetime - 1 || datetime > sd->datetime + 1))
+      flags |= DV_SCENE_NEW_RECORDING;
+    sd->datetime = datetime;
+    sd->have_datetime = 1;
+  } /* if */
+
+  if (info) {
+    info->frame = sd->frame;
+    info->flags = flags;
+    info->sad = sad;
+    info->histogram = hist;
+  } /* if */
+  sd->height = height;
+  sd->cur = !sd->cur;
+  sd->frame++;
+  return flags;
+} /* dv_scene_detect */
@@ -0,0 +1,113 @@
+/*
+ *  tables.h
+ *
+ *     Copyright (C) Charles 'Buck' Krasic - April 2000
+ *     Copyright (C) Erik Walthinsen - April 2000
+ *
+ *  This file is part of libdv, a free DV (IEC 61834/SMPTE 314M)
+ *  codec.
+ *
+ *  libdv is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation; either version 2.1, or (at your
+ *  option) any later version.
+ *
+ *  libdv is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with libdv; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ *  The libdv homepage is http://libdv.sourceforge.net/.
+ */
+
+/* Lookup tables precomputed at build time by gentables.  The
+ * definitions live in the generated tables.c. */
+
+#ifndef DV_TABLES_H
+#define DV_TABLES_H
+
+#include "dv_types.h"
+#include "vlc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* weighting.c, dct.c: (i)DCT pre- and postscalers with the
+ * coefficient weights folded in */
+extern const dv_coeff_t preSC[64] ALIGN32;
+extern const dv_coeff_t postSC88[64] ALIGN32;
+extern const dv_coeff_t postSC248[64] ALIGN32;
+#if (!ARCH_X86) && (!ARCH_X86_64)
+extern const dv_coeff_t dv_weight_inverse_88_matrix[64];
+#endif
+#if BRUTE_FORCE_DCT_88
+extern const double dv_weight_88_matrix[64];
+#endif
+#if BRUTE_FORCE_DCT_248
+extern const double dv_weight_248_matrix[64];
+#endif
+#if BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
+extern const double _dv_dct_KC248[8][4][4][8];
+#endif
+#if ((!ARCH_X86) && (!ARCH_X86_64)) || BRUTE_FORCE_DCT_248 || BRUTE_FORCE_DCT_88
+extern const double _dv_dct_C[8];
+extern const double _dv_dct_KC88[8][8][8][8];
+#endif
+
+/* idct_248.c: prescale vector and the 2.30 fixed point betas */
+extern const dv_248_coeff_t dv_idct_248_prescale[64];
+extern const int32_t dv_idct_248_beta[5];
+
+/* vlc.c */
+extern const dv_vlc_tab_t dv_vlc_lookup1[32];
+extern const dv_vlc_tab_t dv_vlc_lookup2[128];
+extern const dv_vlc_tab_t dv_vlc_lookup3[64];
+extern const dv_vlc_tab_t dv_vlc_lookup4[64];
+extern const dv_vlc_tab_t dv_vlc_lookup5[256];
+extern const dv_vlc_tab_t dv_vlc_class1_shortcut[128];
+
+/* parse.c, quant.c */
+extern const int8_t dv_reorder[2][64];
+extern const uint8_t dv_88_areas[64];
+extern const uint8_t dv_248_areas[64];
+extern const uint8_t dv_quant_shifts[22][4];
+extern const uint32_t dv_quant_248_mul_tab[2][22][64];
+extern const uint32_t dv_quant_88_mul_tab[2][22][64];
+
+/* rgb.c, YUY2.c, YV12.c: the first index is (clamp_{luma,chroma} == TRUE) */
+extern const int32_t _dv_rgb_table_2_018[2][256];
+extern const int32_t _dv_rgb_table_0_813[2][256];
+extern const int32_t _dv_rgb_table_0_391[2][256];
+extern const int32_t _dv_rgb_table_1_596[2][256];
+extern const int32_t _dv_rgb_ylut[2][768];
+extern const int32_t _dv_rgb_ylut_setup[2][768];
+extern const uint8_t _dv_rgb_rgblut[768];
+extern const uint8_t _dv_uvlut[2][256];
+extern const uint8_t _dv_YUY2_ylut[2][768];
+extern const uint8_t _dv_YUY2_ylut_setup[2][768];
+extern const uint8_t _dv_YV12_ylut[2][768];
+
+/* encode.c */
+extern const uint32_t _dv_vlc_encode_table[32768 * 2];
+extern const uint8_t _dv_vlc_num_bits_table[32768];
+extern const unsigned short _dv_reorder_88[64];
+extern const unsigned short _dv_reorder_248[64];
+extern const int _dv_qnos[4][16];
+extern const int _dv_qnos_class_combi[16][16];
+extern const int _dv_qno_next_hit[4][16];
+
+/* enc_output.c */
+extern const uint16_t _dv_audio_shuffle_60[5][9][36];
+extern const uint16_t _dv_audio_shuffle_50[6][9][36];
+extern const uint8_t _dv_audio_12bit_shift[128];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DV_TABLES_H */
@@ -0,0 +1,464 @@
+/* Round trip and equivalence checks of the libdv frame API.
+ * Usage:
+ *    ./testcodec                 runs all checks, exits non-zero on failure
+ *    ./testcodec name ...        runs the named checks only
+ *    ./testcodec -w file         writes the test frame to file
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libdv/dv.h>
+
+#define PAL_WIDTH  720
+#define PAL_HEIGHT 576
+#define PAL_FRAME  144000
+
+static unsigned char rgb[PAL_WIDTH * PAL_HEIGHT * 3];
+static unsigned char frame[PAL_FRAME];
+
+/* A picture with smooth gradients and some detail, so that all block
+   classes and both DCT modes turn up. */
+static void make_picture(void)
+{
+	unsigned char *p = rgb;
+	int x, y;
+
+	for (y = 0; y < PAL_HEIGHT; y++) {
+		for (x = 0; x < PAL_WIDTH; x++) {
+			*p++ = x * 255 / PAL_WIDTH;
+			*p++ = y * 255 / PAL_HEIGHT;
+			*p++ = ((x >> 2) ^ (y >> 1)) & 0xff;
+		}
+	}
+}
+
+static dv_encoder_t *new_encoder(void)
+{
+	dv_encoder_t *enc = dv_encoder_new(0, 0, 0);
+
+	enc->isPAL = 1;
+	enc->is16x9 = 0;
+	enc->vlc_encode_passes = 3;
+	enc->static_qno = 0;
+	enc->force_dct = DV_DCT_AUTO;
+	return enc;
+}
+
+static int encode_frame(unsigned char **in, dv_color_space_t color_space,
+			unsigned char *out)
+{
+	dv_encoder_t *enc = new_encoder();
+	int rval = dv_encode_full_frame(enc, in, color_space, out);
+
+	dv_encoder_free(enc);
+	return rval;
+}
+
+static int encode_picture(unsigned char *out)
+{
+	unsigned char *in = rgb;
+
+	return encode_frame(&in, e_dv_color_rgb, out);
+}
+
+/* Compares the video DIF blocks of two PAL frames, leaving out the
+   meta data, which carries the time of encoding. */
+static int same_video(const unsigned char *a, const unsigned char *b)
+{
+	int i;
+
+	for (i = 0; i < PAL_FRAME; i += 80) {
+		if ((a[i] >> 5) == 4 && memcmp(a + i, b + i, 80)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Luma and chroma samples of a test picture, chroma at half the
+   horizontal resolution */
+#define TEST_Y(x, y)  (16 + ((x) * 3 + (y) * 5 + (((x) ^ (y)) & 31)) % 220)
+#define TEST_CB(x, y) (16 + ((x) * 7 + (y) * 2) % 225)
+#define TEST_CR(x, y) (16 + ((x) * 2 + (y) * 9 + ((y) >> 3)) % 225)
+
+/* ---------------------------------------------------------------------------
+   - the checks
+   --------------------------------------------------------------------------- */
+
+/* The frame decodes the same whether it comes in one piece or in chunks
+   that split header blocks and video segments, and a frame cut short is
+   reported. */
+static int check_iov(void)
+{
+	static unsigned char a[PAL_WIDTH * PAL_HEIGHT * 3];
+	static unsigned char b[PAL_WIDTH * PAL_HEIGHT * 3];
+	dv_decoder_t *dv = dv_decoder_new(0, 0, 0);
+	dv_iovec_t iov[3];
+	uint8_t *pixels[3];
+	int pitches[3];
+	int rval = 0;
+
+	dv_set_error_log(dv, NULL);
+	iov[0].iov_base = frame;
+	iov[0].iov_len = 100;
+	iov[1].iov_base = frame + 100;
+	iov[1].iov_len = 77777;
+	iov[2].iov_base = frame + 77877;
+	iov[2].iov_len = PAL_FRAME - 77877;
+	pitches[0] = PAL_WIDTH * 3;
+
+	if (dv_parse_header(dv, frame) < 0) {
+		return 1;
+	}
+	pixels[0] = a;
+	dv_decode_full_frame(dv, frame, e_dv_color_rgb, pixels, pitches);
+
+	if (dv_parse_header_iov(dv, iov, 3) < 0) {
+		return 1;
+	}
+	pixels[0] = b;
+	if (dv_decode_full_frame_iov(dv, iov, 3, e_dv_color_rgb,
+				     pixels, pitches) < 0) {
+		rval = 1;
+	}
+	if (memcmp(a, b, sizeof(a))) {
+		rval = 1;
+	}
+
+	iov[2].iov_len = 1000;
+	if (dv_decode_full_frame_iov(dv, iov, 3, e_dv_color_rgb,
+				     pixels, pitches) != -1) {
+		rval = 1;
+	}
+	dv_decoder_free(dv);
+	return rval;
+}
+
+/* A decoder from dv_decoder_new_slim() decodes like one from
+   dv_decoder_new(). */
+static int check_slim(void)
+{
+	static unsigned char a[PAL_WIDTH * PAL_HEIGHT * 3];
+	static unsigned char b[PAL_WIDTH * PAL_HEIGHT * 3];
+	dv_decoder_t *dv = dv_decoder_new(0, 0, 0);
+	dv_decoder_t *slim = dv_decoder_new_slim(0, 0, 0);
+	uint8_t *pixels[3];
+	int pitches[3];
+	int rval = 0;
+
+	dv->quality = DV_QUALITY_BEST;
+	pitches[0] = PAL_WIDTH * 3;
+	if (dv_parse_header(dv, frame) < 0 ||
+	    dv_parse_header(slim, frame) < 0) {
+		rval = 1;
+	} else {
+		pixels[0] = a;
+		dv_decode_full_frame(dv, frame, e_dv_color_rgb,
+				     pixels, pitches);
+		pixels[0] = b;
+		dv_decode_full_frame(slim, frame, e_dv_color_rgb,
+				     pixels, pitches);
+		if (memcmp(a, b, sizeof(a))) {
+			rval = 1;
+		}
+	}
+	dv_decoder_free(slim);
+	dv_decoder_free(dv);
+	return rval;
+}
+
+/* The same 4:2:2 picture as YUY2 and as YV16 planes encodes the same. */
+static int check_yv16(void)
+{
+	static unsigned char yuy2[PAL_WIDTH * PAL_HEIGHT * 2];
+	static unsigned char planes[PAL_WIDTH * PAL_HEIGHT * 2];
+	static unsigned char a[PAL_FRAME], b[PAL_FRAME];
+	unsigned char *y = planes, *cr = planes + PAL_WIDTH * PAL_HEIGHT;
+	unsigned char *cb = cr + PAL_WIDTH * PAL_HEIGHT / 2;
+	unsigned char *in[3];
+	int i, j;
+
+	for (j = 0; j < PAL_HEIGHT; j++) {
+		for (i = 0; i < PAL_WIDTH / 2; i++) {
+			unsigned char *p = yuy2 + (j * PAL_WIDTH + 2 * i) * 2;
+
+			p[0] = y[j * PAL_WIDTH + 2 * i] = TEST_Y(2 * i, j);
+			p[1] = cb[j * PAL_WIDTH / 2 + i] = TEST_CB(i, j);
+			p[2] = y[j * PAL_WIDTH + 2 * i + 1] = TEST_Y(2 * i + 1, j);
+			p[3] = cr[j * PAL_WIDTH / 2 + i] = TEST_CR(i, j);
+		}
+	}
+	in[0] = yuy2;
+	if (encode_frame(in, e_dv_color_yuv, a) < 0) {
+		return 1;
+	}
+	in[0] = y;
+	in[1] = cr;
+	in[2] = cb;
+	if (encode_frame(in, e_dv_color_yv16, b) < 0) {
+		return 1;
+	}
+	return !same_video(a, b);
+}
+
+/* The same 4:2:0 picture as I420 and as NV12 encodes the same. */
+static int check_nv12(void)
+{
+	static unsigned char i420[PAL_WIDTH * PAL_HEIGHT * 3 / 2];
+	static unsigned char nv12[PAL_WIDTH * PAL_HEIGHT * 3 / 2];
+	static unsigned char a[PAL_FRAME], b[PAL_FRAME];
+	unsigned char *cb = i420 + PAL_WIDTH * PAL_HEIGHT;
+	unsigned char *cr = cb + PAL_WIDTH * PAL_HEIGHT / 4;
+	unsigned char *cbcr = nv12 + PAL_WIDTH * PAL_HEIGHT;
+	unsigned char *in[3];
+	int i, j;
+
+	for (j = 0; j < PAL_HEIGHT; j++) {
+		for (i = 0; i < PAL_WIDTH; i++) {
+			i420[j * PAL_WIDTH + i] = nv12[j * PAL_WIDTH + i] 
+				= TEST_Y(i, j);
+		}
+	}
+	for (j = 0; j < PAL_HEIGHT / 2; j++) {
+		for (i = 0; i < PAL_WIDTH / 2; i++) {
+			int k = j * PAL_WIDTH / 2 + i;
+
+			cbcr[2 * k] = cb[k] = TEST_CB(i, j);
+			cbcr[2 * k + 1] = cr[k] = TEST_CR(i, j);
+		}
+	}
+	in[0] = i420;
+	in[1] = cb;
+	in[2] = cr;
+	if (encode_frame(in, e_dv_color_i420, a) < 0) {
+		return 1;
+	}
+	in[0] = nv12;
+	in[1] = cbcr;
+	if (encode_frame(in, e_dv_color_nv12, b) < 0) {
+		return 1;
+	}
+	return !same_video(a, b);
+}
+
+/* Four channels at 32 kHz go through 12 bit samples and come back
+   within the quantisation step, a single channel at 32 kHz fills both
+   channels of the pair, and three channels at 48 kHz are refused. */
+static int check_audio12(void)
+{
+	static unsigned char out[PAL_FRAME];
+	static int16_t pcm[4][DV_AUDIO_MAX_SAMPLES];
+	static int16_t dec[4][DV_AUDIO_MAX_SAMPLES];
+	int16_t *in[4], *outbufs[4];
+	dv_encoder_t *enc = new_encoder();
+	dv_decoder_t *dv = dv_decoder_new(0, 0, 0);
+	int c, i, samples, rval = 0;
+
+	for (c = 0; c < 4; c++) {
+		for (i = 0; i < DV_AUDIO_MAX_SAMPLES; i++) {
+			pcm[c][i] = (i * (c + 3) * 97) % 60000 - 30000;
+		}
+		in[c] = pcm[c];
+		outbufs[c] = dec[c];
+	}
+	dv_set_error_log(dv, NULL);
+	dv->audio->arg_mixing_level = 16; /* keep the pairs apart */
+	memcpy(out, frame, PAL_FRAME);
+
+	if (dv_encode_full_audio(enc, in, 4, 32000, out) < 0 ||
+	    dv_parse_header(dv, out) < 0 ||
+	    !dv_decode_full_audio(dv, out, outbufs) ||
+	    dv_get_frequency(dv) != 32000 ||
+	    !dv_is_4ch(dv)) {
+		rval = 1;
+		goto done;
+	}
+	samples = dv_get_num_samples(dv);
+	for (c = 0; c < 4; c++) {
+		for (i = 0; i < samples; i++) {
+			int d = abs(dec[c][i] - pcm[c][i]);
+
+			if (d > (abs(pcm[c][i]) >> 8) + 1) {
+				rval = 1;
+				goto done;
+			}
+		}
+	}
+
+	if (dv_encode_full_audio(enc, in, 1, 32000, out) < 0 ||
+	    dv_parse_header(dv, out) < 0 ||
+	    !dv_decode_full_audio(dv, out, outbufs) ||
+	    dv_is_4ch(dv)) {
+		rval = 1;
+		goto done;
+	}
+	samples = dv_get_num_samples(dv);
+	if (memcmp(dec[0], pcm[0], samples * sizeof(int16_t)) ||
+	    memcmp(dec[1], pcm[0], samples * sizeof(int16_t))) {
+		rval = 1;
+		goto done;
+	}
+
+	if (dv_encode_full_audio(enc, in, 3, 48000, out) != -1) {
+		rval = 1;
+	}
+ done:
+	dv_decoder_free(dv);
+	dv_encoder_free(enc);
+	return rval;
+}
+
+/* Transcoding keeps the picture, and a transcoded frame transcodes to
+   itself, in place as well.  Transcoding and fading on worker threads
+   give the same frames as in the calling thread alone. */
+static int check_transcode(void)
+{
+	static unsigned char a[PAL_FRAME], b[PAL_FRAME], c[PAL_FRAME];
+	static unsigned char pa[PAL_WIDTH * PAL_HEIGHT * 3];
+	static unsigned char pb[PAL_WIDTH * PAL_HEIGHT * 3];
+	dv_encoder_t *enc = new_encoder();
+	dv_encoder_t *threaded = new_encoder();
+	dv_decoder_t *dv = dv_decoder_new(0, 0, 0);
+	uint8_t *pixels[3];
+	int pitches[3];
+	int rval = 0;
+
+	threaded->num_threads = 4;
+	dv->quality = DV_QUALITY_BEST;
+	pitches[0] = PAL_WIDTH * 3;
+	if (dv_transcode_full_frame(enc, frame, a) < 0 ||
+	    dv_transcode_full_frame(enc, a, b) < 0 ||
+	    memcmp(a, b, PAL_FRAME)) {
+		rval = 1;
+		goto done;
+	}
+	if (dv_transcode_full_frame(enc, b, b) < 0 ||
+	    memcmp(a, b, PAL_FRAME)) {
+		rval = 1;
+		goto done;
+	}
+	if (dv_transcode_full_frame(threaded, frame, c) < 0 ||
+	    memcmp(a, c, PAL_FRAME)) {
+		rval = 1;
+		goto done;
+	}
+	if (dv_adjust_full_frame(enc, frame, b, 0.5, 0) < 0 ||
+	    dv_adjust_full_frame(threaded, frame, c, 0.5, 0) < 0 ||
+	    memcmp(b, c, PAL_FRAME)) {
+		rval = 1;
+		goto done;
+	}
+	if (dv_parse_header(dv, frame) < 0) {
+		rval = 1;
+		goto done;
+	}
+	pixels[0] = pa;
+	dv_decode_full_frame(dv, frame, e_dv_color_rgb, pixels, pitches);
+	pixels[0] = pb;
+	dv_decode_full_frame(dv, a, e_dv_color_rgb, pixels, pitches);
+	if (memcmp(pa, pb, sizeof(pa))) {
+		rval = 1;
+	}
+ done:
+	dv_decoder_free(dv);
+	dv_encoder_free(threaded);
+	dv_encoder_free(enc);
+	return rval;
+}
+
+/* A clip of 30 frames from one encoder with a cut to a flat picture
+   half way has exactly that one cut and no new recording, although
+   the encoder dates the first frame of each second ahead. */
+static int check_scene(void)
+{
+	static unsigned char flat[PAL_WIDTH * PAL_HEIGHT * 3];
+	static unsigned char out[PAL_FRAME];
+	dv_encoder_t *enc = new_encoder();
+	dv_decoder_t *dv = dv_decoder_new(0, 0, 0);
+	dv_scene_detector_t *sd = dv_scene_detector_new();
+	unsigned char *in;
+	int i, flags, cuts = 0, rval = 0;
+
+	memset(flat, 40, sizeof(flat));
+	for (i = 0; i < 30; i++) {
+		in = (i < 15) ? rgb : flat;
+		if (dv_encode_full_frame(enc, &in, e_dv_color_rgb, out) < 0 ||
+		    (flags = dv_scene_detect(sd, dv, out, NULL)) < 0) {
+			rval = 1;
+			break;
+		}
+		if (flags & DV_SCENE_NEW_RECORDING) {
+			rval = 1;
+		}
+		if (flags & DV_SCENE_CUT) {
+			cuts++;
+			if (i != 15) {
+				rval = 1;
+			}
+		}
+	}
+	if (cuts != 1) {
+		rval = 1;
+	}
+	dv_scene_detector_free(sd);
+	dv_decoder_free(dv);
+	dv_encoder_free(enc);
+	return rval;
+}
+
+static struct {
+	const char *name;
+	int (*check)(void);
+} checks[] = {
+	{ "iov", check_iov },
+	{ "slim", check_slim },
+	{ "yv16", check_yv16 },
+	{ "nv12", check_nv12 },
+	{ "audio12", check_audio12 },
+	{ "transcode", check_transcode },
+	{ "scene", check_scene },
+	{ NULL, NULL }
+};
+
+int main(int argc, char **argv)
+{
+	int i, j, failed = 0;
+
+	make_picture();
+	if (encode_picture(frame) < 0) {
+		fprintf(stderr, "testcodec: can not encode the test frame\n");
+		return 1;
+	}
+	if (argc == 3 && !strcmp(argv[1], "-w")) {
+		FILE *fp = fopen(argv[2], "wb");
+
+		if (!fp || fwrite(frame, 1, PAL_FRAME, fp) != PAL_FRAME ||
+		    fclose(fp)) {
+			perror(argv[2]);
+			return 1;
+		}
+		return 0;
+	}
+
+	for (i = 0; checks[i].name; i++) {
+		if (argc > 1) {
+			for (j = 1; j < argc; j++) {
+				if (!strcmp(argv[j], checks[i].name)) {
+					break;
+				}
+			}
+			if (j == argc) {
+				continue;
+			}
+		}
+		if (checks[i].check()) {
+			printf("%s: FAILED\n", checks[i].name);
+			failed++;
+		} else {
+			printf("%s: ok\n", checks[i].name);
+		}
+	}
+	return failed ? 1 : 0;
+}
@@ -137,7 +137,6 @@ int main(int argc, char **argv)
   dv_vlc_t vlc;
   int run, amp, len, val;
 
-  dv_construct_vlc_table();
   for(i=0;i<89;i++) {
     val = dv_vlc_test_table[i].val;
     amp = dv_vlc_test_table[i].amp;
@@ -38,6 +38,31 @@ extern void dv_opt_usage(poptContext con, struct poptOption *opt, int num);
 
 #endif  // HAVE_LIBPOPT
 
+/* The vector code is written with the vector extensions of GCC 9 and
+ * clang.  DV_SHUFFLE(a, b, V, lanes...) picks lanes of a and b, V being
+ * their type; clang and GCC 12 take the lane indices as arguments,
+ * older GCC only as a mask vector. */
+#if defined(__GNUC__) && (defined(__clang__) || (__GNUC__ >= 9))
+#define DV_VECTOR 1
+#else
+#define DV_VECTOR 0
+#endif
+
+#if defined(__clang__) || (__GNUC__ >= 12)
+#define DV_SHUFFLE(a, b, V, ...) __builtin_shufflevector(a, b, __VA_ARGS__)
+#else
+#define DV_SHUFFLE(a, b, V, ...) __builtin_shuffle(a, b, (V) { __VA_ARGS__ })
+#endif
+
+/* The instruction set extensions the vector code may use on this CPU.
+ * Filled in once by dv_init(), only read afterwards. */
+typedef struct {
+  int sse2;
+  int avx2;
+} dv_simd_t;
+
+extern dv_simd_t _dv_simd;
+
 #ifdef __cplusplus
 }
 #endif
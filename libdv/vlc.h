@@ -52,9 +52,9 @@ typedef struct dv_vlc_tab_s {
 extern "C" {
 #endif
 
-extern int8_t *dv_vlc_classes[];
-extern int dv_vlc_class_index_mask[];
-extern int dv_vlc_class_index_rshift[];
+extern int8_t * const dv_vlc_classes[64];
+extern const int dv_vlc_class_index_mask[64];
+extern const int dv_vlc_class_index_rshift[64];
 extern const dv_vlc_tab_t dv_vlc_broken[1];
 extern const dv_vlc_tab_t *dv_vlc_lookups[6];
 extern const int dv_vlc_index_mask[6];
@@ -62,7 +62,6 @@ extern const int dv_vlc_index_rshift[6];
 extern const int sign_lookup[2];
 extern const int sign_mask[17];
 extern const int sign_rshift[17];
-extern void dv_construct_vlc_table();
 
 // Note we assume bits is right (lsb) aligned, 0 < maxbits < 17
 // This may look crazy, but there are no branches here.
@@ -42,7 +42,6 @@
 extern "C" {
 #endif
 
-void _dv_weight_init(void);
 void _dv_weight_88(dv_coeff_t *block);
 void _dv_weight_248(dv_coeff_t *block);
 void _dv_weight_88_inverse(dv_coeff_t *block);